@@ -0,0 +1,59 @@
+#ifndef ADAPTIVEINTERVAL_HPP
+#define ADAPTIVEINTERVAL_HPP
+
+#include <chrono>
+#include <cstdint>
+
+// What an archival run left behind, measured when it ends.
+struct ArchivalBacklog {
+    // False if the run stopped early (cancelled, deadline, DDS unavailable)
+    bool complete = true;
+    // The run stopped because DDS could not be reached; retrying sooner will not help
+    bool ddsUnavailable = false;
+    // Max-utilization runs evict instead of copying and say nothing about the backlog
+    bool eviction = false;
+    // An incremental run that spent its work budget mid-pass; the interval waits for the pass to end
+    bool yielded = false;
+    std::uint64_t copiedFiles = 0;
+    // Files still not on DDS when the run ended: copies cancelled or failed, and
+    // files in the roots the run listed but never got to
+    std::uint64_t pendingFiles = 0;
+    std::uint64_t pendingBytes = 0;
+};
+
+// Interval to the next archival run, adapted to the backlog each run
+// reports and kept within [minimum, maximum]:
+//  - DDS unavailable: double the interval (back off), whatever is left over
+//  - backlog left over or the run stopped early: next run after minimum
+//  - nothing to copy: double the interval (back off)
+//  - copies after backing off: return to the configured base interval
+//  - arrivals per minute grew by more than a quarter: halve the interval
+//  - arrivals eased off: double the interval, up to base
+//  - otherwise: keep the interval
+// Eviction runs and incremental slices that yielded mid-pass leave it unchanged.
+// With minimum == maximum the interval is fixed.
+class AdaptiveInterval {
+public:
+    using Duration = std::chrono::seconds;
+
+    AdaptiveInterval(Duration base, Duration minimum, Duration maximum);
+
+    // Applies reloaded bounds; the current interval is clamped into them.
+    void setBounds(Duration base, Duration minimum, Duration maximum);
+
+    Duration current() const { return interval; }
+    // Records the finished run and returns the interval to the next one.
+    Duration update(const ArchivalBacklog& backlog);
+
+private:
+    Duration clamp(Duration value) const;
+
+    Duration base;
+    Duration minimum;
+    Duration maximum;
+    Duration interval;
+    // Files copied per minute of interval in the previous complete run; negative before the first
+    double previousRate = -1.0;
+};
+
+#endif // ADAPTIVEINTERVAL_HPP
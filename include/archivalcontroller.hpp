@@ -7,36 +7,78 @@
 #include <nlohmann/json.hpp>
 #include "fileservice.hpp"
 #include "loggingservice.hpp"
+#include "asynclogger.hpp"
+#include "pipelinesummary.hpp"
+#include "policymodel.hpp"
+#include "cancellation.hpp"
+#include "adaptiveinterval.hpp"
+#include "archivalscope.hpp"
+
+// What archiveFile() did with one file.
+enum class ArchiveOutcome {
+    // Not eligible, already on DDS or copied now
+    Done,
+    // Copy cancelled or failed; the original stays on vecow until a later run copies it
+    NotCopied,
+    // DDS is not accessible; the run stops
+    DdsUnavailable
+};
 
 // ArchivalController class declaration
 class ArchivalController {
 public:
-    // Constructor
-    ArchivalController(const nlohmann::json& archivalPolicy, const std::string &source, const std::string &logFilePath);
+    // Constructor. The scans only walk the retention roots of the scope's categories.
+    ArchivalController(const nlohmann::json& archivalPolicy, const std::string &source, const std::string &logFilePath,
+                       const ArchivalScope& scope = ArchivalScope());
 
     // Public methods
     void logIncidentToDB(const std::string& message, const nlohmann::json& details, const std::string& error_code);
-    void applyArchivalPolicy();
-    void startMaxUtilizationPipeline();
-    void startNormalPipeline();
+    // The pipelines stop at the next directory (and copies at the next chunk) once token is cancelled.
+    // Each returns what the run left behind, for the adaptive archival interval.
+    ArchivalBacklog applyArchivalPolicy(const CancellationToken& token = CancellationToken::none());
+    ArchivalBacklog startMaxUtilizationPipeline(const CancellationToken& token = CancellationToken::none());
+    ArchivalBacklog startNormalPipeline(const CancellationToken& token = CancellationToken::none());
+    // Archives specific files (e.g. reported by ArchivalNotifier) without a full scan.
+    // Files of categories outside the scope are skipped.
+    void archiveFiles(const std::vector<std::string>& filePaths,
+                      const CancellationToken& token = CancellationToken::none());
     void stopPipeline(const std::vector<std::string>& directories);
+    const ArchivalScope& getScope() const { return scope; }
     FileService fileService;
     
 private:
     // Member variables
     nlohmann::json archivalPolicy;
+    // Typed form of archivalPolicy used on the per-file paths
+    CompiledPolicy policy;
+    ArchivalScope scope;
+    // Per instance, so category pipelines running side by side never share a tunable being refreshed
+    int bandwidthLimitKb;
+    // Config snapshot the tunables were last taken from
+    std::uint64_t configVersion = 0;
+    // The "rules" section policy was compiled with; a reload that changes it recompiles
+    std::string ruleExpressions;
     LoggingService* logger;
+    AsyncLogger* asyncLogger;
     std::string source;
     std::string logFilePath;
     // // CustomLogger customLogger;
     
     // Private helper methods
     bool checkArchivalPolicy();
+    void refreshTunables();
+    void reportRuleErrors();
+    ArchiveOutcome archiveFile(const std::string& file, PipelineCounters& counters, const CancellationToken& token);
+    bool pipelineCancelled(const CancellationToken& token, const char* pipeline);
+    void deleteFile(const std::string& file, PipelineCounters& counters);
+    void countPending(const std::string& file, PipelineCounters& counters);
     std::vector<std::string> getAllFilePaths();
     double diskSpaceUtilization();
     double checkFileArchivalPolicy(const std::string& filePath);
     bool isFileEligibleForArchival(const std::string& filePath);
     bool isFileEligibleForDeletion(const std::string& filePath);
+    bool evaluateRule(const RuleProgram& program, FileCategory category, const std::string& filePath,
+                      double retentionHours);
     bool isFileArchivedToDDS(const std::string& filePath);
     void updateFileArchivalStatus(const std::string& filePath, const std::string& ddsFilePath);
     std::string getDestinationPath(const std::string& filePath);
@@ -0,0 +1,59 @@
+#ifndef ARCHIVALNOTIFIER_HPP
+#define ARCHIVALNOTIFIER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+#include "loggingservice.hpp"
+#include "reactor.hpp"
+
+// Listens on the channel fed by the analytics insert trigger (schema migration 5)
+// and collects newly registered video/parquet paths for immediate archival.
+// The periodic archival scan remains the safety net for anything missed while
+// the listener was disconnected or the pending set was full.
+class ArchivalNotifier {
+public:
+    static constexpr const char* CHANNEL = "efms_analytics_insert";
+
+    ArchivalNotifier(LoggingService* logger, std::size_t maxPending);
+    ~ArchivalNotifier();
+
+    ArchivalNotifier(const ArchivalNotifier&) = delete;
+    ArchivalNotifier& operator=(const ArchivalNotifier&) = delete;
+
+    // Notified when a path arrives while none were pending. Set before start().
+    void setWakeup(WakeupEvent* event) { wakeup = event; }
+
+    void start();
+    void stop();
+
+    // Returns and clears the paths received since the last call, oldest first.
+    std::vector<std::string> drain();
+    std::size_t pendingCount() const;
+
+    // Parses a trigger payload and queues its non-empty file locations.
+    void handlePayload(const std::string& payload);
+
+private:
+    void run();
+    void enqueuePath(const std::string& path);
+
+    LoggingService* logger;
+    std::size_t maxPending;
+
+    mutable std::mutex mutex;
+    std::deque<std::string> pending;
+    std::unordered_set<std::string> pendingSet;
+    std::size_t droppedSinceLog = 0;
+    WakeupEvent* wakeup = nullptr;
+
+    std::atomic<bool> running{false};
+    std::thread listener;
+};
+
+#endif // ARCHIVALNOTIFIER_HPP
@@ -0,0 +1,44 @@
+#ifndef ARCHIVALSCOPE_HPP
+#define ARCHIVALSCOPE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "pathclassifier.hpp"
+#include "taskexecutor.hpp"
+
+// The categories one archival pipeline instance walks and how it runs them.
+// An entry under archival.categories gives a category its own instance, job
+// and timer, e.g.
+//   "Videos": {"interval_minutes": 5, "concurrency": 4, "priority": "normal"}
+// Categories without an entry stay with the default instance.
+struct ArchivalScope {
+    // Job name: "archival" for the default instance, "archival:<Category>" otherwise
+    std::string name = "archival";
+    // One bit per categoryIndex(); roots of no known category belong to the default instance
+    std::uint32_t categories = ~0u;
+    // Most files the instance has in flight at once; 0 leaves it to the TaskExecutor width
+    std::size_t concurrency = 0;
+    // Lane of the normal pipeline's copies; eviction always runs as Emergency
+    TaskPriority priority = TaskPriority::Background;
+    // Fixed interval of a category instance; the default instance adapts its own
+    int intervalMinutes = 0;
+
+    bool includes(FileCategory category) const {
+        return ((categories >> categoryIndex(category)) & 1u) != 0;
+    }
+};
+
+// Parses the archival.categories object into one scope per category, in
+// FileCategory order. Returns the problem, or empty if the section is valid.
+std::string parseArchivalScopes(const nlohmann::json& categories, std::vector<ArchivalScope>& scopes);
+
+// Category instances configured in the current snapshot; none if the section is absent or invalid.
+std::vector<ArchivalScope> loadArchivalScopes();
+
+// The default instance: every category that has no instance of its own.
+ArchivalScope defaultArchivalScope(const std::vector<ArchivalScope>& categoryScopes);
+
+#endif // ARCHIVALSCOPE_HPP
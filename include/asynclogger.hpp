@@ -0,0 +1,83 @@
+#ifndef ASYNCLOGGER_HPP
+#define ASYNCLOGGER_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "loggingservice.hpp"
+#include "logutils.hpp"
+#include "ringbuffer.hpp"
+
+// Asynchronous front end for LoggingService used by the per-file pipeline
+// logging. Callers push fixed-size LogRecords into a lock-free ring buffer
+// and return immediately; a background thread converts them to JSON and
+// writes them. Records that raise incidents stay on the synchronous
+// LoggingService path.
+class AsyncLogger {
+public:
+    enum class Level { Info, Warning, Error };
+    enum class OverflowPolicy { Drop, Block };
+
+    struct Record {
+        Level level = Level::Info;
+        LogRecord log;
+    };
+
+    // One shared instance per LoggingService, created on first use.
+    static AsyncLogger& getInstance(LoggingService* logger);
+    // Drains and stops every shared instance; called once at shutdown.
+    static void stopAll();
+
+    AsyncLogger(LoggingService* logger, std::size_t capacity, OverflowPolicy policy, bool enabled);
+    ~AsyncLogger();
+
+    AsyncLogger(const AsyncLogger&) = delete;
+    AsyncLogger& operator=(const AsyncLogger&) = delete;
+
+    // Allocation-free unless the buffer is disabled or stopped, in which case
+    // the record is written inline.
+    void info(const LogRecord& record);
+    void warning(const LogRecord& record);
+    void error(const LogRecord& record);
+
+    // Blocks until every record pushed before the call has been written.
+    void flush();
+    // Drains the buffer and stops the flusher thread.
+    void stop();
+
+    std::uint64_t droppedRecords() const { return dropped.load(std::memory_order_relaxed); }
+    bool isEnabled() const { return enabled; }
+
+    static OverflowPolicy parseOverflowPolicy(const std::string& name);
+
+private:
+    void submit(Level level, const LogRecord& log);
+    void write(const Record& record);
+    void run();
+    // Wakes the flusher if it is waiting for records.
+    void wake();
+
+    LoggingService* logger;
+    OverflowPolicy policy;
+    bool enabled;
+    RingBuffer<Record> buffer;
+
+    std::atomic<std::uint64_t> pushed{0};
+    std::atomic<std::uint64_t> written{0};
+    std::atomic<std::uint64_t> dropped{0};
+    std::atomic<bool> running{false};
+    std::thread flusher;
+
+    // The flusher sleeps on `ready` while the buffer is empty; producers only
+    // take the mutex when `sleeping` says it is waiting. flush() waits on `drained`.
+    std::mutex wakeMutex;
+    std::condition_variable ready;
+    std::condition_variable drained;
+    std::atomic<bool> sleeping{false};
+};
+
+#endif // ASYNCLOGGER_HPP
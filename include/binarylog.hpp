@@ -0,0 +1,106 @@
+#ifndef BINARYLOG_HPP
+#define BINARYLOG_HPP
+
+#include <cstdint>
+#include <initializer_list>
+#include <istream>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Fixed-schema pipeline events. Values are part of the on-disk format: append
+// new ids, never renumber.
+enum class EventId : std::uint16_t {
+    FileDeleted = 1,
+    FileArchived = 2,
+    DirectoryDeleted = 3,
+    DirectorySummary = 4,
+    CycleSummary = 5
+};
+
+// Name and integer field names of an event id, shared by writer and decoder.
+struct EventSchema {
+    const char* name;
+    std::vector<const char*> fields;
+};
+
+// Returns nullptr for ids this build does not know.
+const EventSchema* findEventSchema(std::uint16_t id);
+
+// Optional binary sink for high-frequency pipeline tracing. Each event is a
+// fixed-layout record (event id, microsecond timestamp, interned path id,
+// integer fields); a path string is written once per segment the first time
+// it is seen. A segment ends when the string table reaches MAX_STRINGS, so
+// the table's memory stays bounded however many distinct paths a long run sees. Records are buffered and written with a single write() when the
+// buffer fills or on flush(). Decode with efms-logdump.
+//
+// On-disk format (all integers little-endian). Every session starts with a
+// segment record, which resets the string table:
+//   0xB0 'E' 'F' 'M' 'S' 'B' 'L' 'G' version:u8
+//   0xB1 id:u32 length:u16 bytes[length]                          string
+//   0xB2 event:u16 timestamp_us:u64 path:u32 count:u8 i64[count]  event
+class BinaryEventLog {
+public:
+    static constexpr std::uint8_t FORMAT_VERSION = 1;
+    static constexpr std::size_t MAX_FIELDS = 16;
+    static constexpr std::size_t MAX_STRINGS = 4096;
+
+    // Process-wide sink configured from the "logging" section of config.json.
+    static BinaryEventLog& getInstance();
+
+    // An empty path creates a disabled sink.
+    BinaryEventLog(const std::string& path, std::size_t bufferBytes);
+    ~BinaryEventLog();
+
+    BinaryEventLog(const BinaryEventLog&) = delete;
+    BinaryEventLog& operator=(const BinaryEventLog&) = delete;
+
+    bool isEnabled() const { return fd >= 0; }
+
+    // Fields beyond MAX_FIELDS are dropped.
+    void record(EventId event, const std::string& path, std::initializer_list<std::int64_t> fields);
+    void flush();
+
+private:
+    void beginSegmentLocked();
+    std::uint32_t internLocked(const std::string& value);
+    void flushLocked();
+
+    int fd = -1;
+    std::size_t bufferBytes;
+    std::vector<unsigned char> buffer;
+    std::unordered_map<std::string, std::uint32_t> strings;
+    std::mutex mutex;
+};
+
+// A decoded event with its path resolved from the string table.
+struct DecodedEvent {
+    std::uint16_t event = 0;
+    std::uint64_t timestampUs = 0;
+    std::string path;
+    std::vector<std::int64_t> fields;
+};
+
+// Sequential reader for files written by BinaryEventLog. A truncated or
+// unknown record, e.g. one torn by a crash, is skipped up to the next segment
+// header, so the sessions appended after it are still read.
+class BinaryEventReader {
+public:
+    explicit BinaryEventReader(std::istream& input) : input(input) {}
+
+    // Returns false at end of input.
+    bool next(DecodedEvent& event);
+    // True if records had to be skipped.
+    bool isCorrupt() const { return corrupt; }
+
+private:
+    // Moves to the next segment header after the record that started at `from`. False if there is none.
+    bool resync(std::streampos from);
+
+    std::istream& input;
+    std::unordered_map<std::uint32_t, std::string> strings;
+    bool corrupt = false;
+};
+
+#endif // BINARYLOG_HPP
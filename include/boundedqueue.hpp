@@ -0,0 +1,82 @@
+#ifndef BOUNDEDQUEUE_HPP
+#define BOUNDEDQUEUE_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+// Fixed-capacity multi-producer queue. Producers block while the queue is full
+// (backpressure); the consumer drains items in batches.
+template <typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(std::size_t capacity) : capacity(capacity == 0 ? 1 : capacity) {}
+
+    // Blocks while the queue is full. Returns false if the queue has been closed.
+    bool push(T item) {
+        std::unique_lock<std::mutex> lock(mutex);
+        notFull.wait(lock, [this] { return closed || items.size() < capacity; });
+        if (closed) return false;
+        items.push_back(std::move(item));
+        notEmpty.notify_one();
+        return true;
+    }
+
+    // Non-blocking push. Returns false if the queue is full or closed.
+    bool tryPush(T item) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (closed || items.size() >= capacity) return false;
+        items.push_back(std::move(item));
+        notEmpty.notify_one();
+        return true;
+    }
+
+    // Waits up to 'timeout' for at least one item, then moves up to 'maxItems' into 'out'.
+    // Returns the number of items moved; 0 on timeout or when closed and drained.
+    std::size_t popBatch(std::vector<T>& out, std::size_t maxItems, std::chrono::milliseconds timeout) {
+        std::unique_lock<std::mutex> lock(mutex);
+        notEmpty.wait_for(lock, timeout, [this] { return closed || !items.empty(); });
+
+        std::size_t count = 0;
+        while (!items.empty() && count < maxItems) {
+            out.push_back(std::move(items.front()));
+            items.pop_front();
+            ++count;
+        }
+        if (count > 0) notFull.notify_all();
+        return count;
+    }
+
+    // Rejects further pushes and wakes all waiters. Items already queued remain poppable.
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+        notFull.notify_all();
+        notEmpty.notify_all();
+    }
+
+    bool isClosed() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return closed;
+    }
+
+    std::size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return items.size();
+    }
+
+    std::size_t getCapacity() const { return capacity; }
+
+private:
+    const std::size_t capacity;
+    std::deque<T> items;
+    bool closed = false;
+    mutable std::mutex mutex;
+    std::condition_variable notFull;
+    std::condition_variable notEmpty;
+};
+
+#endif // BOUNDEDQUEUE_HPP
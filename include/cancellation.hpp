@@ -0,0 +1,41 @@
+#ifndef CANCELLATION_HPP
+#define CANCELLATION_HPP
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+
+// Cooperative cancellation for long-running work. Copies of a token share
+// state: whoever owns the run calls cancel(), the pipelines poll
+// isCancelled() at their chunk and directory boundaries and unwind. A
+// deadline cancels the token implicitly once it passes.
+class CancellationToken {
+public:
+    // A fresh token that is neither cancelled nor bounded by a deadline.
+    CancellationToken();
+
+    // Shared token that is never cancelled, for callers without a run to stop.
+    static const CancellationToken& none();
+
+    void cancel(const std::string& reason);
+    void setDeadline(std::chrono::steady_clock::time_point deadline);
+
+    bool isCancelled() const;
+    // Why the token is cancelled ("deadline exceeded" or the cancel() reason); empty if it is not.
+    std::string reason() const;
+
+private:
+    struct State {
+        std::atomic<bool> cancelled{false};
+        // steady_clock ticks; max() means no deadline
+        std::atomic<std::chrono::steady_clock::rep> deadline{std::chrono::steady_clock::duration::max().count()};
+        mutable std::mutex mutex;
+        std::string reason;
+    };
+
+    std::shared_ptr<State> state;
+};
+
+#endif // CANCELLATION_HPP
@@ -0,0 +1,34 @@
+#ifndef CHUNKEDCOPY_HPP
+#define CHUNKEDCOPY_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "cancellation.hpp"
+#include "iopressure.hpp"
+
+constexpr std::size_t DEFAULT_COPY_CHUNK = 256 * 1024;
+
+enum class CopyStatus { Copied, Cancelled, Failed };
+
+struct CopyResult {
+    CopyStatus status = CopyStatus::Failed;
+    std::uint64_t bytes = 0;
+    // Set when status is Failed
+    std::string error;
+};
+
+// Copies source to destination in fixed-size chunks, throttled to
+// bandwidthLimitKb KB/s (0: unlimited). The data goes to a uniquely named
+// temporary file next to the destination, which is fsynced and renamed into
+// place, so a reader never sees a partial archive and concurrent copies to
+// one destination each publish a whole file. The token is checked between chunks
+// and while throttling; on cancellation the temporary file is removed and
+// the destination is left untouched. Missing parent directories are created.
+// With a throttle, the bandwidth is looked up per chunk so a copy in progress
+// slows down as soon as I/O pressure rises.
+CopyResult copyFileChunked(const std::string& source, const std::string& destination, int bandwidthLimitKb,
+                           const CancellationToken& token, std::size_t chunkSize = DEFAULT_COPY_CHUNK,
+                           const PressureThrottle* throttle = nullptr);
+
+#endif // CHUNKEDCOPY_HPP
@@ -0,0 +1,92 @@
+#ifndef CONFIGSERVICE_HPP
+#define CONFIGSERVICE_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+// One parse of config.json. Never modified after publication; readers keep
+// the shared_ptr for as long as they need a consistent view.
+class ConfigSnapshot {
+public:
+    ConfigSnapshot(nlohmann::json document, std::uint64_t version, bool loaded, std::string error = "");
+
+    const nlohmann::json& json() const { return document; }
+    // The named top-level section, or an empty object.
+    const nlohmann::json& section(const char* name) const;
+
+    std::uint64_t version() const { return snapshotVersion; }
+    // False if the file could not be opened or parsed; error() says why.
+    bool isLoaded() const { return loaded; }
+    const std::string& error() const { return loadError; }
+
+private:
+    nlohmann::json document;
+    std::uint64_t snapshotVersion;
+    bool loaded;
+    std::string loadError;
+};
+
+// Owns config.json for the whole process. The file is parsed once into a
+// snapshot; with watching started, inotify reports edits and each one is
+// re-parsed, validated and published with an atomic pointer swap (RCU
+// style). Pipelines re-read current() at their batch boundaries, so work in
+// flight finishes on the snapshot it started with.
+class ConfigService {
+public:
+    using Listener = std::function<void(const ConfigSnapshot&)>;
+
+    // Process-wide instance for config.json in the working directory.
+    static ConfigService& getInstance();
+
+    explicit ConfigService(std::string path);
+    ~ConfigService();
+
+    ConfigService(const ConfigService&) = delete;
+    ConfigService& operator=(const ConfigService&) = delete;
+
+    std::shared_ptr<const ConfigSnapshot> current() const;
+
+    // Re-reads the file. Publishes and notifies listeners if it parses and
+    // validates; otherwise keeps the current snapshot and returns false.
+    bool reload();
+    std::string lastError() const;
+
+    // Called after each published reload, on the reloading thread.
+    void addListener(Listener listener);
+
+    // Starts/stops the inotify watcher thread. Safe to call more than once.
+    void startWatching();
+    void stopWatching();
+
+    // Checks the sections EFMS retunes at runtime; returns "" if valid.
+    static std::string validate(const nlohmann::json& config);
+
+    const std::string& configPath() const { return path; }
+
+private:
+    std::shared_ptr<const ConfigSnapshot> parse(std::uint64_t version) const;
+    void publish(std::shared_ptr<const ConfigSnapshot> next);
+    void watch();
+
+    const std::string path;
+    // Only accessed through std::atomic_load/std::atomic_store
+    std::shared_ptr<const ConfigSnapshot> snapshot;
+
+    mutable std::mutex mutex;
+    std::vector<Listener> listeners;
+    std::string error;
+
+    int inotifyFd = -1;
+    int stopFd = -1;
+    std::atomic<bool> watching{false};
+    std::thread watcher;
+};
+
+#endif // CONFIGSERVICE_HPP
@@ -0,0 +1,80 @@
+#ifndef CONNECTIONPOOL_HPP
+#define CONNECTIONPOOL_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <pqxx/pqxx>
+
+// Small pool of PostgreSQL connections. Connections are created lazily up to
+// the configured size, health-checked when they have been idle, and handed out
+// through a scoped Lease that returns the connection on destruction.
+class ConnectionPool {
+public:
+    class Lease {
+    public:
+        Lease(Lease&& other) noexcept;
+        Lease& operator=(Lease&& other) noexcept;
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+        ~Lease();
+
+        pqxx::connection& operator*() { return *connection; }
+        pqxx::connection* operator->() { return connection.get(); }
+
+        // Marks the connection as unusable so it is closed instead of returned.
+        void invalidate() { broken = true; }
+
+    private:
+        friend class ConnectionPool;
+        Lease(ConnectionPool* pool, std::unique_ptr<pqxx::connection> connection);
+
+        ConnectionPool* pool;
+        std::unique_ptr<pqxx::connection> connection;
+        bool broken = false;
+    };
+
+    static ConnectionPool& getInstance();
+
+    // Blocks until a connection is available. Throws std::runtime_error on timeout
+    // and pqxx::broken_connection if a new connection cannot be opened.
+    Lease acquire();
+
+    // Opens a connection outside the pool for long-lived sessions such as LISTEN.
+    std::unique_ptr<pqxx::connection> openDedicatedConnection();
+
+    std::size_t maxSize() const { return poolSize; }
+    std::size_t openConnections() const;
+    std::size_t idleConnections() const;
+
+    ConnectionPool(const ConnectionPool&) = delete;
+    ConnectionPool& operator=(const ConnectionPool&) = delete;
+
+private:
+    struct IdleConnection {
+        std::unique_ptr<pqxx::connection> connection;
+        std::chrono::steady_clock::time_point lastUsed;
+    };
+
+    ConnectionPool();
+
+    std::unique_ptr<pqxx::connection> createConnection();
+    bool isHealthy(pqxx::connection& connection, std::chrono::steady_clock::time_point lastUsed);
+    void release(std::unique_ptr<pqxx::connection> connection, bool broken);
+
+    std::string connectionString;
+    std::size_t poolSize;
+    std::chrono::seconds healthCheckIdle;
+    std::chrono::milliseconds acquireTimeout;
+
+    mutable std::mutex mutex;
+    std::condition_variable available;
+    std::vector<IdleConnection> idle;
+    std::size_t openCount = 0;
+};
+
+#endif // CONNECTIONPOOL_HPP
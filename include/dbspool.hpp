@@ -0,0 +1,40 @@
+#ifndef DBSPOOL_HPP
+#define DBSPOOL_HPP
+
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "dbwriter.hpp"
+
+// Durable append-only spool for DB writes that could not be applied because
+// Postgres was unreachable. Each write is one JSON line; appends are fsync'd.
+// The set of spooled archival-status paths is kept in memory so the archival
+// pipeline can tell a file was already copied while its UPDATE is pending.
+class DbSpool {
+public:
+    explicit DbSpool(const std::string& path);
+
+    // Appends the writes and fsyncs the file. Returns false if the spool could not be written.
+    bool append(const std::vector<const DbWriteRequest*>& writes);
+    // Reads every complete record; a torn trailing line from a crash is skipped.
+    std::vector<DbWriteRequest> readAll() const;
+    // Truncates the spool after a successful replay.
+    void clear();
+
+    bool empty() const;
+    std::size_t size() const;
+    bool hasPendingArchivalStatus(const std::string& filePath) const;
+    const std::string& getPath() const { return path; }
+
+private:
+    std::vector<DbWriteRequest> readAllLocked() const;
+
+    std::string path;
+    mutable std::mutex mutex;
+    std::unordered_set<std::string> pendingArchivalPaths;
+    std::size_t pendingCount = 0;
+};
+
+#endif // DBSPOOL_HPP
@@ -0,0 +1,117 @@
+#ifndef DBWRITER_HPP
+#define DBWRITER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include <pqxx/pqxx>
+#include "boundedqueue.hpp"
+#include "loggingservice.hpp"
+
+class DbSpool;
+
+// A single pending database write produced by a pipeline.
+struct DbWriteRequest {
+    enum class Type {
+        Incident,            // INSERT into incident (deduplicated against active incidents)
+        VideoArchivalStatus, // UPDATE analytics.dds_video_file_location
+        ParquetArchivalStatus // UPDATE analytics.dds_parquet_file_location
+    };
+
+    Type type;
+    std::string key;       // incident message, or the source file path for archival status
+    std::string value;     // incident details (JSON text), or the DDS file path
+    std::string errorCode; // incident error code; empty for archival status
+    // How the caller logs a failed incident insert; empty for DB_OPERATION_FAIL/05003
+    std::string failureType;
+    std::string failureCode;
+    // Log of the controller that enqueued the write; not spooled, replayed writes use the default logger
+    LoggingService* logger = nullptr;
+};
+
+// Background DB writer. Pipelines enqueue writes and continue; a dedicated
+// thread drains the queue in batches. Enqueue blocks when the queue is full.
+// Writes that cannot reach Postgres are appended to a durable spool and
+// replayed in bulk once the database is reachable again.
+class DbWriter {
+public:
+    static DbWriter& getInstance();
+
+    // A failed write is reported to `logger`, or to the default logger when null. A failed insert
+    // is logged as failure_type/failure_code, the caller's own DB error incident.
+    void enqueueIncident(const std::string& message, const nlohmann::json& details, const std::string& error_code,
+                         const std::string& failure_type = "DB_OPERATION_FAIL",
+                         const std::string& failure_code = "05003",
+                         LoggingService* logger = nullptr);
+    void enqueueVideoArchivalStatus(const std::string& filePath, const std::string& ddsFilePath,
+                                    LoggingService* logger = nullptr);
+    void enqueueParquetArchivalStatus(const std::string& filePath, const std::string& ddsFilePath,
+                                      LoggingService* logger = nullptr);
+
+    // Blocks until every write enqueued before the call has been applied (or failed).
+    void flush();
+    // Stops accepting writes, drains the queue and joins the writer thread.
+    void shutdown();
+
+    std::size_t pendingWrites() const;
+
+    // True if an archival-status update for this path is queued, being applied
+    // or spooled awaiting replay.
+    bool hasPendingArchivalStatus(const std::string& filePath) const;
+    std::size_t spooledWrites() const;
+
+    // Logger for the writer's own events and for writes enqueued without one; set once at startup.
+    void setDefaultLogger(LoggingService* logger);
+
+    ~DbWriter();
+    DbWriter(const DbWriter&) = delete;
+    DbWriter& operator=(const DbWriter&) = delete;
+
+private:
+    DbWriter();
+
+    void enqueue(DbWriteRequest request);
+    // Archival-status paths between enqueue() and commit or spool
+    void trackArchivalStatus(const std::string& filePath);
+    void untrackArchivalStatus(const std::string& filePath);
+    void run();
+    void applyBatch(std::vector<DbWriteRequest>& batch);
+    bool applyWrites(const std::vector<const DbWriteRequest*>& writes);
+    void spoolWrites(const std::vector<const DbWriteRequest*>& writes);
+    bool replaySpool();
+    void applyWrite(pqxx::work& txn, const DbWriteRequest& request);
+    void applyIncident(pqxx::work& txn, const DbWriteRequest& request);
+    void applyArchivalStatus(pqxx::work& txn, const DbWriteRequest& request);
+    void recordArchivalFailureIncident(pqxx::connection& connection, const DbWriteRequest& request, const std::string& error);
+    void reportFailure(const DbWriteRequest& request, const std::string& error);
+    LoggingService* loggerFor(const DbWriteRequest& request) const;
+
+    std::atomic<LoggingService*> defaultLogger{nullptr};
+    std::size_t batchSize;
+    BoundedQueue<DbWriteRequest> queue;
+    std::unique_ptr<DbSpool> spool;
+    std::chrono::seconds spoolReplayInterval;
+    std::chrono::steady_clock::time_point nextReplayAttempt{};
+
+    mutable std::mutex inFlightMutex;
+    std::unordered_map<std::string, std::size_t> inFlightArchival;
+
+    std::atomic<std::uint64_t> enqueuedCount{0};
+    std::uint64_t completedCount = 0;
+    std::mutex completedMutex;
+    std::condition_variable completedCv;
+
+    std::mutex shutdownMutex;
+    bool stopped = false;
+    std::thread worker;
+};
+
+#endif // DBWRITER_HPP
@@ -0,0 +1,50 @@
+#ifndef DISKPRESSURE_HPP
+#define DISKPRESSURE_HPP
+
+#include <chrono>
+#include <functional>
+#include <string>
+#include <vector>
+#include "fileservice.hpp"
+
+// Samples volume utilization through the FileService and reports volumes that cross
+// their storage threshold, so eviction can start within one sample interval
+// of a recording burst instead of at the next scheduled run. Owns no thread;
+// the scheduler calls sample() from a periodic timer.
+class DiskPressureMonitor {
+public:
+    // Called with the volume name and its utilization in percent.
+    using Handler = std::function<void(const std::string& volume, double utilization)>;
+
+    // A volume that stays over its threshold is reported again after retriggerAfter.
+    explicit DiskPressureMonitor(std::chrono::steady_clock::duration retriggerAfter);
+
+    void addVolume(const std::string& name, const std::string& path, int thresholdPercent, Handler handler);
+    // Applies a reloaded threshold; unknown names are ignored.
+    void setThreshold(const std::string& name, int thresholdPercent);
+
+    // Samples every volume once and returns how many were reported.
+    std::size_t sample(std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now());
+
+    // Used space in percent, or a negative value if the path cannot be read.
+    static double utilization(const std::string& path);
+    // The same figure from a given FileService, the one the controllers compare
+    // against their thresholds: space unavailable to EFMS over total, so the
+    // blocks reserved for root count as used. Throws what the FileService throws.
+    static double utilization(FileService& fileService, const std::string& path);
+
+private:
+    struct Volume {
+        std::string name;
+        std::string path;
+        int thresholdPercent;
+        Handler handler;
+        bool overThreshold = false;
+        std::chrono::steady_clock::time_point lastReported;
+    };
+
+    std::chrono::steady_clock::duration retriggerAfter;
+    std::vector<Volume> volumes;
+};
+
+#endif // DISKPRESSURE_HPP
@@ -0,0 +1,111 @@
+#ifndef IOPRESSURE_HPP
+#define IOPRESSURE_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "cancellation.hpp"
+
+// How hard EFMS file work backs off for the rest of the node.
+enum class PressureLevel {
+    Clear,
+    // Files are admitted one per slow delay and copies run at the slow bandwidth
+    Slowed,
+    // No new files are admitted and no roots walked until pressure drops
+    Paused
+};
+
+// Gate the normal archival and retention pipelines pass through, moved
+// between levels by the PsiMonitor. Eviction never goes through it: freeing
+// a full disk matters more than the latency it costs. Starts Clear.
+class PressureThrottle {
+public:
+    static PressureThrottle& getInstance();
+
+    PressureThrottle() = default;
+
+    PressureThrottle(const PressureThrottle&) = delete;
+    PressureThrottle& operator=(const PressureThrottle&) = delete;
+
+    void setLevel(PressureLevel level);
+    PressureLevel level() const;
+    // Delay per admitted file and copy bandwidth cap (KB/s, 0: none) while not Clear.
+    void setLimits(std::chrono::milliseconds slowDelay, int slowBandwidthKb);
+
+    // Called by a pipeline coordinator before admitting a file or walking a
+    // root: returns at once when Clear, after the slow delay when Slowed and
+    // once pressure drops when Paused. Returns false if the token was
+    // cancelled while waiting.
+    bool pace(const CancellationToken& token);
+    // Bandwidth for a copy configured at limitKb KB/s (0: unlimited) under the current level.
+    int bandwidthKb(int limitKb) const;
+
+private:
+    mutable std::mutex mutex;
+    std::condition_variable changed;
+    PressureLevel current = PressureLevel::Clear;
+    std::chrono::milliseconds slowDelay{200};
+    int slowBandwidthKb = 1024;
+};
+
+// Samples Linux pressure stall information (/proc/pressure/io,
+// /proc/pressure/memory or a cgroup's io.pressure) and moves a
+// PressureThrottle with hysteresis: Slowed once the "some avg10" stall share
+// of any source reaches slowAbove, Paused at pauseAbove, back to Slowed below
+// slowAbove and Clear below resumeBelow. Sources that cannot be read are
+// skipped; with none readable the throttle is Clear. Owns no thread; the
+// scheduler calls sample() from a periodic timer.
+class PsiMonitor {
+public:
+    struct Thresholds {
+        // Percent of the last 10 s some task was stalled
+        double slowAbove = 10.0;
+        double pauseAbove = 40.0;
+        double resumeBelow = 5.0;
+    };
+
+    // The "io_pressure" config section.
+    struct Settings {
+        bool enabled = false;
+        int sampleSeconds = 2;
+        std::vector<std::string> sources{"/proc/pressure/io", "/proc/pressure/memory"};
+        Thresholds thresholds;
+        std::chrono::milliseconds slowDelay{200};
+        int slowBandwidthKb = 1024;
+    };
+
+    // Called on every level change with the new level and the stall that caused it.
+    using Handler = std::function<void(PressureLevel level, double stall)>;
+
+    static Settings configured();
+    // Parses an "io_pressure" section over settings. Returns the problem, or empty if valid.
+    static std::string parseSettings(const nlohmann::json& section, Settings& settings);
+
+    PsiMonitor(std::vector<std::string> sources, const Thresholds& thresholds, PressureThrottle& throttle,
+               Handler handler);
+
+    // Applies reloaded settings; the sources stay as they were.
+    void setThresholds(const Thresholds& thresholds);
+
+    // Reads every source once and updates the throttle. Returns the highest
+    // stall read, or a negative value if no source could be read.
+    double sample();
+
+    // "some avg10" of a PSI file in percent, or a negative value if it cannot be read.
+    static double readStall(const std::string& path);
+    static PressureLevel nextLevel(PressureLevel current, double stall, const Thresholds& thresholds);
+
+private:
+    const std::vector<std::string> sources;
+    Thresholds thresholds;
+    PressureThrottle& throttle;
+    Handler handler;
+};
+
+const char* pressureLevelName(PressureLevel level);
+
+#endif // IOPRESSURE_HPP
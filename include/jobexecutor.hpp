@@ -0,0 +1,140 @@
+#ifndef JOBEXECUTOR_HPP
+#define JOBEXECUTOR_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "cancellation.hpp"
+
+// What submit() does when the job already has a run in progress.
+enum class OverlapPolicy {
+    // Drop the new run (scheduled scans: the next deadline covers it)
+    Skip,
+    // Run it once the current run ends; a later submit of the same kind replaces it
+    Queue
+};
+
+// How a cancellable run is admitted and bounded.
+struct RunOptions {
+    OverlapPolicy overlap = OverlapPolicy::Skip;
+    // preempt() may cancel the run, e.g. background archival displaced by urgent retention
+    bool preemptible = false;
+    // Cancels the run's token this long after it starts; zero for no limit
+    std::chrono::steady_clock::duration timeLimit = std::chrono::steady_clock::duration::zero();
+    // What the run does, e.g. "eviction" or "notified". Queued runs coalesce only with
+    // runs of the same kind; runs of different kinds wait their turn in submit order.
+    std::string kind;
+};
+
+// Runs each named job on its own worker thread, so a long archival backlog
+// does not hold up retention. Runs of the same job never overlap. Each run
+// gets a CancellationToken; preempt() and shutdown() cancel it and the run
+// unwinds at its next chunk or directory boundary.
+class JobExecutor {
+public:
+    using Task = std::function<void()>;
+    using CancellableTask = std::function<void(const CancellationToken&)>;
+    using FinishedListener = std::function<void(const std::string& job)>;
+
+    JobExecutor() = default;
+    ~JobExecutor();
+
+    JobExecutor(const JobExecutor&) = delete;
+    JobExecutor& operator=(const JobExecutor&) = delete;
+
+    // Starts the worker for a job; a no-op if it already exists.
+    void addJob(const std::string& name);
+
+    // Called on the job's worker after each run, including runs that failed.
+    void setFinishedListener(FinishedListener listener);
+
+    // Returns false if the run was skipped or the executor is shut down.
+    // Throws std::invalid_argument for an unknown job.
+    bool submit(const std::string& name, Task task, OverlapPolicy overlap = OverlapPolicy::Skip);
+    bool submit(const std::string& name, CancellableTask task, RunOptions options);
+
+    // Cancels the job's run in progress if it was submitted as preemptible.
+    // Returns true if a run was cancelled.
+    bool preempt(const std::string& name, const std::string& reason);
+
+    bool isRunning(const std::string& name) const;
+    std::uint64_t completedRuns(const std::string& name) const;
+    std::uint64_t skippedRuns(const std::string& name) const;
+
+    // Drops queued runs, cancels the runs in progress and waits for them to unwind.
+    void shutdown();
+
+private:
+    struct QueuedRun {
+        CancellableTask task;
+        RunOptions options;
+    };
+
+    struct Job {
+        std::string name;
+        std::deque<QueuedRun> queued;
+        bool running = false;
+        bool runningPreemptible = false;
+        CancellationToken token;
+        std::uint64_t completed = 0;
+        std::uint64_t skipped = 0;
+        std::thread worker;
+    };
+
+    void work(Job& job);
+    const Job& find(const std::string& name) const;
+
+    mutable std::mutex mutex;
+    std::condition_variable changed;
+    std::map<std::string, std::unique_ptr<Job>> jobs;
+    FinishedListener finishedListener;
+    bool stopping = false;
+};
+
+// Counting semaphore bounding how many heavy file operations (archival copies,
+// deletions) run at once across all jobs, so concurrent jobs share the disks
+// instead of multiplying the load. Sized by scheduler.io_concurrency.
+class IoBudget {
+public:
+    // Held for the duration of one file operation.
+    class Permit {
+    public:
+        explicit Permit(IoBudget& budget);
+        ~Permit();
+
+        Permit(const Permit&) = delete;
+        Permit& operator=(const Permit&) = delete;
+
+    private:
+        IoBudget& budget;
+    };
+
+    static IoBudget& getInstance();
+
+    explicit IoBudget(std::size_t slots);
+
+    IoBudget(const IoBudget&) = delete;
+    IoBudget& operator=(const IoBudget&) = delete;
+
+    std::size_t capacity() const { return slots; }
+    std::size_t inUse() const;
+
+private:
+    void acquire();
+    void release();
+
+    const std::size_t slots;
+    std::size_t used = 0;
+    mutable std::mutex mutex;
+    std::condition_variable available;
+};
+
+#endif // JOBEXECUTOR_HPP
@@ -0,0 +1,67 @@
+#ifndef LOGLEVEL_HPP
+#define LOGLEVEL_HPP
+
+#include <atomic>
+#include <iostream>
+#include <string>
+
+// Console diagnostics with a compile-time floor and a runtime level.
+//
+// Statements below EFMS_COMPILE_LOG_LEVEL sit in a discarded `if constexpr`
+// branch: they are type-checked but generate no code, and their arguments are
+// never evaluated. Release builds set the floor to Info (see CMakeLists.txt /
+// Makefile), so EFMS_TRACE/EFMS_DEBUG cost nothing there. Statements at or
+// above the floor are filtered at runtime by logging.level in config.json.
+enum class LogLevel : int {
+    Trace = 0,
+    Debug = 1,
+    Info = 2,
+    Warning = 3,
+    Error = 4,
+    Off = 5
+};
+
+#ifndef EFMS_COMPILE_LOG_LEVEL
+#define EFMS_COMPILE_LOG_LEVEL 1
+#endif
+
+constexpr LogLevel COMPILE_LOG_LEVEL = static_cast<LogLevel>(EFMS_COMPILE_LOG_LEVEL);
+
+constexpr bool logLevelCompiledIn(LogLevel level) {
+    return static_cast<int>(level) >= static_cast<int>(COMPILE_LOG_LEVEL);
+}
+
+// Runtime level, initialised from the "logging" section of config.json.
+std::atomic<int>& runtimeLogLevelStorage();
+
+inline LogLevel runtimeLogLevel() {
+    return static_cast<LogLevel>(runtimeLogLevelStorage().load(std::memory_order_relaxed));
+}
+
+inline void setRuntimeLogLevel(LogLevel level) {
+    runtimeLogLevelStorage().store(static_cast<int>(level), std::memory_order_relaxed);
+}
+
+inline bool logLevelEnabled(LogLevel level) {
+    return static_cast<int>(level) >= static_cast<int>(runtimeLogLevel());
+}
+
+// Accepts trace, debug, info, warning, error and off.
+bool parseLogLevel(const std::string& name, LogLevel& level);
+
+#define EFMS_LOG(level, stream, expr)                         \
+    do {                                                      \
+        if constexpr (logLevelCompiledIn(level)) {            \
+            if (logLevelEnabled(level)) {                     \
+                stream << expr << '\n';                       \
+            }                                                 \
+        }                                                     \
+    } while (0)
+
+#define EFMS_TRACE(expr) EFMS_LOG(LogLevel::Trace, std::cout, "[TRACE] " << expr)
+#define EFMS_DEBUG(expr) EFMS_LOG(LogLevel::Debug, std::cout, "[DEBUG] " << expr)
+#define EFMS_INFO(expr) EFMS_LOG(LogLevel::Info, std::cout, expr)
+#define EFMS_WARNING(expr) EFMS_LOG(LogLevel::Warning, std::cerr, "[WARNING] " << expr)
+#define EFMS_ERROR(expr) EFMS_LOG(LogLevel::Error, std::cerr, "[ERROR] " << expr)
+
+#endif // LOGLEVEL_HPP
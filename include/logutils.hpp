@@ -2,17 +2,34 @@
 #define LOGUTILS_HPP
 
 #include <chrono>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
 #include <ctime>
-#include <sstream>
-#include <iomanip>
+#include <string>
+#include <string_view>
+#include <type_traits>
 #include <nlohmann/json.hpp>
 
+// Returns the local time as "YYYY-MM-DD HH:MM:SS". The rendered second is
+// cached per thread and only re-formatted when the second changes.
+inline const char* cachedTimestamp() {
+    thread_local std::time_t cachedSecond = static_cast<std::time_t>(-1);
+    thread_local char rendered[20] = {};
+
+    std::time_t current = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+    if (current != cachedSecond) {
+        std::tm local{};
+        localtime_r(&current, &local);
+        std::strftime(rendered, sizeof(rendered), "%Y-%m-%d %H:%M:%S", &local);
+        cachedSecond = current;
+    }
+    return rendered;
+}
+
 inline std::string getCurrentTimestamp() {
-    auto now = std::chrono::system_clock::now();
-    auto time = std::chrono::system_clock::to_time_t(now);
-    std::stringstream ss;
-    ss << std::put_time(std::localtime(&time), "%Y-%m-%d %H:%M:%S");
-    return ss.str();
+    return std::string(cachedTimestamp());
 }
 
 inline nlohmann::json createLogInfo(const nlohmann::json& additionalData = nlohmann::json()) {
@@ -21,4 +38,155 @@ inline nlohmann::json createLogInfo(const nlohmann::json& additionalData = nlohm
     return info;
 }
 
+// Fixed-capacity structured log record for hot paths. Building one performs no
+// heap allocation: field values are copied into an inline text arena and the
+// timestamp comes from cachedTimestamp(). The JSON form is only produced by
+// toJson(), on the thread that writes the record out.
+//
+// message, code and field keys are stored as pointers and must outlive the
+// record (string literals). Values that do not fit are truncated and the
+// record is flagged as such.
+class LogRecord {
+public:
+    static constexpr std::size_t MAX_FIELDS = 16;
+    static constexpr std::size_t TEXT_CAPACITY = 1024;
+
+    explicit LogRecord(const char* message = "", const char* code = "")
+        : messageText(message), codeText(code) {
+        std::memcpy(timestampText, cachedTimestamp(), sizeof(timestampText));
+    }
+
+    template <typename T>
+    LogRecord& add(const char* key, const T& value) {
+        if constexpr (std::is_same_v<T, bool>) {
+            if (Field* field = nextField(key, Kind::Bool)) field->boolean = value;
+        } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+            if (Field* field = nextField(key, Kind::Signed)) field->signedValue = value;
+        } else if constexpr (std::is_integral_v<T>) {
+            if (Field* field = nextField(key, Kind::Unsigned)) field->unsignedValue = value;
+        } else if constexpr (std::is_floating_point_v<T>) {
+            if (Field* field = nextField(key, Kind::Double)) field->doubleValue = value;
+        } else {
+            addText(key, std::string_view(value));
+        }
+        return *this;
+    }
+
+    // printf-style text field, e.g. addFormatted("age", "%d hours", age).
+    LogRecord& addFormatted(const char* key, const char* format, ...)
+        __attribute__((format(printf, 3, 4))) {
+        Field* field = nextField(key, Kind::Text);
+        if (!field) return *this;
+
+        std::size_t available = TEXT_CAPACITY - textUsed;
+        va_list args;
+        va_start(args, format);
+        int written = std::vsnprintf(text + textUsed, available + 1, format, args);
+        va_end(args);
+
+        std::size_t length = written < 0 ? 0 : static_cast<std::size_t>(written);
+        if (length > available) {
+            length = available;
+            truncated = true;
+        }
+        field->text = {static_cast<std::uint16_t>(textUsed), static_cast<std::uint16_t>(length)};
+        textUsed += length;
+        return *this;
+    }
+
+    const char* message() const { return messageText; }
+    const char* code() const { return codeText; }
+    const char* timestamp() const { return timestampText; }
+    std::size_t fieldCount() const { return fieldsUsed; }
+    bool isTruncated() const { return truncated; }
+
+    // Same shape as createLogInfo(): the fields plus "timestamp".
+    nlohmann::json toJson() const {
+        nlohmann::json info = nlohmann::json::object();
+        for (std::size_t i = 0; i < fieldsUsed; ++i) {
+            const Field& field = fields[i];
+            switch (field.kind) {
+                case Kind::Text:
+                    info[field.key] = std::string(text + field.text.offset, field.text.length);
+                    break;
+                case Kind::Signed:
+                    info[field.key] = field.signedValue;
+                    break;
+                case Kind::Unsigned:
+                    info[field.key] = field.unsignedValue;
+                    break;
+                case Kind::Double:
+                    info[field.key] = field.doubleValue;
+                    break;
+                case Kind::Bool:
+                    info[field.key] = field.boolean;
+                    break;
+            }
+        }
+        info["timestamp"] = timestampText;
+        if (truncated) {
+            info["truncated"] = true;
+        }
+        return info;
+    }
+
+private:
+    enum class Kind : std::uint8_t { Text, Signed, Unsigned, Double, Bool };
+
+    struct TextSpan {
+        std::uint16_t offset;
+        std::uint16_t length;
+    };
+
+    struct Field {
+        const char* key;
+        Kind kind;
+        union {
+            TextSpan text;
+            long long signedValue;
+            unsigned long long unsignedValue;
+            double doubleValue;
+            bool boolean;
+        };
+    };
+
+    Field* nextField(const char* key, Kind kind) {
+        if (fieldsUsed == MAX_FIELDS) {
+            truncated = true;
+            return nullptr;
+        }
+        Field* field = &fields[fieldsUsed++];
+        field->key = key;
+        field->kind = kind;
+        return field;
+    }
+
+    void addText(const char* key, std::string_view value) {
+        Field* field = nextField(key, Kind::Text);
+        if (!field) return;
+
+        std::size_t length = value.size();
+        if (length > TEXT_CAPACITY - textUsed) {
+            length = TEXT_CAPACITY - textUsed;
+            truncated = true;
+        }
+        std::memcpy(text + textUsed, value.data(), length);
+        field->text = {static_cast<std::uint16_t>(textUsed), static_cast<std::uint16_t>(length)};
+        textUsed += length;
+    }
+
+    const char* messageText;
+    const char* codeText;
+    char timestampText[20];
+    bool truncated = false;
+    std::size_t fieldsUsed = 0;
+    std::size_t textUsed = 0;
+    Field fields[MAX_FIELDS];
+    // One spare byte for vsnprintf's terminator
+    char text[TEXT_CAPACITY + 1];
+};
+
+static_assert(std::is_trivially_copyable<LogRecord>::value,
+              "LogRecord is copied by value through the async log ring buffer");
+
 #endif // LOGUTILS_HPP
@@ -0,0 +1,124 @@
+#ifndef PATHCLASSIFIER_HPP
+#define PATHCLASSIFIER_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Data categories handled by the pipelines. Each maps to one directory
+// component (e.g. ".../Videos/...") and one family of policy keys.
+enum class FileCategory : std::uint8_t {
+    Video,
+    Analysis,
+    Diagnostic,
+    Log,
+    VideoClip,
+    Unknown
+};
+
+constexpr std::size_t FILE_CATEGORY_COUNT = static_cast<std::size_t>(FileCategory::Unknown);
+
+inline std::size_t categoryIndex(FileCategory category) {
+    return static_cast<std::size_t>(category);
+}
+
+// Extension of the last path component without the dot; empty if none.
+std::string_view fileExtension(std::string_view filePath);
+
+// Directory component for a category, e.g. "Videos".
+const char* categoryDirectory(FileCategory category);
+
+// Category named by a single path component, or Unknown.
+FileCategory categoryOfComponent(std::string_view component);
+
+// Category of a file from its first directory component naming one.
+FileCategory classifyFile(std::string_view filePath);
+
+// A retention rule for one station/category directory.
+struct RetentionRule {
+    std::string key;
+    std::string root;
+    bool hasRetentionPeriod = false;
+    int retentionHours = 0;
+    // Extensions without the dot; empty means any file type.
+    std::vector<std::string> fileTypes;
+};
+
+// Case-insensitive perfect-hash set of file extensions. The seed and table
+// size are searched at build time so every extension has its own slot; a
+// lookup is one hash and one comparison.
+class ExtensionTable {
+public:
+    // Ids are assigned in first-seen order; duplicates share an id.
+    void build(const std::vector<std::string>& extensions);
+
+    // Id of the extension (without the dot), or -1.
+    int find(std::string_view extension) const;
+    std::size_t size() const { return count; }
+
+private:
+    static std::uint32_t hash(std::string_view extension, std::uint32_t seed);
+
+    struct Slot {
+        std::string extension;
+        int id = -1;
+    };
+
+    std::vector<Slot> slots;
+    std::uint32_t seed = 0;
+    std::uint32_t mask = 0;
+    std::size_t count = 0;
+};
+
+// Result of classifying one path.
+struct PathMatch {
+    FileCategory category = FileCategory::Unknown;
+    const RetentionRule* rule = nullptr;
+    // False if the rule lists file types and the file's extension is not one of them
+    bool extensionAllowed = true;
+};
+
+// Resolves a path to its category and most specific retention rule in a
+// single pass over its components. Policy roots are compiled into a trie of
+// path components; each trie node caches, per category, the deepest rule at
+// or above it, so the walk only has to remember the last node it reached.
+class PathClassifier {
+public:
+    PathClassifier();
+    explicit PathClassifier(std::vector<std::pair<FileCategory, RetentionRule>> rules);
+
+    PathMatch classify(std::string_view filePath) const;
+    // Rule for an already known category, ignoring file types.
+    const RetentionRule* ruleFor(FileCategory category, std::string_view filePath) const;
+
+    std::size_t ruleCount() const { return rules.size(); }
+
+private:
+    static constexpr std::int32_t NO_RULE = -1;
+    // Rules may list at most this many distinct extensions in total; rules using more are unrestricted.
+    static constexpr std::size_t MAX_EXTENSIONS = 64;
+
+    struct Node {
+        // Sorted by component for binary search
+        std::vector<std::pair<std::string, std::uint32_t>> children;
+        std::array<std::int32_t, FILE_CATEGORY_COUNT> ownRule;
+        std::array<std::int32_t, FILE_CATEGORY_COUNT> inheritedRule;
+    };
+
+    std::uint32_t childOf(std::uint32_t node, std::string_view component) const;
+    std::uint32_t addChild(std::uint32_t node, std::string_view component);
+    // Deepest trie node matching a prefix of filePath; optionally the first category component seen.
+    std::uint32_t walk(std::string_view filePath, FileCategory* category) const;
+
+    std::vector<Node> nodes;
+    std::vector<RetentionRule> rules;
+    // Allowed extension ids per rule; 0 means unrestricted
+    std::vector<std::uint64_t> extensionMasks;
+    ExtensionTable extensions;
+};
+
+#endif // PATHCLASSIFIER_HPP
@@ -0,0 +1,96 @@
+#ifndef PIPELINESUMMARY_HPP
+#define PIPELINESUMMARY_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include "asynclogger.hpp"
+#include "logutils.hpp"
+
+// Counters reported once per directory and once per pipeline cycle.
+struct PipelineCounters {
+    std::uint64_t filesSeen = 0;
+    std::uint64_t eligible = 0;
+    std::uint64_t archived = 0;
+    std::uint64_t deleted = 0;
+    // Kept apart so a file archived and then deleted is not counted twice
+    std::uint64_t bytesCopied = 0;
+    std::uint64_t bytesDeleted = 0;
+    std::uint64_t errors = 0;
+    // Eligible for archival but still not on DDS (copy cancelled or failed)
+    std::uint64_t pending = 0;
+    std::uint64_t pendingBytes = 0;
+
+    PipelineCounters& operator+=(const PipelineCounters& other);
+    LogRecord& appendTo(LogRecord& record) const;
+};
+
+// Token bucket limiting how many per-file lines reach the log. A rate of zero
+// disables limiting. Rejected lines are counted so summaries can report them.
+class TokenBucket {
+public:
+    TokenBucket(double ratePerSecond, double burst);
+
+    bool tryAcquire();
+    // Returns and resets the number of rejected acquisitions.
+    std::uint64_t takeSuppressed() { return suppressed.exchange(0, std::memory_order_relaxed); }
+
+private:
+    const double ratePerSecond;
+    const double burst;
+
+    std::mutex mutex;
+    double tokens;
+    std::chrono::steady_clock::time_point lastRefill;
+    std::atomic<std::uint64_t> suppressed{0};
+};
+
+// Shared limiter for per-file pipeline lines, configured from the "logging"
+// section of config.json. Unlimited when summary mode is disabled.
+TokenBucket& perFileLogLimiter();
+
+// Returns true if a per-file line may be logged now.
+inline bool allowPerFileLog() {
+    return perFileLogLimiter().tryAcquire();
+}
+
+// Collects counters for one pipeline run and emits a summary record per
+// directory and one for the whole cycle.
+class PipelineSummary {
+public:
+    // pipeline must be a string literal, e.g. "retention_normal".
+    PipelineSummary(AsyncLogger& log, const char* pipeline);
+    // Emits the cycle summary if finish() was not reached (e.g. on error).
+    ~PipelineSummary();
+
+    PipelineSummary(const PipelineSummary&) = delete;
+    PipelineSummary& operator=(const PipelineSummary&) = delete;
+
+    void beginDirectory(const std::string& directory);
+    void endDirectory();
+    // Emits the cycle summary (closing an open directory first).
+    void finish();
+
+    // Counters of the current directory, or of the cycle if none is open.
+    PipelineCounters& counters() { return inDirectory ? directoryCounters : cycleCounters; }
+    const PipelineCounters& totals() const { return cycleCounters; }
+    // Adds counters gathered by a parallel task to counters(); safe to call concurrently.
+    void merge(const PipelineCounters& taskCounters);
+
+private:
+    AsyncLogger& log;
+    const char* pipeline;
+    std::chrono::steady_clock::time_point startedAt;
+
+    std::string directory;
+    bool inDirectory = false;
+    bool finished = false;
+    std::uint64_t directories = 0;
+    PipelineCounters directoryCounters;
+    PipelineCounters cycleCounters;
+    std::mutex mergeMutex;
+};
+
+#endif // PIPELINESUMMARY_HPP
@@ -0,0 +1,76 @@
+#ifndef POLICYMODEL_HPP
+#define POLICYMODEL_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "pathclassifier.hpp"
+#include "ruleengine.hpp"
+
+// Category of a retention policy key, e.g. VIDEO_RETENTION_POLICY_Station1.
+FileCategory categoryForPolicyKey(const std::string& key);
+
+// Strips trailing slashes so prefix checks are exact ("/a/b/" -> "/a/b").
+std::string normalizePolicyPath(std::string path);
+
+// True if filePath is root or lies below it.
+bool isUnderPath(const std::string& filePath, const std::string& root);
+
+// Policy compiled once from the dds/vecow dictionaries so the per-file paths
+// do no map lookups, JSON traversal or string-to-number parsing.
+struct CompiledPolicy {
+    std::string mountedPath;
+    std::string ddsPath;
+    bool hasThreshold = false;
+    int thresholdPercent = 0;
+
+    // Roots to scan, in policy order, with the key they came from.
+    std::vector<std::pair<std::string, std::string>> scanRoots;
+    // Keys of path policies that had no "value"
+    std::vector<std::string> keysWithoutPath;
+
+    // Retention: rules per category, longest root first.
+    std::array<std::vector<RetentionRule>, FILE_CATEGORY_COUNT> retentionRules;
+    // Retention: the same rules compiled into a trie for per-file matching.
+    PathClassifier classifier;
+
+    // Archival: deletion age per category (archival policy RETENTION_POLICIES).
+    std::array<bool, FILE_CATEGORY_COUNT> hasDeletionAge{};
+    std::array<double, FILE_CATEGORY_COUNT> deletionAgeHours{};
+
+    // Archival: eligibility per category (config.json archival.eligibility).
+    bool eligibilityConfigured = false;
+    std::array<bool, FILE_CATEGORY_COUNT> archivalEligible{};
+
+    // Per-category predicates. Retention: deletion ("age > retention" by
+    // default). Archival: deletion ("age > retention" where a deletion age is
+    // set, else "false") and archival (from the eligibility flags).
+    std::array<RuleProgram, FILE_CATEGORY_COUNT> deletionRules;
+    std::array<RuleProgram, FILE_CATEGORY_COUNT> archivalRules;
+    // Configured rules that failed to compile and fell back to the default
+    std::vector<std::string> ruleErrors;
+
+    // From RetentionController's policy map (ddsretentionpolicy::to_dict()).
+    static CompiledPolicy fromRetentionPolicy(
+        const std::unordered_map<std::string, std::unordered_map<std::string, std::string>>& policy,
+        const nlohmann::json& rules = nlohmann::json::object());
+
+    // From ArchivalController's JSON policy (vecowretentionpolicy::to_dict())
+    // and the archival eligibility flags.
+    static CompiledPolicy fromArchivalPolicy(const nlohmann::json& policy,
+                                             const std::map<std::string, bool>& eligibility,
+                                             const nlohmann::json& rules = nlohmann::json::object());
+
+    // Most specific retention rule whose root contains filePath, or nullptr.
+    const RetentionRule* findRetentionRule(FileCategory category, const std::string& filePath) const;
+
+    // Rewrites a path under mountedPath to the same path under ddsPath.
+    bool toDdsPath(const std::string& filePath, std::string& ddsFilePath) const;
+};
+
+#endif // POLICYMODEL_HPP
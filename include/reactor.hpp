@@ -0,0 +1,97 @@
+#ifndef REACTOR_HPP
+#define REACTOR_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <unordered_map>
+
+// Single-threaded epoll loop. Each registered descriptor has one handler,
+// run on the thread inside run() whenever the descriptor becomes readable;
+// the handler must consume what made it readable. The thread sleeps in
+// epoll_wait until one of the descriptors fires.
+class Reactor {
+public:
+    using Handler = std::function<void()>;
+
+    Reactor();
+    ~Reactor();
+
+    Reactor(const Reactor&) = delete;
+    Reactor& operator=(const Reactor&) = delete;
+
+    void add(int fd, Handler handler);
+    void remove(int fd);
+
+    // Dispatches until stop(); handlers may call stop() and add()/remove().
+    void run();
+    // Safe from any thread or handler.
+    void stop();
+
+private:
+    int epollFd;
+    int stopFd;
+    std::atomic<bool> stopping{false};
+    std::unordered_map<int, Handler> handlers;
+};
+
+// timerfd armed at absolute steady_clock deadlines (CLOCK_MONOTONIC), so a
+// deadline is not shifted by how long the previous job took.
+class DeadlineTimer {
+public:
+    DeadlineTimer();
+    ~DeadlineTimer();
+
+    DeadlineTimer(const DeadlineTimer&) = delete;
+    DeadlineTimer& operator=(const DeadlineTimer&) = delete;
+
+    int fd() const { return timerFd; }
+    void armAt(std::chrono::steady_clock::time_point deadline);
+    void disarm();
+    // Number of expirations since the last call; 0 if none.
+    std::uint64_t consume();
+
+private:
+    int timerFd;
+};
+
+// eventfd any thread can use to wake a Reactor.
+class WakeupEvent {
+public:
+    WakeupEvent();
+    ~WakeupEvent();
+
+    WakeupEvent(const WakeupEvent&) = delete;
+    WakeupEvent& operator=(const WakeupEvent&) = delete;
+
+    int fd() const { return eventFd; }
+    void notify();
+    // Number of notifications since the last call; 0 if none.
+    std::uint64_t consume();
+
+private:
+    int eventFd;
+};
+
+// signalfd for a set of signals. The signals are blocked for the
+// constructing thread, and threads started afterwards inherit the mask, so
+// construct it before any other thread is started.
+class SignalSource {
+public:
+    explicit SignalSource(std::initializer_list<int> signals);
+    ~SignalSource();
+
+    SignalSource(const SignalSource&) = delete;
+    SignalSource& operator=(const SignalSource&) = delete;
+
+    int fd() const { return signalFd; }
+    // Next pending signal number, or 0 if none.
+    int next();
+
+private:
+    int signalFd;
+};
+
+#endif // REACTOR_HPP
@@ -6,6 +6,10 @@
 #include <unordered_map>
 #include "fileservice.hpp"
 #include "loggingservice.hpp"
+#include "asynclogger.hpp"
+#include "pipelinesummary.hpp"
+#include "policymodel.hpp"
+#include "cancellation.hpp"
 
 class RetentionController {
 public:
@@ -15,16 +19,24 @@ public:
                         const std::string& source);
     void logIncidentToDB(const std::string& message, const nlohmann::json& details, const std::string& error_code);
     // Public methods
-    void applyRetentionPolicy();
-    void startMaxUtilizationPipeline();
-    void startNormalPipeline();
+    // The pipelines stop at the next directory once token is cancelled.
+    void applyRetentionPolicy(const CancellationToken& token = CancellationToken::none());
+    void startMaxUtilizationPipeline(const CancellationToken& token = CancellationToken::none());
+    void startNormalPipeline(const CancellationToken& token = CancellationToken::none());
     void stopPipeline(const std::vector<std::string>& directories);
 
 private:
     // Member variables
     std::unordered_map<std::string, std::unordered_map<std::string, std::string>> retentionPolicy;
+    // The "rules" section policy was compiled with; a reload that changes it recompiles
+    std::string ruleExpressions;
+    // Typed form of retentionPolicy used on the per-file paths
+    CompiledPolicy policy;
+    // Config snapshot the tunables were last taken from
+    std::uint64_t configVersion;
     FileService fileService;
     LoggingService* logger;
+    AsyncLogger* asyncLogger;
     std::string source;
     std::string logFilePath;
     // Private methods
@@ -32,11 +44,15 @@ private:
     // bool validatePolicy(const std::unordered_map<std::string, std::unordered_map<std::string, std::string>>& policies); // With arguments
 
     bool checkRetentionPolicy();
+    bool pipelineCancelled(const CancellationToken& token, const char* pipeline);
+    void refreshTunables();
+    void reportRuleErrors();
     std::vector<std::string> getAllFilePaths();
     double diskSpaceUtilization();
     bool checkFileRetentionPolicy(const std::string& filePath);
     bool checkFilePermissions(const std::string& filePath);
     bool isFileEligibleForDeletion(const std::string& filePath);
+    void deleteFile(const std::string& file, PipelineCounters& counters);
 };
 
 #endif // RETENTIONCONTROLLER_H
@@ -0,0 +1,106 @@
+#ifndef RINGBUFFER_HPP
+#define RINGBUFFER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+// Bounded lock-free multi-producer/multi-consumer ring buffer (Vyukov's
+// sequence-per-slot design). Capacity is rounded up to a power of two.
+// T must be default-constructible and move-assignable.
+template <typename T>
+class RingBuffer {
+public:
+    explicit RingBuffer(std::size_t requestedCapacity)
+        : capacity(roundUpToPowerOfTwo(requestedCapacity)),
+          mask(capacity - 1),
+          cells(new Cell[capacity]) {
+        for (std::size_t i = 0; i < capacity; ++i) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    RingBuffer(const RingBuffer&) = delete;
+    RingBuffer& operator=(const RingBuffer&) = delete;
+
+    // Returns false without blocking if the buffer is full.
+    template <typename U>
+    bool tryPush(U&& item) {
+        std::size_t position = enqueuePos.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true) {
+            cell = &cells[position & mask];
+            std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+            if (diff == 0) {
+                if (enqueuePos.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                position = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+        cell->data = std::forward<U>(item);
+        cell->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Returns false without blocking if the buffer is empty.
+    bool tryPop(T& out) {
+        std::size_t position = dequeuePos.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true) {
+            cell = &cells[position & mask];
+            std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position + 1);
+            if (diff == 0) {
+                if (dequeuePos.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                position = dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+        out = std::move(cell->data);
+        cell->sequence.store(position + mask + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Approximate; exact only when no push/pop is in flight.
+    std::size_t size() const {
+        std::size_t enq = enqueuePos.load(std::memory_order_acquire);
+        std::size_t deq = dequeuePos.load(std::memory_order_acquire);
+        return enq >= deq ? enq - deq : 0;
+    }
+
+    std::size_t getCapacity() const { return capacity; }
+
+private:
+    struct Cell {
+        std::atomic<std::size_t> sequence;
+        T data;
+    };
+
+    static std::size_t roundUpToPowerOfTwo(std::size_t value) {
+        std::size_t result = 2;
+        while (result < value) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    const std::size_t capacity;
+    const std::size_t mask;
+    std::unique_ptr<Cell[]> cells;
+
+    // Producer and consumer cursors on separate cache lines
+    alignas(64) std::atomic<std::size_t> enqueuePos{0};
+    alignas(64) std::atomic<std::size_t> dequeuePos{0};
+};
+
+#endif // RINGBUFFER_HPP
@@ -0,0 +1,94 @@
+#ifndef RULEENGINE_HPP
+#define RULEENGINE_HPP
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "pathclassifier.hpp"
+
+// Facts about one file that a rule can test. Controllers fill only the inputs
+// a program reports through needs(); archived is resolved on first use.
+struct FileFacts {
+    double ageHours = 0;
+    std::uint64_t sizeBytes = 0;
+    std::string_view extension;
+    FileCategory category = FileCategory::Unknown;
+    // Retention period of the matched policy (the `retention` field)
+    double retentionHours = 0;
+    std::function<bool()> archived;
+};
+
+// Inputs a program reads, so callers can skip stat calls and DB lookups.
+enum RuleInput : std::uint8_t {
+    RULE_INPUT_AGE = 1 << 0,
+    RULE_INPUT_SIZE = 1 << 1,
+    RULE_INPUT_RETENTION = 1 << 2,
+    RULE_INPUT_ARCHIVED = 1 << 3
+};
+
+// A retention/archival predicate compiled to flat bytecode. The language:
+//
+//   expr       := term { OR term }
+//   term       := factor { AND factor }
+//   factor     := NOT factor | '(' expr ')' | TRUE | FALSE | archived | test
+//   test       := number-field op (number | number-field)
+//               | ext|category (== | !=) name
+//               | ext|category IN '[' name { ',' name } ']'
+//
+// Number fields are age and retention (hours; suffixes m, h, d, w) and size
+// (bytes; suffixes B, KB, MB, GB, TB). Keywords are case-insensitive. For
+// example: "age > 96h AND ext in [mp4] AND archived".
+//
+// Every instruction writes a single boolean accumulator; AND/OR compile to
+// conditional jumps, so evaluation short-circuits and needs no stack.
+class RuleProgram {
+public:
+    // Throws std::invalid_argument naming the offending position.
+    static RuleProgram compile(std::string_view expression);
+
+    bool evaluate(const FileFacts& facts) const;
+
+    bool needs(RuleInput input) const { return (inputs & input) != 0; }
+    const std::string& source() const { return text; }
+
+private:
+    enum class Op : std::uint8_t { Const, Compare, ExtensionIn, CategoryIn, Archived, Not, JumpIfFalse, JumpIfTrue };
+    enum class Operand : std::uint8_t { Constant, Age, Size, Retention };
+    enum class Comparison : std::uint8_t { Less, LessEqual, Greater, GreaterEqual, Equal, NotEqual };
+
+    struct Instruction {
+        Op op;
+        Comparison comparison = Comparison::Equal;
+        Operand lhs = Operand::Constant;
+        Operand rhs = Operand::Constant;
+        // Jump target, extension set index or category bit mask
+        std::uint32_t argument = 0;
+        double constant = 0;
+    };
+
+    class Parser;
+
+    std::vector<Instruction> code;
+    std::vector<ExtensionTable> extensionSets;
+    std::uint8_t inputs = 0;
+    std::string text;
+};
+
+// Compiles one program per category from an object keyed by category
+// directory (e.g. {"Videos": "age > retention AND archived"}). Categories
+// without an entry, or whose entry does not compile, use defaults; compile
+// errors are appended to errors.
+std::array<RuleProgram, FILE_CATEGORY_COUNT> compileCategoryRules(
+    const nlohmann::json& expressions,
+    const std::array<std::string, FILE_CATEGORY_COUNT>& defaults,
+    std::vector<std::string>& errors);
+
+// The config.json "rules" object (sections "retention", "archival" and
+// "archival_deletion"); an empty object if unset.
+nlohmann::json loadRuleExpressions();
+
+#endif // RULEENGINE_HPP
@@ -0,0 +1,91 @@
+#ifndef SCHEDULERSTATE_HPP
+#define SCHEDULERSTATE_HPP
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+// Where an interrupted scan stopped: the root being walked, the last
+// directory under it the scan got to ("" if none yet) and, if that directory
+// was cut short by a work budget, the last file processed in it.
+struct ScanCursor {
+    std::string root;
+    std::string directory;
+    // Empty once every file of directory was processed
+    std::string file;
+
+    bool empty() const { return root.empty(); }
+};
+
+// Files of one scan root grouped by parent directory. Directories come in
+// lexicographic order, files sorted within each, so a ScanCursor names a
+// position that survives a restart.
+struct DirectoryBatch {
+    std::string directory;
+    std::vector<std::string> files;
+};
+
+std::vector<DirectoryBatch> groupByDirectory(const std::vector<std::string>& files);
+
+// Index of the root to start a scan at: the cursor's root if it is still
+// configured, otherwise 0 (the roots changed, so the pass starts over).
+std::size_t resumeIndex(const std::vector<std::string>& roots, const ScanCursor& cursor);
+
+// Index of the first file of `batch` (under `root`) still to process for a
+// scan resuming at `cursor`; batch.files.size() if the batch was finished.
+std::size_t resumeOffset(const std::string& root, const DirectoryBatch& batch, const ScanCursor& cursor);
+
+// Small JSON file (scheduler.state_file) holding, per job, when it last ran
+// and where its scan stopped, so a restart resumes the schedule and the scan
+// instead of waiting a full interval and walking every root again. Saves
+// write a temporary file, fsync it and rename it over the old one; a missing
+// or unreadable file starts with no state.
+class SchedulerState {
+public:
+    static SchedulerState& getInstance();
+
+    // An empty path keeps the state in memory only.
+    explicit SchedulerState(std::string path);
+
+    SchedulerState(const SchedulerState&) = delete;
+    SchedulerState& operator=(const SchedulerState&) = delete;
+
+    std::optional<std::chrono::system_clock::time_point> lastRun(const std::string& job) const;
+    void setLastRun(const std::string& job, std::chrono::system_clock::time_point when);
+
+    // Empty if the job's last scan completed.
+    ScanCursor cursor(const std::string& job) const;
+    // An empty cursor marks the pass complete.
+    void setCursor(const std::string& job, const ScanCursor& cursor);
+
+    // Writes the state if it changed since the last save. Returns false if it could not be written.
+    bool save();
+    // save() at most once per checkpoint interval; for the per-directory cursor updates.
+    bool checkpoint();
+
+    const std::string& getPath() const { return path; }
+
+private:
+    struct JobState {
+        std::optional<std::chrono::system_clock::time_point> lastRun;
+        ScanCursor cursor;
+    };
+
+    void load();
+    bool write(const std::string& contents);
+
+    const std::string path;
+    mutable std::mutex mutex;
+    std::map<std::string, JobState> jobs;
+    bool dirty = false;
+    bool lastSaveFailed = false;
+    std::chrono::steady_clock::time_point lastSave;
+
+    // Serializes writers so an older snapshot never replaces a newer one
+    std::mutex saveMutex;
+};
+
+#endif // SCHEDULERSTATE_HPP
@@ -0,0 +1,41 @@
+#ifndef SCHEMAMIGRATOR_HPP
+#define SCHEMAMIGRATOR_HPP
+
+#include <string>
+#include <vector>
+#include <pqxx/pqxx>
+#include "loggingservice.hpp"
+
+// One versioned schema change. Index builds (indexName set) run with
+// CREATE INDEX CONCURRENTLY outside a transaction so the recorder's inserts
+// into analytics/incident are never blocked; everything else runs in a
+// transaction together with its version row.
+struct SchemaMigration {
+    int version;
+    std::string description;
+    std::string sql;
+    std::string indexName;
+};
+
+// Applies pending migrations at startup and records them in efms_schema_version.
+// Only one instance migrates at a time; the others skip instead of waiting.
+class SchemaMigrator {
+public:
+    explicit SchemaMigrator(LoggingService* logger);
+
+    static const std::vector<SchemaMigration>& migrations();
+    static int latestVersion();
+
+    // Brings the schema up to latestVersion(). Returns false if any migration failed,
+    // the database was unreachable or another instance holds the migration lock.
+    bool migrate();
+
+private:
+    int currentVersion(pqxx::connection& connection);
+    void applyMigration(pqxx::connection& connection, const SchemaMigration& migration);
+    void dropInvalidIndex(pqxx::connection& connection, const std::string& indexName);
+
+    LoggingService* logger;
+};
+
+#endif // SCHEMAMIGRATOR_HPP
@@ -0,0 +1,108 @@
+#ifndef TASKEXECUTOR_HPP
+#define TASKEXECUTOR_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Lanes, highest first. A worker takes any Emergency task (its own or
+// stolen) before any Normal task, and Normal before Background.
+enum class TaskPriority {
+    // Eviction while a volume is over its threshold
+    Emergency,
+    // Regular retention work
+    Normal,
+    // Archival copies that can wait
+    Background
+};
+
+constexpr std::size_t TASK_PRIORITY_COUNT = 3;
+
+// Process-wide work-stealing pool shared by every pipeline stage, so adding
+// parallel work never adds threads. Each worker owns one deque per lane; it
+// pops its own newest task (cache-warm) and steals the oldest task of other
+// workers when idle. Sized by executor.workers (0: hardware threads, at most 4).
+class TaskExecutor {
+public:
+    using Task = std::function<void()>;
+
+    static TaskExecutor& getInstance();
+
+    explicit TaskExecutor(std::size_t workers);
+    // Runs the tasks already submitted, then joins the workers.
+    ~TaskExecutor();
+
+    TaskExecutor(const TaskExecutor&) = delete;
+    TaskExecutor& operator=(const TaskExecutor&) = delete;
+
+    // From a worker the task goes to that worker's deque, otherwise to the
+    // next worker in turn. Tasks must not throw; use TaskGroup for that.
+    void submit(TaskPriority priority, Task task);
+
+    std::size_t workerCount() const { return workers.size(); }
+    // True on one of this executor's worker threads.
+    bool onWorkerThread() const;
+
+    // Runs one queued task on the calling thread; false if none was queued.
+    bool runPendingTask();
+
+private:
+    struct Worker {
+        std::mutex mutex;
+        std::deque<Task> lanes[TASK_PRIORITY_COUNT];
+        std::thread thread;
+    };
+
+    void work(std::size_t index);
+    bool takeTask(std::size_t self, Task& task, TaskPriority& priority);
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::atomic<std::size_t> nextWorker{0};
+    std::atomic<std::size_t> pending{0};
+
+    std::mutex sleepMutex;
+    std::condition_variable wakeup;
+    bool stopping = false;
+};
+
+// Fork/join over a TaskExecutor: run() submits, wait() blocks until every
+// task has finished and rethrows the first exception one of them threw.
+// Waiting on a worker thread runs queued tasks instead of blocking it.
+class TaskGroup {
+public:
+    explicit TaskGroup(TaskPriority priority, TaskExecutor& executor = TaskExecutor::getInstance());
+    // Waits for outstanding tasks; exceptions are dropped.
+    ~TaskGroup();
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    // Caps the group's unfinished tasks; run() waits for a slot once it is
+    // reached. 0 (the default) submits without waiting.
+    void setMaxInFlight(std::size_t limit) { maxInFlight = limit; }
+
+    void run(TaskExecutor::Task task);
+    void wait();
+
+private:
+    // Waits until at most `limit` tasks are unfinished.
+    void waitForOutstanding(std::size_t limit);
+
+    TaskExecutor& executor;
+    const TaskPriority priority;
+
+    std::mutex mutex;
+    std::condition_variable done;
+    std::size_t outstanding = 0;
+    std::size_t maxInFlight = 0;
+    std::exception_ptr failure;
+};
+
+#endif // TASKEXECUTOR_HPP
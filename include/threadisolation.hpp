@@ -0,0 +1,91 @@
+#ifndef THREADISOLATION_HPP
+#define THREADISOLATION_HPP
+
+#include <array>
+#include <atomic>
+#include <optional>
+#include <string>
+#include <vector>
+#include <sched.h>
+#include <nlohmann/json.hpp>
+#include "taskexecutor.hpp"
+
+// I/O scheduling class for ioprio_set(2).
+enum class IoPriorityClass {
+    // Follow the CPU nice value (kernel default)
+    None,
+    BestEffort,
+    // Only gets the disk when nobody else wants it
+    Idle
+};
+
+// What a thread doing one class of work runs under.
+struct ThreadPolicy {
+    IoPriorityClass ioClass = IoPriorityClass::None;
+    // Best-effort level, 0 (highest) to 7
+    int ioLevel = 4;
+    int nice = 0;
+    // SCHED_IDLE: runs only on otherwise idle CPUs
+    bool schedIdle = false;
+    // CPUs the thread may run on; empty for those the process started with
+    std::vector<int> cpus;
+};
+
+// Keeps EFMS file work from competing with the video recorder for disk and
+// CPU. Each TaskPriority lane has its own ThreadPolicy (the "isolation"
+// section of config.json): pool workers switch to the lane's policy before
+// running a task, and pipeline coordinators to their pipeline's lane before
+// walking directories. Settings are per thread, so the scheduler thread and
+// the logging/DB threads keep the process defaults. Off unless
+// isolation.enabled; changes need a restart.
+//
+// A worker moving back to a higher lane must lower its nice value again,
+// which an unprivileged process may not be allowed to do. If it is not, the
+// lanes keep their I/O class and CPUs but lose their nice value and
+// SCHED_IDLE, rather than stranding workers at the lowest priority they visited.
+class ThreadIsolation {
+public:
+    using Policies = std::array<ThreadPolicy, TASK_PRIORITY_COUNT>;
+
+    static ThreadIsolation& getInstance();
+
+    ThreadIsolation(bool enabled, const Policies& policies);
+
+    ThreadIsolation(const ThreadIsolation&) = delete;
+    ThreadIsolation& operator=(const ThreadIsolation&) = delete;
+
+    bool isEnabled() const { return enabled; }
+    const ThreadPolicy& policy(TaskPriority priority) const;
+
+    // Puts the calling thread under the lane's policy; a no-op if isolation is
+    // off or the thread is already there. A failed setting is reported once per
+    // lane and the thread counts as in no lane, so the next apply() tries again.
+    void apply(TaskPriority priority);
+
+    // Lane the calling thread was last fully put in by apply().
+    static std::optional<TaskPriority> current();
+
+    // Parses one lane's settings. Returns the problem, or empty if valid.
+    static std::string parsePolicy(const nlohmann::json& settings, ThreadPolicy& policy);
+    // Lane defaults: emergency best-effort 0, normal best-effort 4 at nice 5, background idle at nice 19 with SCHED_IDLE.
+    static Policies defaultPolicies();
+
+    // Lowest nice value the process may set: -20 with CAP_SYS_NICE, otherwise 20 - RLIMIT_NICE.
+    static int niceFloor();
+    // The policies unchanged if threads starting at startNice can move between
+    // every lane without going below floor; otherwise with nice and SCHED_IDLE
+    // dropped from every lane.
+    static Policies restorable(const Policies& policies, int floor, int startNice);
+
+private:
+    // Returns what failed, or empty.
+    std::string applyPolicy(const ThreadPolicy& policy) const;
+
+    const bool enabled;
+    const Policies policies;
+    // Affinity of the process when isolation was set up; restored for lanes without cpus
+    cpu_set_t initialCpus;
+    std::array<std::atomic<bool>, TASK_PRIORITY_COUNT> reported{};
+};
+
+#endif // THREADISOLATION_HPP
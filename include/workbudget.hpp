@@ -0,0 +1,43 @@
+#ifndef WORKBUDGET_HPP
+#define WORKBUDGET_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// Cap on how much one run of a normal scan does in incremental mode. Once a
+// limit is reached the scan admits no further files, records its cursor and
+// yields; the next tick continues from the cursor, so a full pass spreads
+// over several short runs. Files already admitted still finish, so bytes
+// and time may overshoot by the files in flight. A zero limit is unbounded.
+class WorkBudget {
+public:
+    struct Limits {
+        std::uint64_t files = 0;
+        std::uint64_t bytes = 0;
+        std::chrono::milliseconds duration{0};
+    };
+
+    // Limits from the "incremental" config section; unbounded unless it is enabled.
+    static Limits configured();
+
+    // The clock for the duration limit starts here.
+    explicit WorkBudget(const Limits& limits);
+
+    // Counts one more file unless a limit was reached; safe to call concurrently.
+    bool admit();
+    // Bytes copied or deleted by an admitted file.
+    void charge(std::uint64_t bytes);
+    bool exhausted() const;
+
+    std::uint64_t filesAdmitted() const { return files.load(); }
+    std::uint64_t bytesCharged() const { return bytes.load(); }
+
+private:
+    const Limits limits;
+    const std::chrono::steady_clock::time_point started;
+    std::atomic<std::uint64_t> files{0};
+    std::atomic<std::uint64_t> bytes{0};
+};
+
+#endif // WORKBUDGET_HPP
@@ -0,0 +1,54 @@
+#include "adaptiveinterval.hpp"
+#include <algorithm>
+
+namespace {
+    // Rate increase that counts as a growing backlog; smaller changes are noise
+    constexpr double GROWTH_FACTOR = 1.25;
+}
+
+AdaptiveInterval::AdaptiveInterval(Duration base, Duration minimum, Duration maximum) : interval(base) {
+    setBounds(base, minimum, maximum);
+}
+
+void AdaptiveInterval::setBounds(Duration newBase, Duration newMinimum, Duration newMaximum) {
+    minimum = std::max(newMinimum, Duration(1));
+    maximum = std::max(newMaximum, minimum);
+    base = std::clamp(newBase, minimum, maximum);
+    interval = clamp(interval);
+}
+
+AdaptiveInterval::Duration AdaptiveInterval::clamp(Duration value) const {
+    return std::clamp(value, minimum, maximum);
+}
+
+AdaptiveInterval::Duration AdaptiveInterval::update(const ArchivalBacklog& backlog) {
+    if (backlog.eviction || backlog.yielded) {
+        return interval;
+    }
+    if (backlog.ddsUnavailable) {
+        // Polling an unreachable DDS at the minimum interval only floods the incident log
+        interval = clamp(interval * 2);
+        return interval;
+    }
+    if (!backlog.complete || backlog.pendingFiles > 0) {
+        interval = minimum;
+        return interval;
+    }
+
+    // Arrivals are measured per minute so a shorter interval is not mistaken for a shrinking backlog
+    const double minutes = std::chrono::duration<double, std::ratio<60>>(interval).count();
+    const double rate = static_cast<double>(backlog.copiedFiles) / minutes;
+
+    if (backlog.copiedFiles == 0) {
+        interval = clamp(interval * 2);
+    } else if (interval > base) {
+        // Work showed up again after backing off
+        interval = base;
+    } else if (previousRate >= 0.0 && rate > previousRate * GROWTH_FACTOR) {
+        interval = clamp(interval / 2);
+    } else if (rate * GROWTH_FACTOR < previousRate) {
+        interval = std::min(base, clamp(interval * 2));
+    }
+    previousRate = rate;
+    return interval;
+}
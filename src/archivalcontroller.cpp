@@ -17,11 +17,28 @@
 #include <chrono>
 #include <ctime>
 #include "../include/db_instance.hpp"
+#include "../include/dbwriter.hpp"
+#include "../include/asynclogger.hpp"
+#include "../include/pipelinesummary.hpp"
+#include "../include/binarylog.hpp"
+#include "../include/loglevel.hpp"
+#include "../include/connectionpool.hpp"
+#include "../include/configservice.hpp"
+#include "../include/jobexecutor.hpp"
+#include "../include/taskexecutor.hpp"
+#include "../include/chunkedcopy.hpp"
+#include "../include/schedulerstate.hpp"
+#include "../include/workbudget.hpp"
+#include "../include/iopressure.hpp"
+#include "../include/threadisolation.hpp"
+#include "../include/diskpressure.hpp"
 #include <sys/prctl.h>
 #include <unistd.h>
 #include <cstring>
 #include <filesystem>
 #include <map>
+#include <atomic>
+#include <algorithm>
 
 FileService fileService;
 
@@ -42,14 +59,13 @@ namespace ArchivalConfig {
     void loadConfig() {
         if (config_loaded) return;
         
-        std::ifstream configFile("config.json");
-        if (!configFile.is_open()) {
+        auto snapshot = ConfigService::getInstance().current();
+        if (!snapshot->isLoaded()) {
             return;
         }
         
         try {
-            nlohmann::json config;
-            configFile >> config;
+            nlohmann::json config = snapshot->json();
             
             auto archival = config["archival"];
             bandwidth_limit_kb = archival["bandwidth_limit_kb"].get<int>();
@@ -64,20 +80,21 @@ namespace ArchivalConfig {
         } catch (const nlohmann::json::exception& e) {
             // Silent catch
         }
-        
-        configFile.close();
     }
 }
 
 ArchivalController::ArchivalController(const nlohmann::json& archivalPolicy,
                                        const std::string& source,
-                                       const std::string& logFilePath)
-    : archivalPolicy(archivalPolicy), source(source), logFilePath(logFilePath) {
+                                       const std::string& logFilePath,
+                                       const ArchivalScope& scope)
+    : archivalPolicy(archivalPolicy), scope(scope), source(source), logFilePath(logFilePath) {
     try {
         // Load configuration at initialization
         ArchivalConfig::loadConfig();
+        bandwidthLimitKb = ArchivalConfig::bandwidth_limit_kb;
         
         logger = LoggingService::getInstance(source, logFilePath);
+        asyncLogger = &AsyncLogger::getInstance(logger);
         logger->info("ArchivalController initialization started",
                      createLogInfo({{"detail", "Initialization started successfully"}}),
                      "ARCH_INIT_START", false);
@@ -102,6 +119,11 @@ ArchivalController::ArchivalController(const nlohmann::json& archivalPolicy,
         }
 
         this->archivalPolicy = archivalPolicy;
+        configVersion = ConfigService::getInstance().current()->version();
+        nlohmann::json rules = loadRuleExpressions();
+        ruleExpressions = rules.dump();
+        policy = CompiledPolicy::fromArchivalPolicy(archivalPolicy, ArchivalConfig::eligibility, rules);
+        reportRuleErrors();
     } catch (const std::exception& e) {
         nlohmann::json errInfo = createLogInfo({{"detail", e.what()}});
         logger->critical("Initialization failed", errInfo, "ARCH_INIT_FAIL", true, "05002");
@@ -111,105 +133,363 @@ ArchivalController::ArchivalController(const nlohmann::json& archivalPolicy,
 }
 
 void ArchivalController::logIncidentToDB(const std::string& message, const nlohmann::json& details, const std::string& error_code) {
-    try {
-        // Check if the most recent incident with this message is still active (no recovery attempts or failed recovery)
-        std::ostringstream checkQuery;
-        checkQuery << "SELECT i.id FROM incident i "
-                  << "LEFT JOIN recovery r ON i.id = r.incident_id "
-                  << "WHERE i.incident_message = '" << message << "' "
-                  << "AND i.process_name = 'EFMS' "
-                  << "AND (r.id IS NULL OR r.recovery_status = 'FAILED') "
-                  << "ORDER BY i.incident_time DESC LIMIT 1";
-        
-        auto result = db.executeSelect(checkQuery.str());
-        
-        // If no active incident exists, insert a new one
-        if (result.empty()) {
-            // Ensure error_code is included in the details JSON
-            nlohmann::json detailsWithCode = details;
-            detailsWithCode["error_code"] = error_code;
-            
-            std::ostringstream insertQuery;
-            insertQuery << "INSERT INTO incident (process_name, incident_message, incident_time, incident_details) "
-                       << "VALUES ('EFMS', '" << message << "', NOW(), '" << detailsWithCode.dump() << "') "
-                       << "RETURNING id";
-            
-            int lastInsertId = db.executeInsert(insertQuery.str());
-            std::cout << "Inserted incident with ID: " << lastInsertId << " for error code: " << error_code << std::endl;
-        } else {
-            std::cout << "Skipped duplicate incident: " << message << " (already active or no successful recovery)" << std::endl;
-        }
-    } catch (const std::exception& e) {
-        std::cerr << "Database Operation Failed: " << e.what() << std::endl;
-        logger->error("Database Operation Failed", {{"error", e.what()}}, "DB_OPERATION_FAIL", true, "05003");
-    }
+    // Handed to the background DB writer so the file loop never waits on Postgres.
+    DbWriter::getInstance().enqueueIncident(message, details, error_code, "DB_OPERATION_FAIL", "05003", logger);
 }
 
-void ArchivalController::applyArchivalPolicy() {
+ArchivalBacklog ArchivalController::applyArchivalPolicy(const CancellationToken& token) {
+    refreshTunables();
     if (checkArchivalPolicy()) {
         logger->info("Starting max utilization pipeline",
-                     createLogInfo({{"detail", "Storage threshold exceeded"}}),
+                     createLogInfo({{"detail", "Storage threshold exceeded"}, {"scope", scope.name}}),
                      "PIPELINE_MAX_START", false);
-        startMaxUtilizationPipeline();
+        return startMaxUtilizationPipeline(token);
     } else {
         logger->info("Starting Normal utilization pipeline",
-                     createLogInfo({{"detail", "Normal pipeline processing initiated"}}),
+                     createLogInfo({{"detail", "Normal pipeline processing initiated"}, {"scope", scope.name}}),
                      "PIPELINE_NORMAL_START", false);
-        startNormalPipeline();
+        return startNormalPipeline(token);
     }
 }
 
-void ArchivalController::startMaxUtilizationPipeline() {
+// Logs why a pipeline stops early; checked at directory boundaries.
+bool ArchivalController::pipelineCancelled(const CancellationToken& token, const char* pipeline) {
+    if (!token.isCancelled()) {
+        return false;
+    }
+    asyncLogger->info(LogRecord("Pipeline cancelled", "PIPELINE_CANCELLED")
+                          .add("pipeline", pipeline)
+                          .add("reason", token.reason()));
+    return true;
+}
+
+ArchivalBacklog ArchivalController::startMaxUtilizationPipeline(const CancellationToken& token) {
+    ArchivalBacklog backlog;
+    backlog.eviction = true;
+    // The directory walks run on this thread; give it the lane of the work it feeds
+    ThreadIsolation::getInstance().apply(TaskPriority::Emergency);
+    PipelineSummary summary(*asyncLogger, "archival_max_utilization");
     auto filePaths = getAllFilePaths();
     for (const auto& filePath : filePaths) {
+        if (pipelineCancelled(token, "archival_max_utilization")) {
+            backlog.complete = false;
+            return backlog;
+        }
+        refreshTunables();
+        summary.beginDirectory(filePath);
         auto [files, directories] = fileService.read_directory_recursively(filePath);
-        for (const auto& file : files) {
-            if (checkArchivalPolicy()) {
-                fileService.delete_file(file);
-            } else {
+        // Delete one batch per worker between utilization checks, so eviction runs in
+        // parallel but overshoots the threshold by at most one batch
+        std::size_t batchSize = TaskExecutor::getInstance().workerCount();
+        if (scope.concurrency > 0) {
+            batchSize = std::min(batchSize, scope.concurrency);
+        }
+        for (std::size_t begin = 0; begin < files.size() && !token.isCancelled(); begin += batchSize) {
+            if (!checkArchivalPolicy()) {
+                ++summary.counters().filesSeen;
                 break;
             }
+            TaskGroup group(TaskPriority::Emergency);
+            for (std::size_t i = begin; i < std::min(begin + batchSize, files.size()); ++i) {
+                group.run([this, &summary, &file = files[i]] {
+                    PipelineCounters counters;
+                    ++counters.filesSeen;
+                    ++counters.eligible;
+                    deleteFile(file, counters);
+                    summary.merge(counters);
+                });
+            }
+            group.wait();
         }
         stopPipeline(directories);
     }
+    return backlog;
 }
 
-void ArchivalController::startNormalPipeline() {
+ArchivalBacklog ArchivalController::startNormalPipeline(const CancellationToken& token) {
+    ThreadIsolation::getInstance().apply(scope.priority);
+    PipelineSummary summary(*asyncLogger, "archival_normal");
     auto filePaths = getAllFilePaths();
 
-    for (const auto& filePath : filePaths) {
-        std::cout << "[DEBUG] Checking path: " << filePath << std::endl;
+    // Measured from the cycle totals once the run ends, however it ends
+    auto backlogOf = [&summary](bool complete, bool ddsUnavailable = false) {
+        summary.finish();
+        ArchivalBacklog backlog;
+        backlog.complete = complete;
+        backlog.ddsUnavailable = ddsUnavailable;
+        backlog.copiedFiles = summary.totals().archived;
+        backlog.pendingFiles = summary.totals().pending;
+        backlog.pendingBytes = summary.totals().pendingBytes;
+        return backlog;
+    };
+
+    // A pass cut short by cancellation or a restart picks up after the last directory it finished
+    SchedulerState& state = SchedulerState::getInstance();
+    ScanCursor cursor = state.cursor(scope.name);
+    const std::size_t first = resumeIndex(filePaths, cursor);
+    if (first >= filePaths.size() || filePaths[first] != cursor.root) {
+        cursor = ScanCursor();
+    } else if (!cursor.empty()) {
+        asyncLogger->info(LogRecord("Resuming scan", "PIPELINE_RESUME")
+                              .add("pipeline", "archival_normal")
+                              .add("root", cursor.root)
+                              .add("directory", cursor.directory)
+                              .add("file", cursor.file));
+    }
+    auto stopped = [&](bool ddsUnavailable = false) {
+        state.save();
+        return backlogOf(false, ddsUnavailable);
+    };
+
+    // In incremental mode the run yields once its budget is spent; the next tick continues at the cursor
+    WorkBudget budget(WorkBudget::configured());
+    auto yielded = [&] {
+        state.save();
+        asyncLogger->info(LogRecord("Work budget spent, yielding", "PIPELINE_YIELD")
+                              .add("pipeline", "archival_normal")
+                              .add("files", budget.filesAdmitted())
+                              .add("bytes", budget.bytesCharged()));
+        ArchivalBacklog backlog = backlogOf(true);
+        backlog.yielded = true;
+        return backlog;
+    };
+    // Backs off while the node is under I/O or memory pressure
+    PressureThrottle& pressure = PressureThrottle::getInstance();
+
+    for (std::size_t index = first; index < filePaths.size(); ++index) {
+        const auto& filePath = filePaths[index];
+        // Returns early if the run is cancelled while paused
+        pressure.pace(token);
+        if (pipelineCancelled(token, "archival_normal")) {
+            return stopped();
+        }
+        if (budget.exhausted()) {
+            return yielded();
+        }
+        EFMS_DEBUG("Checking path: " << filePath);
 
         if (!std::filesystem::exists(filePath)) {
-            std::cerr << "[WARNING] Path does not exist: " << filePath << std::endl;
+            EFMS_WARNING("Path does not exist: " << filePath);
+        } else {
+            refreshTunables();
+            summary.beginDirectory(filePath);
+            auto [files, directories] = fileService.read_directory_recursively(filePath);
+            const auto batches = groupByDirectory(files);
+            // Listed files the run stops before reaching are part of the backlog it leaves
+            auto leaveUnvisited = [&](std::size_t batchIndex, std::size_t from) {
+                PipelineCounters counters;
+                for (std::size_t b = batchIndex; b < batches.size(); ++b) {
+                    for (std::size_t f = b == batchIndex ? from : 0; f < batches[b].files.size(); ++f) {
+                        countPending(batches[b].files[f], counters);
+                    }
+                }
+                summary.merge(counters);
+            };
+
+            for (std::size_t batchIndex = 0; batchIndex < batches.size(); ++batchIndex) {
+                const auto& batch = batches[batchIndex];
+                const std::size_t start = resumeOffset(filePath, batch, cursor);
+                if (start == batch.files.size()) {
+                    continue;
+                }
+                // Files are independent; the scope bounds how many this instance has in
+                // flight and copies are further bounded by the IoBudget shared by all jobs
+                std::atomic<bool> ddsUnavailable{false};
+                TaskGroup group(scope.priority);
+                group.setMaxInFlight(scope.concurrency);
+                std::size_t next = start;
+                for (; next < batch.files.size() && pressure.pace(token) && budget.admit(); ++next) {
+                    group.run([this, &summary, &ddsUnavailable, &budget, &file = batch.files[next], &token] {
+                        PipelineCounters counters;
+                        if (ddsUnavailable || token.isCancelled()) {
+                            countPending(file, counters);
+                            summary.merge(counters);
+                            return;
+                        }
+                        ++counters.filesSeen;
+                        ArchiveOutcome outcome = archiveFile(file, counters, token);
+                        if (outcome == ArchiveOutcome::DdsUnavailable) {
+                            ++counters.errors;
+                            ddsUnavailable = true;
+                        } else if (outcome == ArchiveOutcome::Done && !token.isCancelled() &&
+                                   isFileEligibleForDeletion(file)) {
+                            // Never delete an original whose copy did not make it to DDS
+                            deleteFile(file, counters);
+                        }
+                        // Only the copy moves data; deleting the archived original is cheap
+                        budget.charge(counters.bytesCopied);
+                        summary.merge(counters);
+                    });
+                }
+                group.wait();
+                if (ddsUnavailable || pipelineCancelled(token, "archival_normal")) {
+                    leaveUnvisited(batchIndex, next);
+                    return stopped(ddsUnavailable);
+                }
+                if (next < batch.files.size()) {
+                    leaveUnvisited(batchIndex, next);
+                    // Every admitted file is done; resume after the last of them
+                    if (next > start) {
+                        state.setCursor(scope.name, ScanCursor{filePath, batch.directory, batch.files[next - 1]});
+                    }
+                    return yielded();
+                }
+                state.setCursor(scope.name, ScanCursor{filePath, batch.directory, ""});
+                state.checkpoint();
+            }
+
+            stopPipeline(directories);
+        }
+        state.setCursor(scope.name, index + 1 < filePaths.size() ? ScanCursor{filePaths[index + 1], ""} : ScanCursor());
+        state.checkpoint();
+    }
+    state.save();
+    return backlogOf(true);
+}
+
+void ArchivalController::archiveFiles(const std::vector<std::string>& filePaths, const CancellationToken& token) {
+    ThreadIsolation::getInstance().apply(TaskPriority::Normal);
+    PipelineSummary summary(*asyncLogger, "archival_notify");
+
+    std::atomic<bool> ddsUnavailable{false};
+    TaskGroup group(TaskPriority::Normal);
+    PressureThrottle& pressure = PressureThrottle::getInstance();
+    for (const auto& file : filePaths) {
+        // Only files on the mounted volume that still exist; anything else is left to the periodic scan.
+        // Another scope's files are left to its own instance, which may be copying them right now.
+        if (!scope.includes(classifyFile(file)) || !isUnderPath(file, policy.mountedPath) ||
+            !fileService.file_exists(file)) {
             continue;
         }
+        if (!pressure.pace(token)) {
+            break;
+        }
+        group.run([this, &summary, &ddsUnavailable, &file, &token] {
+            if (ddsUnavailable || token.isCancelled()) return;
+            PipelineCounters counters;
+            ++counters.filesSeen;
+            if (archiveFile(file, counters, token) == ArchiveOutcome::DdsUnavailable) {
+                ++counters.errors;
+                ddsUnavailable = true;
+            }
+            summary.merge(counters);
+        });
+    }
+    group.wait();
+}
 
-        auto [files, directories] = fileService.read_directory_recursively(filePath);
+// Copies a single file to DDS if it is eligible and not archived yet.
+ArchiveOutcome ArchivalController::archiveFile(const std::string& file, PipelineCounters& counters,
+                                               const CancellationToken& token) {
+    if (!isFileEligibleForArchival(file)) {
+        return ArchiveOutcome::Done;
+    }
+    ++counters.eligible;
 
-        for (const auto& file : files) {
-            if (isFileEligibleForArchival(file)) {
-                if (!fileService.is_mounted_drive_accessible(archivalPolicy.at("DDS_PATH"))) {
-                    nlohmann::json errInfo = createLogInfo({{"detail", "DDS path not accessible"}});
-                    logger->error("DDS path not accessible", errInfo, "DDS_PATH_ERR", true, "05004");
-                    logIncidentToDB("DDS path not accessible", errInfo, "05004");
-                    return;
-                }
+    if (!fileService.is_mounted_drive_accessible(policy.ddsPath)) {
+        nlohmann::json errInfo = createLogInfo({{"detail", "DDS path not accessible"}});
+        logger->error("DDS path not accessible", errInfo, "DDS_PATH_ERR", true, "05004");
+        logIncidentToDB("DDS path not accessible", errInfo, "05004");
+        return ArchiveOutcome::DdsUnavailable;
+    }
 
-                auto destinationPath = getDestinationPath(file);
-                if (!isFileArchivedToDDS(file)) {
-                    logger->info("Archiving file", createLogInfo({{"destination", destinationPath}}), "FILE_ARCHIVE", false);
-                    fileService.copy_files(file, destinationPath, ArchivalConfig::bandwidth_limit_kb);
-                    updateFileArchivalStatus(file, destinationPath);
-                }
-            }
+    auto destinationPath = getDestinationPath(file);
+    if (!isFileArchivedToDDS(file)) {
+        if (allowPerFileLog()) {
+            asyncLogger->info(LogRecord("Archiving file", "FILE_ARCHIVE").add("destination", destinationPath));
+        }
+        CopyResult copy;
+        {
+            IoBudget::Permit permit(IoBudget::getInstance());
+            // Archival copies never run for eviction, so they always yield to I/O pressure
+            copy = copyFileChunked(file, destinationPath, bandwidthLimitKb, token, DEFAULT_COPY_CHUNK,
+                                   &PressureThrottle::getInstance());
+        }
+        if (copy.status != CopyStatus::Copied) {
+            countPending(file, counters);
+        }
+        if (copy.status == CopyStatus::Cancelled) {
+            // Nothing was published under destinationPath; the next run copies the file again
+            return ArchiveOutcome::NotCopied;
+        }
+        if (copy.status == CopyStatus::Failed) {
+            nlohmann::json errInfo = createLogInfo({{"detail", copy.error}, {"file", file}});
+            logger->error("Failed to copy file to DDS", errInfo, "ARCHIVE_COPY_FAIL", true, "05029");
+            logIncidentToDB("Failed to copy file to DDS", errInfo, "05029");
+            ++counters.errors;
+            return ArchiveOutcome::NotCopied;
+        }
+        updateFileArchivalStatus(file, destinationPath);
+        ++counters.archived;
+        counters.bytesCopied += copy.bytes;
+        BinaryEventLog::getInstance().record(EventId::FileArchived, file, {static_cast<std::int64_t>(copy.bytes)});
+    }
+    return ArchiveOutcome::Done;
+}
 
-            if (isFileEligibleForDeletion(file)) {
-                fileService.delete_file(file);
-            }
+// Records a file the run leaves for the next one to copy.
+void ArchivalController::countPending(const std::string& file, PipelineCounters& counters) {
+    std::error_code ec;
+    auto size = std::filesystem::file_size(file, ec);
+    ++counters.pending;
+    counters.pendingBytes += ec ? 0 : size;
+}
+
+// Deletes a file and records it in the pipeline counters.
+void ArchivalController::deleteFile(const std::string& file, PipelineCounters& counters) {
+    std::error_code ec;
+    auto size = std::filesystem::file_size(file, ec);
+    {
+        IoBudget::Permit permit(IoBudget::getInstance());
+        fileService.delete_file(file);
+    }
+    ++counters.deleted;
+    if (!ec) {
+        counters.bytesDeleted += size;
+    }
+    BinaryEventLog::getInstance().record(EventId::FileDeleted, file, {ec ? 0 : static_cast<std::int64_t>(size)});
+}
+
+// Applies a newly published config snapshot between directories, so a copy in
+// progress finishes with the settings it started with.
+void ArchivalController::refreshTunables() {
+    auto snapshot = ConfigService::getInstance().current();
+    if (snapshot->version() == configVersion) {
+        return;
+    }
+    configVersion = snapshot->version();
+
+    try {
+        // Recompiled first: the threshold below overrides the one from the policy
+        const auto& rules = snapshot->section("rules");
+        nlohmann::json expressions = rules.is_object() ? rules : nlohmann::json::object();
+        if (expressions.dump() != ruleExpressions) {
+            ruleExpressions = expressions.dump();
+            policy = CompiledPolicy::fromArchivalPolicy(archivalPolicy, ArchivalConfig::eligibility, expressions);
+            reportRuleErrors();
+        }
+        bandwidthLimitKb = snapshot->section("archival").value("bandwidth_limit_kb", bandwidthLimitKb);
+        const auto& vecow = snapshot->section("vecow_retention_policy");
+        if (vecow.contains("threshold_storage_utilization")) {
+            policy.thresholdPercent = vecow["threshold_storage_utilization"].get<int>();
+            policy.hasThreshold = true;
         }
+    } catch (const nlohmann::json::exception& e) {
+        // Keep current values
+    }
+    logger->info("Configuration reloaded",
+                 createLogInfo({{"version", configVersion},
+                                {"scope", scope.name},
+                                {"bandwidth_limit_kb", bandwidthLimitKb},
+                                {"threshold_percent", policy.thresholdPercent}}),
+                 "CONFIG_RELOADED", false);
+}
 
-        stopPipeline(directories);
+void ArchivalController::reportRuleErrors() {
+    for (const auto& error : policy.ruleErrors) {
+        nlohmann::json errInfo = createLogInfo({{"detail", error}});
+        logger->error("Invalid archival rule, using default", errInfo, "RULE_COMPILE_ERR", true, "05028");
+        logIncidentToDB("Invalid archival rule, using default", errInfo, "05028");
     }
 }
 
@@ -217,6 +497,7 @@ void ArchivalController::stopPipeline(const std::vector<std::string>& directorie
     for (const auto& directory : directories) {
         if (fileService.is_directory_empty(directory)) {
             fileService.delete_directory(directory);
+            BinaryEventLog::getInstance().record(EventId::DirectoryDeleted, directory, {});
         }
     }
 }
@@ -224,14 +505,13 @@ void ArchivalController::stopPipeline(const std::vector<std::string>& directorie
 bool ArchivalController::checkArchivalPolicy() {
     try {
         auto memoryUtilization = diskSpaceUtilization();
-        if (!archivalPolicy.contains("THRESHOLD_STORAGE_UTILIZATION")) {
+        if (!policy.hasThreshold) {
             logger->critical("Missing Threshold Configuration",
                              createLogInfo({{"memory_utilization", memoryUtilization}}),
                              "THRESHOLD_EXCEEDED", false, "05005");
             return false;
         }
-        int threshold = std::stoi(archivalPolicy["THRESHOLD_STORAGE_UTILIZATION"].get<std::string>());
-        return memoryUtilization > threshold;
+        return memoryUtilization > policy.thresholdPercent;
     } catch (const std::exception& e) {
         logger->error("Failed to check archival policy", createLogInfo({{"detail", e.what()}}), "CHECK_POLICY_FAIL", true, "05006");
         logIncidentToDB("Failed to check archival policy", createLogInfo({{"detail", e.what()}}), "05006");
@@ -241,45 +521,26 @@ bool ArchivalController::checkArchivalPolicy() {
 
 std::vector<std::string> ArchivalController::getAllFilePaths() {
     std::vector<std::string> paths;
-    try {
-        std::cout << "[DEBUG] Starting to extract retention policy paths...\n";
+    paths.reserve(policy.scanRoots.size());
 
-        for (const auto& [key, value] : archivalPolicy.items()) {
-            std::cout << "[DEBUG] Inspecting key: " << key << "\n";
-            
-            // Only process string values with RETENTION_POLICY in key and that look like paths
-            if (value.is_string() && key.find("RETENTION_POLICY") != std::string::npos) {
-                const std::string& path = value.get<std::string>();
-                
-                // Check if it looks like a path
-                if (!path.empty() && (path[0] == '/' || path.find('/') != std::string::npos) && 
-                    !(path.length() < 10 && path[0] >= 'a' && path[0] <= 'z')) {
-                    std::cout << "[DEBUG] Found retention path for key " << key << ": " << path << "\n";
-                    paths.push_back(path);
-                } else {
-                    std::cout << "[DEBUG] Skipping key " << key << " (value doesn't look like a path)\n";
-                }
-            } else {
-                std::cout << "[DEBUG] Skipping key " << key << " (not a string or not a retention policy)\n";
-            }
+    // Retention policy paths, picked out of the policy when it was compiled
+    for (const auto& [key, path] : policy.scanRoots) {
+        if (!scope.includes(categoryForPolicyKey(key))) {
+            continue;
         }
-
-        std::cout << "[DEBUG] Total paths collected: " << paths.size() << "\n";
-    } catch (const std::exception& e) {
-        logger->critical("Failed to get file paths", createLogInfo({{"detail", e.what()}}), "GET_PATHS_FAIL", true, "05007");
-        std::cerr << "[ERROR] Exception while getting file paths: " << e.what() << "\n";
+        EFMS_DEBUG("Found retention path for key " << key << ": " << path);
+        paths.push_back(path);
     }
 
+    EFMS_DEBUG("Total paths collected: " << paths.size());
     return paths;
 }
 
 double ArchivalController::diskSpaceUtilization() {
     try {
-        std::string mountedPath = archivalPolicy["MOUNTED_PATH"].get<std::string>();
-        uint64_t total = 0, used = 0, free = 0;
-        std::tie(total, used, free) = fileService.get_memory_details(mountedPath);
-        if (total == 0) throw std::runtime_error("Invalid disk space information: total space is 0");
-        return (static_cast<double>(used) / static_cast<double>(total)) * 100.0;
+        double utilization = DiskPressureMonitor::utilization(fileService, policy.mountedPath);
+        if (utilization < 0) throw std::runtime_error("Invalid disk space information: total space is 0");
+        return utilization;
     } catch (const std::exception& e) {
         logger->critical("Failed to get disk space utilization", createLogInfo({{"detail", e.what()}}), "DISK_UTIL_FAIL", true, "05009");
         logIncidentToDB("Failed to get disk space utilization", createLogInfo({{"detail", e.what()}}), "05009");
@@ -292,71 +553,74 @@ double ArchivalController::checkFileArchivalPolicy(const std::string& filePath)
 }
 
 bool ArchivalController::isFileEligibleForDeletion(const std::string& filePath) {
-    double fileAge = checkFileArchivalPolicy(filePath);
-    try {
-        if (!archivalPolicy.contains("RETENTION_POLICIES")) return false;
-        const auto& policies = archivalPolicy["RETENTION_POLICIES"];
-
-        if (filePath.find("Videos") != std::string::npos && policies.contains("Videos")) {
-            return fileAge > policies["Videos"].get<double>();
-        } else if (filePath.find("Analysis") != std::string::npos && policies.contains("Analysis")) {
-            return fileAge > policies["Analysis"].get<double>();
-        } else if (filePath.find("Diagnostics") != std::string::npos && policies.contains("Diagnostics")) {
-            return fileAge > policies["Diagnostics"].get<double>();
-        } else if (filePath.find("Logs") != std::string::npos && policies.contains("Logs")) {
-            return fileAge > policies["Logs"].get<double>();
-        } else if (filePath.find("VideoClips") != std::string::npos && policies.contains("VideoClips")) {
-            return fileAge > policies["VideoClips"].get<double>();
-        }
-    } catch (...) {}
-    return false;
+    FileCategory category = classifyFile(filePath);
+    if (category == FileCategory::Unknown) {
+        return false;
+    }
+    return evaluateRule(policy.deletionRules[categoryIndex(category)], category, filePath,
+                        policy.deletionAgeHours[categoryIndex(category)]);
 }
 
 bool ArchivalController::isFileEligibleForArchival(const std::string& filePath) {
-    // Check if config was loaded
-    if (!ArchivalConfig::config_loaded || ArchivalConfig::eligibility.empty()) {
-        return true;  // Default to eligible if config fails
-    }
-    
-    // Use configured eligibility from config.json
-    if (filePath.find("Videos") != std::string::npos) {
-        return ArchivalConfig::eligibility["Videos"];
-    } else if (filePath.find("Analysis") != std::string::npos) {
-        return ArchivalConfig::eligibility["Analysis"];
-    } else if (filePath.find("Diagnostics") != std::string::npos) {
-        return ArchivalConfig::eligibility["Diagnostics"];
-    } else if (filePath.find("Logs") != std::string::npos) {
-        return ArchivalConfig::eligibility["Logs"];
-    } else if (filePath.find("VideoClips") != std::string::npos) {
-        return ArchivalConfig::eligibility["VideoClips"];
+    FileCategory category = classifyFile(filePath);
+    if (category == FileCategory::Unknown) {
+        // Default to eligible if the eligibility config could not be loaded
+        return !policy.eligibilityConfigured;
     }
+    return evaluateRule(policy.archivalRules[categoryIndex(category)], category, filePath,
+                        policy.deletionAgeHours[categoryIndex(category)]);
+}
 
-    return false;
+// Gathers only the facts the rule reads; the DB lookup for `archived` runs only if the rule reaches it.
+bool ArchivalController::evaluateRule(const RuleProgram& program, FileCategory category,
+                                      const std::string& filePath, double retentionHours) {
+    FileFacts facts;
+    facts.category = category;
+    facts.extension = fileExtension(filePath);
+    facts.retentionHours = retentionHours;
+    if (program.needs(RULE_INPUT_AGE)) {
+        facts.ageHours = checkFileArchivalPolicy(filePath);
+    }
+    if (program.needs(RULE_INPUT_SIZE)) {
+        std::error_code ec;
+        auto size = std::filesystem::file_size(filePath, ec);
+        facts.sizeBytes = ec ? 0 : size;
+    }
+    facts.archived = [this, &filePath] { return isFileArchivedToDDS(filePath); };
+    return program.evaluate(facts);
 }
 
 bool ArchivalController::isFileArchivedToDDS(const std::string& filePath) {
-    std::string query;
-    if (filePath.find("Videos") != std::string::npos) {
-        // Use COALESCE to handle NULL values
-        query = "SELECT COALESCE(dds_video_file_location, '') as dds_location FROM analytics WHERE video_file_location = '" + filePath + "'";
-    } else if (filePath.find("Analysis") != std::string::npos) {
-        // Use COALESCE to handle NULL values  
-        query = "SELECT COALESCE(dds_parquet_file_location, '') as dds_location FROM analytics WHERE parquet_file_location = '" + filePath + "'";
+    const char* locationColumn;
+    const char* ddsLocationColumn;
+    FileCategory category = classifyFile(filePath);
+    if (category == FileCategory::Video) {
+        locationColumn = "video_file_location";
+        ddsLocationColumn = "dds_video_file_location";
+    } else if (category == FileCategory::Analysis) {
+        locationColumn = "parquet_file_location";
+        ddsLocationColumn = "dds_parquet_file_location";
     } else {
-        std::string mountedPath = archivalPolicy.at("MOUNTED_PATH").get<std::string>();
-        std::string ddsPath = archivalPolicy.at("DDS_PATH").get<std::string>();
-        std::string ddsFilePath = filePath;
-
-        size_t pos = ddsFilePath.find(mountedPath);
-        if (pos != std::string::npos) {
-            ddsFilePath.replace(pos, mountedPath.length(), ddsPath);
+        std::string ddsFilePath;
+        if (!policy.toDdsPath(filePath, ddsFilePath)) {
+            ddsFilePath = filePath;
         }
-
         return fileService.file_exists(ddsFilePath);
     }
 
+    // Copied earlier while Postgres was down; the analytics update is waiting in the spool
+    if (DbWriter::getInstance().hasPendingArchivalStatus(filePath)) {
+        return true;
+    }
+
     try {
-        auto result = db.executeSelect(query);
+        // Pooled connection so concurrent pipelines do not serialize on one socket
+        auto lease = ConnectionPool::getInstance().acquire();
+        pqxx::nontransaction txn(*lease);
+
+        // Use COALESCE to handle NULL values
+        auto result = txn.exec(std::string("SELECT COALESCE(") + ddsLocationColumn + ", '') as dds_location FROM analytics WHERE " +
+                               locationColumn + " = " + txn.quote(filePath));
         
         // If no rows returned, file is not archived
         if (result.empty()) {
@@ -365,11 +629,9 @@ bool ArchivalController::isFileArchivedToDDS(const std::string& filePath) {
         
         // Check if the DDS location is not empty
         for (const auto& row : result) {
-            if (!row.empty()) {
-                std::string ddsLocation = row[0];
-                if (!ddsLocation.empty()) {
-                    return true;  // File is archived if we have a non-empty DDS location
-                }
+            std::string ddsLocation = row[0].c_str();
+            if (!ddsLocation.empty()) {
+                return true;  // File is archived if we have a non-empty DDS location
             }
         }
         
@@ -385,30 +647,19 @@ bool ArchivalController::isFileArchivedToDDS(const std::string& filePath) {
 }
 
 void ArchivalController::updateFileArchivalStatus(const std::string& filePath, const std::string& ddsFilePath) {
-    std::string query;
-    if (filePath.find("Videos") != std::string::npos) {
-        query = "UPDATE analytics SET dds_video_file_location = '" + ddsFilePath + "' WHERE video_file_location = '" + filePath + "'";
-    } else if (filePath.find("Analysis") != std::string::npos) {
-        query = "UPDATE analytics SET dds_parquet_file_location = '" + ddsFilePath + "' WHERE parquet_file_location = '" + filePath + "'";
-    } else {
-        return;
-    }
-
-    try {
-        db.executeUpdate(query);
-    } catch (const std::exception& e) {
-        logger->error("Failed to update archival status", createLogInfo({{"error", e.what()}}), "ARCHIVE_UPDATE_FAIL", true, "05008");
-        logIncidentToDB("Failed to update archival status", createLogInfo({{"error", e.what()}}), "05008");
+    // The UPDATE is applied by the background DB writer; failures there raise incident 05008.
+    FileCategory category = classifyFile(filePath);
+    if (category == FileCategory::Video) {
+        DbWriter::getInstance().enqueueVideoArchivalStatus(filePath, ddsFilePath, logger);
+    } else if (category == FileCategory::Analysis) {
+        DbWriter::getInstance().enqueueParquetArchivalStatus(filePath, ddsFilePath, logger);
     }
 }
 
 std::string ArchivalController::getDestinationPath(const std::string& filePath) {
-    auto destinationPath = filePath;
-    std::string mountedPath = archivalPolicy.at("MOUNTED_PATH").get<std::string>();
-    size_t pos = filePath.find(mountedPath);
-    if (pos != std::string::npos) {
-        destinationPath.replace(pos, mountedPath.length(), archivalPolicy.at("DDS_PATH").get<std::string>());
-    } else {
+    std::string destinationPath;
+    if (!policy.toDdsPath(filePath, destinationPath)) {
+        destinationPath = filePath;
         logger->critical("Failed to create destination path",
                          createLogInfo({{"detail", "MOUNTED_PATH not found in filePath"}}),
                          "DEST_PATH_ERR", true, "05012");
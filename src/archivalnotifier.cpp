@@ -0,0 +1,127 @@
+#include "archivalnotifier.hpp"
+#include "connectionpool.hpp"
+#include "logutils.hpp"
+#include <chrono>
+#include <iostream>
+#include <nlohmann/json.hpp>
+#include <pqxx/pqxx>
+
+namespace {
+    // Forwards notifications on the analytics channel to the notifier.
+    class AnalyticsInsertReceiver : public pqxx::notification_receiver {
+    public:
+        AnalyticsInsertReceiver(pqxx::connection& connection, ArchivalNotifier& notifier)
+            : pqxx::notification_receiver(connection, ArchivalNotifier::CHANNEL), notifier(notifier) {}
+
+        void operator()(const std::string& payload, int backendPid) override {
+            (void)backendPid;
+            notifier.handlePayload(payload);
+        }
+
+    private:
+        ArchivalNotifier& notifier;
+    };
+
+    const std::chrono::seconds RECONNECT_DELAY(10);
+}
+
+ArchivalNotifier::ArchivalNotifier(LoggingService* logger, std::size_t maxPending)
+    : logger(logger), maxPending(maxPending == 0 ? 1 : maxPending) {}
+
+ArchivalNotifier::~ArchivalNotifier() {
+    stop();
+}
+
+void ArchivalNotifier::start() {
+    if (running.exchange(true)) return;
+    listener = std::thread(&ArchivalNotifier::run, this);
+}
+
+void ArchivalNotifier::stop() {
+    running = false;
+    if (listener.joinable()) {
+        listener.join();
+    }
+}
+
+std::vector<std::string> ArchivalNotifier::drain() {
+    std::vector<std::string> paths;
+    std::size_t dropped = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        paths.assign(std::make_move_iterator(pending.begin()), std::make_move_iterator(pending.end()));
+        pending.clear();
+        pendingSet.clear();
+        dropped = droppedSinceLog;
+        droppedSinceLog = 0;
+    }
+
+    if (dropped > 0) {
+        logger->warning("Archival notifications dropped, left for periodic scan",
+                        createLogInfo({{"dropped", dropped}}), "ARCH_NOTIFY_DROPPED");
+    }
+    return paths;
+}
+
+std::size_t ArchivalNotifier::pendingCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return pending.size();
+}
+
+void ArchivalNotifier::handlePayload(const std::string& payload) {
+    try {
+        auto record = nlohmann::json::parse(payload);
+        for (const char* key : {"video_file_location", "parquet_file_location"}) {
+            if (record.contains(key) && record[key].is_string()) {
+                const auto& path = record[key].get_ref<const std::string&>();
+                if (!path.empty()) {
+                    enqueuePath(path);
+                }
+            }
+        }
+    } catch (const nlohmann::json::exception& e) {
+        std::cerr << "Ignoring malformed analytics notification: " << e.what() << std::endl;
+    }
+}
+
+void ArchivalNotifier::enqueuePath(const std::string& path) {
+    bool wasEmpty;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (pendingSet.count(path)) return;
+        if (pending.size() >= maxPending) {
+            ++droppedSinceLog;
+            return;
+        }
+        wasEmpty = pending.empty();
+        pending.push_back(path);
+        pendingSet.insert(path);
+    }
+    if (wasEmpty && wakeup) {
+        wakeup->notify();
+    }
+}
+
+// Holds a dedicated LISTEN session; reconnects after RECONNECT_DELAY if it drops.
+void ArchivalNotifier::run() {
+    while (running) {
+        try {
+            auto connection = ConnectionPool::getInstance().openDedicatedConnection();
+            AnalyticsInsertReceiver receiver(*connection, *this);
+            logger->info("Listening for analytics inserts",
+                         createLogInfo({{"channel", CHANNEL}}), "ARCH_NOTIFY_LISTEN");
+
+            while (running) {
+                connection->await_notification(1, 0);
+            }
+        } catch (const std::exception& e) {
+            logger->warning("Analytics notification listener disconnected",
+                            createLogInfo({{"detail", e.what()}}), "ARCH_NOTIFY_DISCONNECT");
+
+            auto retryAt = std::chrono::steady_clock::now() + RECONNECT_DELAY;
+            while (running && std::chrono::steady_clock::now() < retryAt) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(200));
+            }
+        }
+    }
+}
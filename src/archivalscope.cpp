@@ -0,0 +1,90 @@
+#include "archivalscope.hpp"
+#include "configservice.hpp"
+#include <algorithm>
+
+namespace {
+    constexpr int MAX_INTERVAL_MINUTES = 7 * 24 * 60;
+    constexpr int MAX_CONCURRENCY = 64;
+
+    bool parsePriority(const std::string& name, TaskPriority& priority) {
+        if (name == "normal") {
+            priority = TaskPriority::Normal;
+        } else if (name == "background") {
+            priority = TaskPriority::Background;
+        } else {
+            // Emergency is reserved for eviction
+            return false;
+        }
+        return true;
+    }
+
+    bool integerIn(const nlohmann::json& value, int minimum, int maximum) {
+        return value.is_number_integer() && value.get<long>() >= minimum && value.get<long>() <= maximum;
+    }
+}
+
+std::string parseArchivalScopes(const nlohmann::json& categories, std::vector<ArchivalScope>& scopes) {
+    scopes.clear();
+    if (!categories.is_object()) {
+        return "archival.categories must be an object";
+    }
+    for (const auto& [name, settings] : categories.items()) {
+        const std::string where = "archival.categories." + name;
+        FileCategory category = categoryOfComponent(name);
+        if (category == FileCategory::Unknown) {
+            return where + " is not a category (Videos, Analysis, Diagnostics, Logs, VideoClips)";
+        }
+        if (!settings.is_object()) {
+            return where + " must be an object";
+        }
+
+        ArchivalScope scope;
+        scope.name = std::string("archival:") + categoryDirectory(category);
+        scope.categories = 1u << categoryIndex(category);
+
+        auto interval = settings.find("interval_minutes");
+        if (interval == settings.end() || !integerIn(*interval, 1, MAX_INTERVAL_MINUTES)) {
+            return where + ".interval_minutes must be an integer in [1, " + std::to_string(MAX_INTERVAL_MINUTES) + "]";
+        }
+        scope.intervalMinutes = interval->get<int>();
+
+        auto concurrency = settings.find("concurrency");
+        if (concurrency != settings.end()) {
+            if (!integerIn(*concurrency, 0, MAX_CONCURRENCY)) {
+                return where + ".concurrency must be an integer in [0, " + std::to_string(MAX_CONCURRENCY) + "]";
+            }
+            scope.concurrency = concurrency->get<std::size_t>();
+        }
+
+        auto priority = settings.find("priority");
+        if (priority != settings.end() &&
+            (!priority->is_string() || !parsePriority(priority->get<std::string>(), scope.priority))) {
+            return where + ".priority must be \"normal\" or \"background\"";
+        }
+        scopes.push_back(scope);
+    }
+
+    // Same order whatever the JSON key order, so job names and timers line up across reloads
+    std::sort(scopes.begin(), scopes.end(), [](const ArchivalScope& a, const ArchivalScope& b) {
+        return a.categories < b.categories;
+    });
+    return "";
+}
+
+std::vector<ArchivalScope> loadArchivalScopes() {
+    std::vector<ArchivalScope> scopes;
+    const auto& archival = ConfigService::getInstance().current()->section("archival");
+    auto categories = archival.find("categories");
+    if (categories == archival.end() || !parseArchivalScopes(*categories, scopes).empty()) {
+        scopes.clear();
+    }
+    return scopes;
+}
+
+ArchivalScope defaultArchivalScope(const std::vector<ArchivalScope>& categoryScopes) {
+    ArchivalScope scope;
+    for (const auto& categoryScope : categoryScopes) {
+        scope.categories &= ~categoryScope.categories;
+    }
+    return scope;
+}
@@ -0,0 +1,210 @@
+#include "asynclogger.hpp"
+#include "configservice.hpp"
+#include <chrono>
+#include <memory>
+#include <unordered_map>
+#include <nlohmann/json.hpp>
+
+namespace {
+    struct AsyncLoggingSettings {
+        bool enabled = true;
+        std::size_t capacity = 4096;
+        std::string overflowPolicy = "drop";
+    };
+
+    // Reads the optional "logging" section of the config snapshot; falls back to defaults.
+    AsyncLoggingSettings loadAsyncLoggingSettings() {
+        AsyncLoggingSettings settings;
+        auto snapshot = ConfigService::getInstance().current();
+        try {
+            const auto& logging = snapshot->section("logging");
+            settings.enabled = logging.value("async_enabled", settings.enabled);
+            settings.capacity = logging.value("async_buffer_capacity", settings.capacity);
+            settings.overflowPolicy = logging.value("async_overflow_policy", settings.overflowPolicy);
+        } catch (const nlohmann::json::exception& e) {
+            // Keep defaults
+        }
+        return settings;
+    }
+
+    struct Registry {
+        std::mutex mutex;
+        std::unordered_map<LoggingService*, std::unique_ptr<AsyncLogger>> instances;
+    };
+
+    Registry& registry() {
+        static Registry instance;
+        return instance;
+    }
+
+    // Longest the idle flusher sleeps before reporting drops and checking for records again
+    const auto IDLE_TIMEOUT = std::chrono::seconds(1);
+    const auto BLOCK_RETRY_SLEEP = std::chrono::microseconds(50);
+}
+
+AsyncLogger& AsyncLogger::getInstance(LoggingService* logger) {
+    static AsyncLoggingSettings settings = loadAsyncLoggingSettings();
+    auto& shared = registry();
+    std::lock_guard<std::mutex> lock(shared.mutex);
+    auto& instance = shared.instances[logger];
+    if (!instance) {
+        instance = std::make_unique<AsyncLogger>(logger, settings.capacity,
+                                                 parseOverflowPolicy(settings.overflowPolicy), settings.enabled);
+    }
+    return *instance;
+}
+
+void AsyncLogger::stopAll() {
+    auto& shared = registry();
+    std::lock_guard<std::mutex> lock(shared.mutex);
+    for (auto& entry : shared.instances) {
+        entry.second->stop();
+    }
+}
+
+AsyncLogger::OverflowPolicy AsyncLogger::parseOverflowPolicy(const std::string& name) {
+    return name == "block" ? OverflowPolicy::Block : OverflowPolicy::Drop;
+}
+
+AsyncLogger::AsyncLogger(LoggingService* logger, std::size_t capacity, OverflowPolicy policy, bool enabled)
+    : logger(logger), policy(policy), enabled(enabled), buffer(enabled ? capacity : 2) {
+    if (enabled) {
+        running = true;
+        flusher = std::thread(&AsyncLogger::run, this);
+    }
+}
+
+AsyncLogger::~AsyncLogger() {
+    stop();
+}
+
+void AsyncLogger::info(const LogRecord& record) {
+    submit(Level::Info, record);
+}
+
+void AsyncLogger::warning(const LogRecord& record) {
+    submit(Level::Warning, record);
+}
+
+void AsyncLogger::error(const LogRecord& record) {
+    submit(Level::Error, record);
+}
+
+void AsyncLogger::submit(Level level, const LogRecord& log) {
+    Record record{level, log};
+    if (!enabled || !running.load(std::memory_order_acquire)) {
+        write(record);
+        return;
+    }
+
+    if (buffer.tryPush(record)) {
+        pushed.fetch_add(1, std::memory_order_release);
+        wake();
+        return;
+    }
+
+    if (policy == OverflowPolicy::Drop) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    // Block policy: wait for the flusher to free a slot.
+    while (!buffer.tryPush(record)) {
+        if (!running.load(std::memory_order_acquire)) {
+            write(record);
+            return;
+        }
+        std::this_thread::sleep_for(BLOCK_RETRY_SLEEP);
+    }
+    pushed.fetch_add(1, std::memory_order_release);
+    wake();
+}
+
+void AsyncLogger::wake() {
+    // Pairs with the fence in run(): either the flusher sees the record or we see it sleeping
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleeping.load(std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        ready.notify_one();
+    }
+}
+
+void AsyncLogger::flush() {
+    if (!enabled) return;
+    const std::uint64_t target = pushed.load(std::memory_order_acquire);
+    std::unique_lock<std::mutex> lock(wakeMutex);
+    while (written.load(std::memory_order_acquire) < target && running.load(std::memory_order_acquire)) {
+        drained.wait_for(lock, IDLE_TIMEOUT);
+    }
+}
+
+void AsyncLogger::stop() {
+    if (!running.exchange(false)) return;
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        ready.notify_one();
+        drained.notify_all();
+    }
+    if (flusher.joinable()) {
+        flusher.join();
+    }
+
+    // Records pushed while the flusher was exiting
+    Record record;
+    while (buffer.tryPop(record)) {
+        write(record);
+        written.fetch_add(1, std::memory_order_release);
+    }
+}
+
+void AsyncLogger::write(const Record& record) {
+    const LogRecord& log = record.log;
+    switch (record.level) {
+        case Level::Info:
+            logger->info(log.message(), log.toJson(), log.code());
+            break;
+        case Level::Warning:
+            logger->warning(log.message(), log.toJson(), log.code());
+            break;
+        case Level::Error:
+            logger->error(log.message(), log.toJson(), log.code());
+            break;
+    }
+}
+
+// Flusher loop: writes records as they arrive, sleeps while there are none and
+// drains the buffer on stop.
+void AsyncLogger::run() {
+    Record record;
+    std::uint64_t lastReportedDrops = 0;
+
+    while (true) {
+        bool stopping = !running.load(std::memory_order_acquire);
+        bool wroteAny = false;
+        while (buffer.tryPop(record)) {
+            write(record);
+            written.fetch_add(1, std::memory_order_release);
+            wroteAny = true;
+        }
+
+        std::uint64_t drops = dropped.load(std::memory_order_relaxed);
+        if (drops != lastReportedDrops) {
+            logger->warning("Async log buffer full, records dropped",
+                            {{"dropped", drops - lastReportedDrops}}, "ASYNC_LOG_DROP");
+            lastReportedDrops = drops;
+        }
+
+        if (stopping) break;
+
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        if (wroteAny) {
+            drained.notify_all();
+        }
+        sleeping.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (buffer.size() == 0 && running.load(std::memory_order_acquire)) {
+            ready.wait_for(lock, IDLE_TIMEOUT);
+        }
+        sleeping.store(false, std::memory_order_relaxed);
+    }
+}
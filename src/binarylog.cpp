@@ -0,0 +1,276 @@
+#include "binarylog.hpp"
+#include "configservice.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <iostream>
+#include <unistd.h>
+#include <nlohmann/json.hpp>
+
+namespace {
+    struct BinaryLogSettings {
+        bool enabled = false;
+        std::string path = "efms_events.bin";
+        std::size_t bufferBytes = 64 * 1024;
+    };
+
+    // Reads the optional "logging" section of the config snapshot; falls back to defaults.
+    BinaryLogSettings loadBinaryLogSettings() {
+        BinaryLogSettings settings;
+        auto snapshot = ConfigService::getInstance().current();
+        try {
+            const auto& logging = snapshot->section("logging");
+            settings.enabled = logging.value("binary_log_enabled", settings.enabled);
+            settings.path = logging.value("binary_log_path", settings.path);
+            settings.bufferBytes = logging.value("binary_log_buffer_bytes", settings.bufferBytes);
+        } catch (const nlohmann::json::exception& e) {
+            // Keep defaults
+        }
+        return settings;
+    }
+
+    enum RecordType : std::uint8_t {
+        SEGMENT_RECORD = 0xB0,
+        STRING_RECORD = 0xB1,
+        EVENT_RECORD = 0xB2
+    };
+
+    const char SEGMENT_MAGIC[7] = {'E', 'F', 'M', 'S', 'B', 'L', 'G'};
+
+    // Records carry no length or checksum; one cut short by a crash shows up as
+    // the bytes after it not starting a record.
+    bool atRecordBoundary(std::istream& in) {
+        int next = in.peek();
+        return next == std::char_traits<char>::eof() || next == SEGMENT_RECORD || next == STRING_RECORD ||
+               next == EVENT_RECORD;
+    }
+
+    template <typename T>
+    void putLittleEndian(std::vector<unsigned char>& out, T value) {
+        auto bits = static_cast<std::uint64_t>(value);
+        for (std::size_t i = 0; i < sizeof(T); ++i) {
+            out.push_back(static_cast<unsigned char>(bits >> (8 * i)));
+        }
+    }
+
+    template <typename T>
+    bool getLittleEndian(std::istream& in, T& value) {
+        unsigned char bytes[sizeof(T)];
+        if (!in.read(reinterpret_cast<char*>(bytes), sizeof(T))) return false;
+        std::uint64_t bits = 0;
+        for (std::size_t i = 0; i < sizeof(T); ++i) {
+            bits |= static_cast<std::uint64_t>(bytes[i]) << (8 * i);
+        }
+        value = static_cast<T>(bits);
+        return true;
+    }
+
+    // Writes the whole buffer, retrying on short writes and EINTR.
+    bool writeAll(int fd, const unsigned char* data, std::size_t size) {
+        while (size > 0) {
+            ssize_t written = ::write(fd, data, size);
+            if (written < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            data += written;
+            size -= static_cast<std::size_t>(written);
+        }
+        return true;
+    }
+
+    const std::vector<EventSchema>& eventSchemas() {
+        // Indexed by EventId - 1
+        static const std::vector<EventSchema> schemas = {
+            {"file_deleted", {"bytes"}},
+            {"file_archived", {"bytes"}},
+            {"directory_deleted", {}},
+            // bytes_copied was appended; bytes_deleted is what older builds wrote as "bytes"
+            {"directory_summary", {"files_seen", "eligible", "archived", "deleted", "bytes_deleted", "errors",
+                                   "bytes_copied"}},
+            {"cycle_summary", {"directories", "files_seen", "eligible", "archived", "deleted", "bytes_deleted", "errors",
+                               "duration_ms", "bytes_copied"}}
+        };
+        return schemas;
+    }
+}
+
+const EventSchema* findEventSchema(std::uint16_t id) {
+    const auto& schemas = eventSchemas();
+    if (id == 0 || id > schemas.size()) return nullptr;
+    return &schemas[id - 1];
+}
+
+BinaryEventLog& BinaryEventLog::getInstance() {
+    static BinaryLogSettings settings = loadBinaryLogSettings();
+    static BinaryEventLog instance(settings.enabled ? settings.path : std::string(), settings.bufferBytes);
+    return instance;
+}
+
+BinaryEventLog::BinaryEventLog(const std::string& path, std::size_t bufferBytes)
+    : bufferBytes(std::max<std::size_t>(bufferBytes, 4096)) {
+    if (path.empty()) return;
+
+    std::error_code ec;
+    auto parent = std::filesystem::path(path).parent_path();
+    if (!parent.empty()) {
+        std::filesystem::create_directories(parent, ec);
+    }
+
+    fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        std::cerr << "Binary event log disabled, cannot open " << path << ": " << std::strerror(errno) << std::endl;
+        return;
+    }
+
+    buffer.reserve(this->bufferBytes);
+    beginSegmentLocked();
+}
+
+BinaryEventLog::~BinaryEventLog() {
+    if (fd < 0) return;
+    flush();
+    ::close(fd);
+}
+
+void BinaryEventLog::record(EventId event, const std::string& path, std::initializer_list<std::int64_t> fields) {
+    if (fd < 0) return;
+
+    auto timestampUs = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    auto count = static_cast<std::uint8_t>(std::min(fields.size(), MAX_FIELDS));
+
+    std::lock_guard<std::mutex> lock(mutex);
+    std::uint32_t pathId = internLocked(path);
+
+    buffer.push_back(EVENT_RECORD);
+    putLittleEndian(buffer, static_cast<std::uint16_t>(event));
+    putLittleEndian(buffer, static_cast<std::uint64_t>(timestampUs));
+    putLittleEndian(buffer, pathId);
+    buffer.push_back(count);
+    auto field = fields.begin();
+    for (std::uint8_t i = 0; i < count; ++i, ++field) {
+        putLittleEndian(buffer, *field);
+    }
+
+    if (buffer.size() >= bufferBytes) {
+        flushLocked();
+    }
+}
+
+void BinaryEventLog::flush() {
+    if (fd < 0) return;
+    std::lock_guard<std::mutex> lock(mutex);
+    flushLocked();
+}
+
+// Starts a segment; readers drop their string table at its header.
+void BinaryEventLog::beginSegmentLocked() {
+    strings.clear();
+    buffer.push_back(SEGMENT_RECORD);
+    buffer.insert(buffer.end(), SEGMENT_MAGIC, SEGMENT_MAGIC + sizeof(SEGMENT_MAGIC));
+    buffer.push_back(FORMAT_VERSION);
+}
+
+// Returns the id of an already written string, writing a string record first if it is new.
+std::uint32_t BinaryEventLog::internLocked(const std::string& value) {
+    auto it = strings.find(value);
+    if (it != strings.end()) {
+        return it->second;
+    }
+    if (strings.size() >= MAX_STRINGS) {
+        // Paths are high-cardinality; start over rather than remember every one
+        beginSegmentLocked();
+    }
+
+    auto id = static_cast<std::uint32_t>(strings.size());
+    auto length = static_cast<std::uint16_t>(std::min<std::size_t>(value.size(), UINT16_MAX));
+    buffer.push_back(STRING_RECORD);
+    putLittleEndian(buffer, id);
+    putLittleEndian(buffer, length);
+    buffer.insert(buffer.end(), value.begin(), value.begin() + length);
+    strings.emplace(value, id);
+    return id;
+}
+
+void BinaryEventLog::flushLocked() {
+    if (buffer.empty()) return;
+    if (!writeAll(fd, buffer.data(), buffer.size())) {
+        std::cerr << "Binary event log write failed: " << std::strerror(errno) << std::endl;
+    }
+    buffer.clear();
+}
+
+bool BinaryEventReader::next(DecodedEvent& event) {
+    while (true) {
+        const std::streampos start = input.tellg();
+        int type = input.get();
+        if (type == std::char_traits<char>::eof()) {
+            return false;
+        }
+
+        bool valid = false;
+        if (type == SEGMENT_RECORD) {
+            char magic[sizeof(SEGMENT_MAGIC)];
+            std::uint8_t version = 0;
+            valid = input.read(magic, sizeof(magic)) && std::memcmp(magic, SEGMENT_MAGIC, sizeof(magic)) == 0 &&
+                    getLittleEndian(input, version) && version == BinaryEventLog::FORMAT_VERSION;
+            strings.clear();
+        } else if (type == STRING_RECORD) {
+            std::uint32_t id = 0;
+            std::uint16_t length = 0;
+            valid = getLittleEndian(input, id) && getLittleEndian(input, length);
+            std::string value(valid ? length : 0, '\0');
+            if (valid && length > 0) {
+                valid = static_cast<bool>(input.read(&value[0], length));
+            }
+            valid = valid && atRecordBoundary(input);
+            if (valid) {
+                strings[id] = std::move(value);
+            }
+        } else if (type == EVENT_RECORD) {
+            std::uint32_t pathId = 0;
+            std::uint8_t count = 0;
+            valid = getLittleEndian(input, event.event) && getLittleEndian(input, event.timestampUs) &&
+                    getLittleEndian(input, pathId) && getLittleEndian(input, count);
+            event.fields.resize(valid ? count : 0);
+            for (auto& field : event.fields) {
+                valid = valid && getLittleEndian(input, field);
+            }
+            if (valid && atRecordBoundary(input)) {
+                auto it = strings.find(pathId);
+                event.path = it != strings.end() ? it->second : std::string();
+                return true;
+            }
+            valid = false;
+        }
+
+        if (!valid && !resync(start)) {
+            return false;
+        }
+    }
+}
+
+bool BinaryEventReader::resync(std::streampos from) {
+    corrupt = true;
+    strings.clear();
+    // Search from the byte after the bad record's start: its length fields may have swallowed the next header
+    input.clear();
+    input.seekg(from + std::streamoff(1));
+    std::size_t matched = 0;
+    int byte;
+    while ((byte = input.get()) != std::char_traits<char>::eof()) {
+        if (matched > 0 && static_cast<char>(byte) == SEGMENT_MAGIC[matched - 1]) {
+            if (++matched == 1 + sizeof(SEGMENT_MAGIC)) {
+                input.seekg(-static_cast<std::streamoff>(matched), std::ios::cur);
+                return true;
+            }
+        } else {
+            matched = byte == SEGMENT_RECORD ? 1 : 0;
+        }
+    }
+    return false;
+}
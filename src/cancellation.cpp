@@ -0,0 +1,39 @@
+#include "cancellation.hpp"
+
+CancellationToken::CancellationToken() : state(std::make_shared<State>()) {}
+
+const CancellationToken& CancellationToken::none() {
+    static const CancellationToken token;
+    return token;
+}
+
+void CancellationToken::cancel(const std::string& reason) {
+    std::lock_guard<std::mutex> lock(state->mutex);
+    // The first reason wins; later cancels only repeat it
+    if (!state->cancelled.exchange(true)) {
+        state->reason = reason;
+    }
+}
+
+void CancellationToken::setDeadline(std::chrono::steady_clock::time_point deadline) {
+    state->deadline = deadline.time_since_epoch().count();
+}
+
+bool CancellationToken::isCancelled() const {
+    if (state->cancelled.load(std::memory_order_relaxed)) {
+        return true;
+    }
+    auto deadline = state->deadline.load(std::memory_order_relaxed);
+    return deadline != std::chrono::steady_clock::duration::max().count() &&
+           std::chrono::steady_clock::now().time_since_epoch().count() >= deadline;
+}
+
+std::string CancellationToken::reason() const {
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        if (state->cancelled) {
+            return state->reason;
+        }
+    }
+    return isCancelled() ? "deadline exceeded" : "";
+}
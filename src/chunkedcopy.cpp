@@ -0,0 +1,146 @@
+#include "chunkedcopy.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+    // Longest a throttled copy sleeps before looking at the token again
+    constexpr auto THROTTLE_SLICE = std::chrono::milliseconds(100);
+
+    CopyResult failure(const std::string& what, const std::string& path) {
+        CopyResult result;
+        result.status = CopyStatus::Failed;
+        result.error = what + " " + path + ": " + std::strerror(errno);
+        return result;
+    }
+
+    // Closes both descriptors and removes the temporary file unless it was renamed.
+    struct CopyFiles {
+        int input = -1;
+        int output = -1;
+        std::string temporary;
+        bool committed = false;
+
+        ~CopyFiles() {
+            if (input >= 0) close(input);
+            if (output >= 0) close(output);
+            if (!committed && !temporary.empty()) {
+                std::error_code ec;
+                std::filesystem::remove(temporary, ec);
+            }
+        }
+    };
+
+    bool writeAll(int fd, const char* data, std::size_t length) {
+        while (length > 0) {
+            ssize_t written = write(fd, data, length);
+            if (written < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            data += written;
+            length -= static_cast<std::size_t>(written);
+        }
+        return true;
+    }
+
+    // Sleeps until `target`, waking every THROTTLE_SLICE to check the token. Returns false if cancelled.
+    bool throttleUntil(std::chrono::steady_clock::time_point target, const CancellationToken& token) {
+        while (std::chrono::steady_clock::now() < target) {
+            if (token.isCancelled()) return false;
+            std::this_thread::sleep_for(
+                std::min<std::chrono::steady_clock::duration>(target - std::chrono::steady_clock::now(), THROTTLE_SLICE));
+        }
+        return true;
+    }
+}
+
+CopyResult copyFileChunked(const std::string& source, const std::string& destination, int bandwidthLimitKb,
+                           const CancellationToken& token, std::size_t chunkSize,
+                           const PressureThrottle* throttle) {
+    CopyResult result;
+    if (token.isCancelled()) {
+        result.status = CopyStatus::Cancelled;
+        return result;
+    }
+
+    CopyFiles files;
+    files.input = open(source.c_str(), O_RDONLY | O_CLOEXEC);
+    if (files.input < 0) {
+        return failure("Cannot open", source);
+    }
+
+    std::error_code ec;
+    auto parent = std::filesystem::path(destination).parent_path();
+    if (!parent.empty()) {
+        std::filesystem::create_directories(parent, ec);
+    }
+    // A name of its own, so two copies racing to the same destination never write one file
+    std::string temporary = destination + ".efms-part.XXXXXX";
+    files.output = mkostemp(temporary.data(), O_CLOEXEC);
+    if (files.output < 0) {
+        return failure("Cannot create", temporary);
+    }
+    files.temporary = temporary;
+    if (fchmod(files.output, 0644) != 0) {
+        return failure("Cannot set permissions on", files.temporary);
+    }
+
+    std::vector<char> buffer(chunkSize == 0 ? 1 : chunkSize);
+    // When the copy may write its next chunk; paced from the start, so a slow read is made up for
+    auto due = std::chrono::steady_clock::now();
+
+    while (true) {
+        if (token.isCancelled()) {
+            result.status = CopyStatus::Cancelled;
+            return result;
+        }
+        ssize_t length = read(files.input, buffer.data(), buffer.size());
+        if (length < 0) {
+            if (errno == EINTR) continue;
+            return failure("Cannot read", source);
+        }
+        if (length == 0) break;
+        if (!writeAll(files.output, buffer.data(), static_cast<std::size_t>(length))) {
+            return failure("Cannot write", files.temporary);
+        }
+        result.bytes += static_cast<std::uint64_t>(length);
+
+        const int limitKb = throttle ? throttle->bandwidthKb(bandwidthLimitKb) : bandwidthLimitKb;
+        if (limitKb <= 0) {
+            // Unthrottled chunks do not build up credit for later ones
+            due = std::chrono::steady_clock::now();
+        } else {
+            due += std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double>(length / (limitKb * 1024.0)));
+            if (!throttleUntil(due, token)) {
+                result.status = CopyStatus::Cancelled;
+                return result;
+            }
+        }
+    }
+
+    // Durable before it becomes visible under the final name
+    if (fsync(files.output) != 0) {
+        return failure("Cannot sync", files.temporary);
+    }
+    int output = files.output;
+    files.output = -1;
+    if (close(output) != 0) {
+        return failure("Cannot close", files.temporary);
+    }
+    if (rename(files.temporary.c_str(), destination.c_str()) != 0) {
+        return failure("Cannot rename to", destination);
+    }
+    files.committed = true;
+    result.status = CopyStatus::Copied;
+    return result;
+}
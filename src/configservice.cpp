@@ -0,0 +1,254 @@
+#include "configservice.hpp"
+#include "ruleengine.hpp"
+#include "archivalscope.hpp"
+#include "threadisolation.hpp"
+#include "iopressure.hpp"
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+namespace {
+    // Empty if config[section][key] is absent or an integer in [minimum, maximum]; otherwise the problem.
+    std::string checkInteger(const nlohmann::json& config, const char* section, const char* key,
+                             long minimum, long maximum) {
+        if (!config.contains(section) || !config[section].is_object() || !config[section].contains(key)) {
+            return "";
+        }
+        const auto& value = config[section][key];
+        if (!value.is_number_integer() || value.get<long>() < minimum || value.get<long>() > maximum) {
+            return std::string(section) + "." + key + " must be an integer in [" + std::to_string(minimum) +
+                   ", " + std::to_string(maximum) + "]";
+        }
+        return "";
+    }
+
+    const nlohmann::json& emptyObject() {
+        static const nlohmann::json empty = nlohmann::json::object();
+        return empty;
+    }
+}
+
+ConfigSnapshot::ConfigSnapshot(nlohmann::json document, std::uint64_t version, bool loaded, std::string error)
+    : document(std::move(document)), snapshotVersion(version), loaded(loaded), loadError(std::move(error)) {}
+
+const nlohmann::json& ConfigSnapshot::section(const char* name) const {
+    if (!document.is_object()) return emptyObject();
+    auto it = document.find(name);
+    return it != document.end() && it->is_object() ? *it : emptyObject();
+}
+
+ConfigService& ConfigService::getInstance() {
+    static ConfigService instance("config.json");
+    return instance;
+}
+
+ConfigService::ConfigService(std::string path) : path(std::move(path)) {
+    auto initial = parse(1);
+    error = initial->error();
+    std::atomic_store(&snapshot, std::move(initial));
+}
+
+ConfigService::~ConfigService() {
+    stopWatching();
+}
+
+std::shared_ptr<const ConfigSnapshot> ConfigService::current() const {
+    return std::atomic_load(&snapshot);
+}
+
+std::shared_ptr<const ConfigSnapshot> ConfigService::parse(std::uint64_t version) const {
+    std::ifstream configFile(path);
+    if (!configFile.is_open()) {
+        return std::make_shared<const ConfigSnapshot>(nlohmann::json::object(), version, false,
+                                                      "Failed to open " + path);
+    }
+    try {
+        nlohmann::json config;
+        configFile >> config;
+        return std::make_shared<const ConfigSnapshot>(std::move(config), version, true);
+    } catch (const nlohmann::json::exception& e) {
+        return std::make_shared<const ConfigSnapshot>(nlohmann::json::object(), version, false,
+                                                      "Failed to parse " + path + ": " + e.what());
+    }
+}
+
+std::string ConfigService::validate(const nlohmann::json& config) {
+    if (!config.is_object()) {
+        return "config must be a JSON object";
+    }
+
+    const std::string checks[] = {
+        checkInteger(config, "scheduler", "archival_interval_minutes", 1, 7 * 24 * 60),
+        checkInteger(config, "scheduler", "retention_interval_minutes", 1, 7 * 24 * 60),
+        checkInteger(config, "scheduler", "archival_min_interval_minutes", 1, 7 * 24 * 60),
+        checkInteger(config, "scheduler", "archival_max_interval_minutes", 1, 7 * 24 * 60),
+        checkInteger(config, "scheduler", "io_concurrency", 1, 64),
+        checkInteger(config, "scheduler", "max_run_minutes", 0, 7 * 24 * 60),
+        checkInteger(config, "executor", "workers", 0, 64),
+        checkInteger(config, "disk_pressure", "sample_interval_seconds", 1, 3600),
+        checkInteger(config, "disk_pressure", "retrigger_seconds", 1, 24 * 60 * 60),
+        checkInteger(config, "incremental", "tick_seconds", 1, 24 * 60 * 60),
+        checkInteger(config, "incremental", "max_files", 0, 1L << 30),
+        checkInteger(config, "incremental", "max_megabytes", 0, 1L << 30),
+        checkInteger(config, "incremental", "max_milliseconds", 0, 24L * 60 * 60 * 1000),
+        checkInteger(config, "archival", "bandwidth_limit_kb", 0, 1L << 30),
+        checkInteger(config, "vecow_retention_policy", "threshold_storage_utilization", 0, 100),
+        checkInteger(config, "dds_retention_policy", "threshold_storage_utilization", 0, 100)
+    };
+    for (const auto& check : checks) {
+        if (!check.empty()) return check;
+    }
+
+    // Per-category archival pipelines
+    if (config.contains("archival") && config["archival"].is_object() && config["archival"].contains("categories")) {
+        std::vector<ArchivalScope> scopes;
+        std::string problem = parseArchivalScopes(config["archival"]["categories"], scopes);
+        if (!problem.empty()) return problem;
+    }
+
+    // Thread isolation lanes
+    if (config.contains("isolation") && config["isolation"].is_object()) {
+        for (const char* lane : {"emergency", "normal", "background"}) {
+            if (!config["isolation"].contains(lane)) continue;
+            ThreadPolicy policy;
+            std::string problem = ThreadIsolation::parsePolicy(config["isolation"][lane], policy);
+            if (!problem.empty()) return std::string("isolation.") + lane + " " + problem;
+        }
+    }
+
+    // Pressure stall throttling
+    if (config.contains("io_pressure")) {
+        PsiMonitor::Settings settings;
+        std::string problem = PsiMonitor::parseSettings(config["io_pressure"], settings);
+        if (!problem.empty()) return "io_pressure " + problem;
+    }
+
+    // Rule expressions must compile; a bad edit should not silently fall back to defaults
+    if (config.contains("rules")) {
+        if (!config["rules"].is_object()) {
+            return "rules must be an object";
+        }
+        for (const auto& [section, expressions] : config["rules"].items()) {
+            if (!expressions.is_object()) continue;
+            for (const auto& [category, expression] : expressions.items()) {
+                if (!expression.is_string()) {
+                    return "rules." + section + "." + category + " must be a string";
+                }
+                try {
+                    RuleProgram::compile(expression.get<std::string>());
+                } catch (const std::invalid_argument& e) {
+                    return "rules." + section + "." + category + ": " + e.what();
+                }
+            }
+        }
+    }
+    return "";
+}
+
+bool ConfigService::reload() {
+    std::vector<Listener> toNotify;
+    std::shared_ptr<const ConfigSnapshot> next;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        next = parse(current()->version() + 1);
+        std::string problem = next->isLoaded() ? validate(next->json()) : next->error();
+        if (!problem.empty()) {
+            error = problem;
+            std::cerr << "Config reload rejected, keeping version " << current()->version() << ": " << problem
+                      << std::endl;
+            return false;
+        }
+        error.clear();
+        std::atomic_store(&snapshot, next);
+        toNotify = listeners;
+    }
+
+    for (const auto& listener : toNotify) {
+        listener(*next);
+    }
+    return true;
+}
+
+std::string ConfigService::lastError() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return error;
+}
+
+void ConfigService::addListener(Listener listener) {
+    std::lock_guard<std::mutex> lock(mutex);
+    listeners.push_back(std::move(listener));
+}
+
+void ConfigService::startWatching() {
+    if (watching.exchange(true)) return;
+
+    // Watch the directory: editors and deploy tools usually replace the file rather than rewrite it
+    std::filesystem::path configPath(path);
+    std::string directory = configPath.has_parent_path() ? configPath.parent_path().string() : ".";
+
+    inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    stopFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (inotifyFd < 0 || stopFd < 0 ||
+        inotify_add_watch(inotifyFd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+        std::cerr << "Config watch disabled for " << path << ": " << std::strerror(errno) << std::endl;
+        if (inotifyFd >= 0) close(inotifyFd);
+        if (stopFd >= 0) close(stopFd);
+        inotifyFd = stopFd = -1;
+        watching = false;
+        return;
+    }
+
+    watcher = std::thread(&ConfigService::watch, this);
+}
+
+void ConfigService::stopWatching() {
+    if (!watching.exchange(false)) return;
+
+    std::uint64_t one = 1;
+    ssize_t ignored = write(stopFd, &one, sizeof(one));
+    (void)ignored;
+    if (watcher.joinable()) {
+        watcher.join();
+    }
+    close(inotifyFd);
+    close(stopFd);
+    inotifyFd = stopFd = -1;
+}
+
+void ConfigService::watch() {
+    const std::string fileName = std::filesystem::path(path).filename().string();
+    alignas(struct inotify_event) char buffer[4096];
+
+    while (true) {
+        pollfd fds[2] = {{inotifyFd, POLLIN, 0}, {stopFd, POLLIN, 0}};
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            std::cerr << "Config watch stopped: " << std::strerror(errno) << std::endl;
+            return;
+        }
+        if (fds[1].revents & POLLIN) {
+            return;
+        }
+
+        bool changed = false;
+        ssize_t length;
+        while ((length = read(inotifyFd, buffer, sizeof(buffer))) > 0) {
+            for (char* cursor = buffer; cursor < buffer + length;) {
+                auto* event = reinterpret_cast<struct inotify_event*>(cursor);
+                if (event->len > 0 && fileName == event->name) {
+                    changed = true;
+                }
+                cursor += sizeof(struct inotify_event) + event->len;
+            }
+        }
+        if (changed) {
+            reload();
+        }
+    }
+}
@@ -0,0 +1,181 @@
+#include "connectionpool.hpp"
+#include "configservice.hpp"
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <nlohmann/json.hpp>
+
+namespace {
+    struct PoolSettings {
+        std::string host = "localhost";
+        std::string user = "postgres";
+        std::string password = "mysecretpassword";
+        std::string dbname = "esk_galileo";
+        int port = 5432;
+        std::size_t poolSize = 4;
+        int healthCheckIdleSeconds = 30;
+        int acquireTimeoutMs = 5000;
+    };
+
+    // Reads the optional "database" section of the config snapshot; defaults match the DatabaseUtilities instance.
+    PoolSettings loadPoolSettings() {
+        PoolSettings settings;
+        auto snapshot = ConfigService::getInstance().current();
+        try {
+            const auto& database = snapshot->section("database");
+            settings.host = database.value("host", settings.host);
+            settings.user = database.value("user", settings.user);
+            settings.password = database.value("password", settings.password);
+            settings.dbname = database.value("dbname", settings.dbname);
+            settings.port = database.value("port", settings.port);
+            settings.poolSize = database.value("pool_size", settings.poolSize);
+            settings.healthCheckIdleSeconds = database.value("health_check_idle_seconds", settings.healthCheckIdleSeconds);
+            settings.acquireTimeoutMs = database.value("acquire_timeout_ms", settings.acquireTimeoutMs);
+        } catch (const nlohmann::json::exception& e) {
+            // Keep defaults
+        }
+        return settings;
+    }
+}
+
+ConnectionPool& ConnectionPool::getInstance() {
+    static ConnectionPool instance;
+    return instance;
+}
+
+ConnectionPool::ConnectionPool() {
+    PoolSettings settings = loadPoolSettings();
+
+    std::ostringstream conn;
+    conn << "host=" << settings.host
+         << " port=" << settings.port
+         << " dbname=" << settings.dbname
+         << " user=" << settings.user
+         << " password=" << settings.password;
+    connectionString = conn.str();
+
+    poolSize = settings.poolSize == 0 ? 1 : settings.poolSize;
+    healthCheckIdle = std::chrono::seconds(settings.healthCheckIdleSeconds);
+    acquireTimeout = std::chrono::milliseconds(settings.acquireTimeoutMs);
+}
+
+ConnectionPool::Lease ConnectionPool::acquire() {
+    std::unique_lock<std::mutex> lock(mutex);
+    const auto deadline = std::chrono::steady_clock::now() + acquireTimeout;
+
+    while (true) {
+        // Reuse the most recently returned connection if it is still healthy.
+        if (!idle.empty()) {
+            IdleConnection candidate = std::move(idle.back());
+            idle.pop_back();
+            lock.unlock();
+
+            if (isHealthy(*candidate.connection, candidate.lastUsed)) {
+                return Lease(this, std::move(candidate.connection));
+            }
+
+            candidate.connection.reset();
+            lock.lock();
+            --openCount;
+            continue;
+        }
+
+        // Lazily open a new connection while under the pool limit.
+        if (openCount < poolSize) {
+            ++openCount;
+            lock.unlock();
+            try {
+                return Lease(this, createConnection());
+            } catch (...) {
+                lock.lock();
+                --openCount;
+                available.notify_one();
+                throw;
+            }
+        }
+
+        if (available.wait_until(lock, deadline) == std::cv_status::timeout &&
+            idle.empty() && openCount >= poolSize) {
+            throw std::runtime_error("Timed out waiting for a database connection");
+        }
+    }
+}
+
+std::unique_ptr<pqxx::connection> ConnectionPool::openDedicatedConnection() {
+    return createConnection();
+}
+
+std::size_t ConnectionPool::openConnections() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return openCount;
+}
+
+std::size_t ConnectionPool::idleConnections() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return idle.size();
+}
+
+std::unique_ptr<pqxx::connection> ConnectionPool::createConnection() {
+    return std::make_unique<pqxx::connection>(connectionString);
+}
+
+// Connections idle longer than healthCheckIdle are probed with a trivial query before reuse.
+bool ConnectionPool::isHealthy(pqxx::connection& connection, std::chrono::steady_clock::time_point lastUsed) {
+    if (!connection.is_open()) {
+        return false;
+    }
+    if (std::chrono::steady_clock::now() - lastUsed < healthCheckIdle) {
+        return true;
+    }
+
+    try {
+        pqxx::nontransaction probe(connection);
+        probe.exec("SELECT 1");
+        return true;
+    } catch (const std::exception& e) {
+        std::cerr << "Discarding unhealthy database connection: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+void ConnectionPool::release(std::unique_ptr<pqxx::connection> connection, bool broken) {
+    bool reusable = !broken && connection && connection->is_open();
+    if (!reusable) {
+        connection.reset();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (reusable) {
+        idle.push_back({std::move(connection), std::chrono::steady_clock::now()});
+    } else {
+        --openCount;
+    }
+    available.notify_one();
+}
+
+ConnectionPool::Lease::Lease(ConnectionPool* pool, std::unique_ptr<pqxx::connection> connection)
+    : pool(pool), connection(std::move(connection)) {}
+
+ConnectionPool::Lease::Lease(Lease&& other) noexcept
+    : pool(other.pool), connection(std::move(other.connection)), broken(other.broken) {
+    other.pool = nullptr;
+}
+
+ConnectionPool::Lease& ConnectionPool::Lease::operator=(Lease&& other) noexcept {
+    if (this != &other) {
+        if (pool && connection) {
+            pool->release(std::move(connection), broken);
+        }
+        pool = other.pool;
+        connection = std::move(other.connection);
+        broken = other.broken;
+        other.pool = nullptr;
+    }
+    return *this;
+}
+
+ConnectionPool::Lease::~Lease() {
+    if (pool && connection) {
+        pool->release(std::move(connection), broken);
+    }
+}
@@ -0,0 +1,166 @@
+#include "dbspool.hpp"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <unistd.h>
+#include <nlohmann/json.hpp>
+
+namespace {
+    const char* typeName(DbWriteRequest::Type type) {
+        switch (type) {
+            case DbWriteRequest::Type::Incident: return "incident";
+            case DbWriteRequest::Type::VideoArchivalStatus: return "video_archival_status";
+            case DbWriteRequest::Type::ParquetArchivalStatus: return "parquet_archival_status";
+        }
+        return "unknown";
+    }
+
+    bool parseType(const std::string& name, DbWriteRequest::Type& type) {
+        if (name == "incident") {
+            type = DbWriteRequest::Type::Incident;
+        } else if (name == "video_archival_status") {
+            type = DbWriteRequest::Type::VideoArchivalStatus;
+        } else if (name == "parquet_archival_status") {
+            type = DbWriteRequest::Type::ParquetArchivalStatus;
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    // Writes the whole buffer, retrying on short writes and EINTR.
+    bool writeAll(int fd, const std::string& data) {
+        const char* cursor = data.data();
+        std::size_t remaining = data.size();
+        while (remaining > 0) {
+            ssize_t written = ::write(fd, cursor, remaining);
+            if (written < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            cursor += written;
+            remaining -= static_cast<std::size_t>(written);
+        }
+        return true;
+    }
+}
+
+DbSpool::DbSpool(const std::string& path) : path(path) {
+    std::error_code ec;
+    auto parent = std::filesystem::path(path).parent_path();
+    if (!parent.empty()) {
+        std::filesystem::create_directories(parent, ec);
+    }
+
+    // Pick up writes spooled before a restart.
+    for (const auto& request : readAllLocked()) {
+        ++pendingCount;
+        if (request.type != DbWriteRequest::Type::Incident) {
+            pendingArchivalPaths.insert(request.key);
+        }
+    }
+}
+
+bool DbSpool::append(const std::vector<const DbWriteRequest*>& writes) {
+    if (writes.empty()) return true;
+
+    std::string buffer;
+    for (const auto* request : writes) {
+        nlohmann::json record = {
+            {"type", typeName(request->type)},
+            {"key", request->key},
+            {"value", request->value},
+            {"error_code", request->errorCode}
+        };
+        if (!request->failureCode.empty()) {
+            record["failure_type"] = request->failureType;
+            record["failure_code"] = request->failureCode;
+        }
+        buffer += record.dump();
+        buffer += '\n';
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        std::cerr << "Failed to open DB spool " << path << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    bool ok = writeAll(fd, buffer) && ::fsync(fd) == 0;
+    if (!ok) {
+        std::cerr << "Failed to write DB spool " << path << ": " << std::strerror(errno) << std::endl;
+    }
+    ::close(fd);
+
+    if (ok) {
+        pendingCount += writes.size();
+        for (const auto* request : writes) {
+            if (request->type != DbWriteRequest::Type::Incident) {
+                pendingArchivalPaths.insert(request->key);
+            }
+        }
+    }
+    return ok;
+}
+
+std::vector<DbWriteRequest> DbSpool::readAll() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return readAllLocked();
+}
+
+std::vector<DbWriteRequest> DbSpool::readAllLocked() const {
+    std::vector<DbWriteRequest> requests;
+    std::ifstream spoolFile(path);
+    if (!spoolFile.is_open()) {
+        return requests;
+    }
+
+    std::string line;
+    while (std::getline(spoolFile, line)) {
+        if (line.empty()) continue;
+        try {
+            auto record = nlohmann::json::parse(line);
+            DbWriteRequest request;
+            if (!parseType(record.at("type").get<std::string>(), request.type)) continue;
+            request.key = record.at("key").get<std::string>();
+            request.value = record.at("value").get<std::string>();
+            request.errorCode = record.value("error_code", "");
+            request.failureType = record.value("failure_type", "");
+            request.failureCode = record.value("failure_code", "");
+            requests.push_back(std::move(request));
+        } catch (const nlohmann::json::exception& e) {
+            std::cerr << "Skipping malformed DB spool record: " << e.what() << std::endl;
+        }
+    }
+    return requests;
+}
+
+void DbSpool::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd >= 0) {
+        ::fsync(fd);
+        ::close(fd);
+    }
+    pendingCount = 0;
+    pendingArchivalPaths.clear();
+}
+
+bool DbSpool::empty() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return pendingCount == 0;
+}
+
+std::size_t DbSpool::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return pendingCount;
+}
+
+bool DbSpool::hasPendingArchivalStatus(const std::string& filePath) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return pendingArchivalPaths.count(filePath) > 0;
+}
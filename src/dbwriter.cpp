@@ -0,0 +1,360 @@
+#include "dbwriter.hpp"
+#include "configservice.hpp"
+#include "connectionpool.hpp"
+#include "dbspool.hpp"
+#include "logutils.hpp"
+#include "loglevel.hpp"
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <unordered_set>
+
+namespace {
+    struct DbWriterSettings {
+        std::size_t queueCapacity = 1024;
+        std::size_t batchSize = 64;
+        std::string spoolPath = "efms_db_spool.jsonl";
+        int spoolReplayIntervalSeconds = 10;
+    };
+
+    // Reads the optional "db_writer" section of the config snapshot; falls back to defaults.
+    DbWriterSettings loadDbWriterSettings() {
+        DbWriterSettings settings;
+        auto snapshot = ConfigService::getInstance().current();
+        try {
+            const auto& writer = snapshot->section("db_writer");
+            settings.queueCapacity = writer.value("queue_capacity", settings.queueCapacity);
+            settings.batchSize = writer.value("batch_size", settings.batchSize);
+            settings.spoolPath = writer.value("spool_path", settings.spoolPath);
+            settings.spoolReplayIntervalSeconds = writer.value("spool_replay_interval_seconds", settings.spoolReplayIntervalSeconds);
+        } catch (const nlohmann::json::exception& e) {
+            // Keep defaults
+        }
+        return settings;
+    }
+
+    const DbWriterSettings& settings() {
+        static const DbWriterSettings instance = loadDbWriterSettings();
+        return instance;
+    }
+}
+
+DbWriter& DbWriter::getInstance() {
+    static DbWriter instance;
+    return instance;
+}
+
+DbWriter::DbWriter()
+    : batchSize(settings().batchSize == 0 ? 1 : settings().batchSize),
+      queue(settings().queueCapacity),
+      spool(std::make_unique<DbSpool>(settings().spoolPath)),
+      spoolReplayInterval(settings().spoolReplayIntervalSeconds) {
+    worker = std::thread(&DbWriter::run, this);
+}
+
+DbWriter::~DbWriter() {
+    shutdown();
+}
+
+void DbWriter::enqueueIncident(const std::string& message, const nlohmann::json& details, const std::string& error_code,
+                               const std::string& failure_type, const std::string& failure_code,
+                               LoggingService* logger) {
+    // Ensure error_code is included in the details JSON
+    nlohmann::json detailsWithCode = details;
+    detailsWithCode["error_code"] = error_code;
+    enqueue({DbWriteRequest::Type::Incident, message, detailsWithCode.dump(), error_code, failure_type, failure_code,
+             logger});
+}
+
+void DbWriter::enqueueVideoArchivalStatus(const std::string& filePath, const std::string& ddsFilePath,
+                                          LoggingService* logger) {
+    enqueue({DbWriteRequest::Type::VideoArchivalStatus, filePath, ddsFilePath, "", "", "", logger});
+}
+
+void DbWriter::enqueueParquetArchivalStatus(const std::string& filePath, const std::string& ddsFilePath,
+                                            LoggingService* logger) {
+    enqueue({DbWriteRequest::Type::ParquetArchivalStatus, filePath, ddsFilePath, "", "", "", logger});
+}
+
+void DbWriter::enqueue(DbWriteRequest request) {
+    enqueuedCount.fetch_add(1);
+    const bool archival = request.type != DbWriteRequest::Type::Incident;
+    const std::string filePath = archival ? request.key : std::string();
+    if (archival) trackArchivalStatus(filePath);
+    if (!queue.push(std::move(request))) {
+        if (archival) untrackArchivalStatus(filePath);
+        // Writer already shut down: count the write as completed so flush() cannot hang.
+        std::cerr << "DB writer stopped, dropping write" << std::endl;
+        std::lock_guard<std::mutex> lock(completedMutex);
+        ++completedCount;
+        completedCv.notify_all();
+    }
+}
+
+void DbWriter::flush() {
+    const std::uint64_t target = enqueuedCount.load();
+    std::unique_lock<std::mutex> lock(completedMutex);
+    completedCv.wait(lock, [this, target] { return completedCount >= target; });
+}
+
+void DbWriter::shutdown() {
+    std::lock_guard<std::mutex> lock(shutdownMutex);
+    if (stopped) return;
+    stopped = true;
+    queue.close();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+std::size_t DbWriter::pendingWrites() const {
+    return queue.size();
+}
+
+void DbWriter::setDefaultLogger(LoggingService* logger) {
+    defaultLogger.store(logger);
+}
+
+LoggingService* DbWriter::loggerFor(const DbWriteRequest& request) const {
+    return request.logger ? request.logger : defaultLogger.load();
+}
+
+void DbWriter::trackArchivalStatus(const std::string& filePath) {
+    std::lock_guard<std::mutex> lock(inFlightMutex);
+    ++inFlightArchival[filePath];
+}
+
+void DbWriter::untrackArchivalStatus(const std::string& filePath) {
+    std::lock_guard<std::mutex> lock(inFlightMutex);
+    auto it = inFlightArchival.find(filePath);
+    if (it != inFlightArchival.end() && --it->second == 0) {
+        inFlightArchival.erase(it);
+    }
+}
+
+bool DbWriter::hasPendingArchivalStatus(const std::string& filePath) const {
+    {
+        std::lock_guard<std::mutex> lock(inFlightMutex);
+        if (inFlightArchival.count(filePath)) {
+            return true;
+        }
+    }
+    return spool->hasPendingArchivalStatus(filePath);
+}
+
+std::size_t DbWriter::spooledWrites() const {
+    return spool->size();
+}
+
+// Writer loop: drains up to batchSize writes per wake-up until closed and empty.
+void DbWriter::run() {
+    std::vector<DbWriteRequest> batch;
+    batch.reserve(batchSize);
+
+    while (true) {
+        batch.clear();
+        std::size_t count = queue.popBatch(batch, batchSize, std::chrono::milliseconds(500));
+        if (count == 0) {
+            if (queue.isClosed() && queue.size() == 0) break;
+            replaySpool();
+            continue;
+        }
+
+        applyBatch(batch);
+        // Committed or spooled by now; the spool answers for the latter
+        for (const auto& request : batch) {
+            if (request.type != DbWriteRequest::Type::Incident) untrackArchivalStatus(request.key);
+        }
+
+        std::lock_guard<std::mutex> lock(completedMutex);
+        completedCount += count;
+        completedCv.notify_all();
+    }
+}
+
+// Applies one batch. Repeated incidents within the batch collapse into a single
+// insert. While earlier writes are still spooled, or if Postgres is unreachable,
+// the batch is appended to the spool instead so ordering is preserved.
+void DbWriter::applyBatch(std::vector<DbWriteRequest>& batch) {
+    std::vector<const DbWriteRequest*> writes;
+    std::unordered_set<std::string> incidentsInBatch;
+    for (const auto& request : batch) {
+        if (request.type == DbWriteRequest::Type::Incident && !incidentsInBatch.insert(request.key).second) {
+            continue;
+        }
+        writes.push_back(&request);
+    }
+
+    if (!replaySpool() || !applyWrites(writes)) {
+        spoolWrites(writes);
+    }
+}
+
+// Runs the writes in a single transaction on a pooled connection. If a statement
+// fails the writes are retried one by one so a bad row cannot drop the rest.
+// Returns false when the database is unreachable.
+bool DbWriter::applyWrites(const std::vector<const DbWriteRequest*>& writes) {
+    try {
+        auto lease = ConnectionPool::getInstance().acquire();
+        try {
+            pqxx::work txn(*lease);
+            for (const auto* request : writes) {
+                applyWrite(txn, *request);
+            }
+            txn.commit();
+            return true;
+        } catch (const pqxx::broken_connection& e) {
+            lease.invalidate();
+            return false;
+        } catch (const std::exception& e) {
+            std::cerr << "Batch write failed, retrying individually: " << e.what() << std::endl;
+        }
+
+        for (const auto* request : writes) {
+            try {
+                pqxx::work txn(*lease);
+                applyWrite(txn, *request);
+                txn.commit();
+            } catch (const pqxx::broken_connection& e) {
+                // Writes already committed here are idempotent when replayed from the spool
+                lease.invalidate();
+                return false;
+            } catch (const std::exception& e) {
+                reportFailure(*request, e.what());
+                if (request->type != DbWriteRequest::Type::Incident) {
+                    recordArchivalFailureIncident(*lease, *request, e.what());
+                }
+            }
+        }
+        return true;
+    } catch (const std::exception& e) {
+        std::cerr << "Database unavailable: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+void DbWriter::spoolWrites(const std::vector<const DbWriteRequest*>& writes) {
+    if (spool->append(writes)) {
+        if (auto* log = defaultLogger.load()) {
+            log->warning("Database unavailable, spooled pending writes",
+                         createLogInfo({{"writes", writes.size()}, {"spool", spool->getPath()}}),
+                         "DB_SPOOL_APPEND");
+        }
+        return;
+    }
+
+    for (const auto* request : writes) {
+        reportFailure(*request, "database unavailable and spool not writable");
+    }
+}
+
+// Bulk-applies spooled writes once the database is reachable again. Attempts are
+// spaced by spoolReplayInterval. Returns true when the spool is empty afterwards.
+bool DbWriter::replaySpool() {
+    if (spool->empty()) {
+        return true;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    if (now < nextReplayAttempt) {
+        return false;
+    }
+
+    auto spooled = spool->readAll();
+    std::vector<const DbWriteRequest*> writes;
+    writes.reserve(spooled.size());
+    for (const auto& request : spooled) {
+        writes.push_back(&request);
+    }
+
+    if (!applyWrites(writes)) {
+        nextReplayAttempt = now + spoolReplayInterval;
+        return false;
+    }
+
+    spool->clear();
+    std::cout << "Replayed " << writes.size() << " spooled DB writes" << std::endl;
+    if (auto* log = defaultLogger.load()) {
+        log->info("Replayed spooled DB writes", createLogInfo({{"writes", writes.size()}}), "DB_SPOOL_REPLAY");
+    }
+    return true;
+}
+
+void DbWriter::applyWrite(pqxx::work& txn, const DbWriteRequest& request) {
+    if (request.type == DbWriteRequest::Type::Incident) {
+        applyIncident(txn, request);
+    } else {
+        applyArchivalStatus(txn, request);
+    }
+}
+
+void DbWriter::applyIncident(pqxx::work& txn, const DbWriteRequest& request) {
+    // Check if the most recent incident with this message is still active (no recovery attempts or failed recovery)
+    std::ostringstream checkQuery;
+    checkQuery << "SELECT i.id FROM incident i "
+              << "LEFT JOIN recovery r ON i.id = r.incident_id "
+              << "WHERE i.incident_message = " << txn.quote(request.key) << " "
+              << "AND i.process_name = 'EFMS' "
+              << "AND (r.id IS NULL OR r.recovery_status = 'FAILED') "
+              << "ORDER BY i.incident_time DESC LIMIT 1";
+
+    auto result = txn.exec(checkQuery.str());
+
+    // If no active incident exists, insert a new one
+    if (result.empty()) {
+        std::ostringstream insertQuery;
+        insertQuery << "INSERT INTO incident (process_name, incident_message, incident_time, incident_details) "
+                   << "VALUES ('EFMS', " << txn.quote(request.key) << ", NOW(), " << txn.quote(request.value) << ") "
+                   << "RETURNING id";
+
+        auto inserted = txn.exec(insertQuery.str());
+        int lastInsertId = inserted.empty() ? 0 : inserted[0][0].as<int>();
+        EFMS_DEBUG("Inserted incident with ID: " << lastInsertId << " for error code: " << request.errorCode);
+    } else {
+        EFMS_DEBUG("Skipped duplicate incident: " << request.key << " (already active or no successful recovery)");
+    }
+}
+
+void DbWriter::applyArchivalStatus(pqxx::work& txn, const DbWriteRequest& request) {
+    std::string query;
+    if (request.type == DbWriteRequest::Type::VideoArchivalStatus) {
+        query = "UPDATE analytics SET dds_video_file_location = " + txn.quote(request.value) +
+                " WHERE video_file_location = " + txn.quote(request.key);
+    } else {
+        query = "UPDATE analytics SET dds_parquet_file_location = " + txn.quote(request.value) +
+                " WHERE parquet_file_location = " + txn.quote(request.key);
+    }
+    txn.exec(query);
+}
+
+// The connection is still usable, so the 05008 incident can be recorded alongside the log entry.
+void DbWriter::recordArchivalFailureIncident(pqxx::connection& connection, const DbWriteRequest& request, const std::string& error) {
+    nlohmann::json details = createLogInfo({{"error", error}, {"file", request.key}});
+    details["error_code"] = "05008";
+    try {
+        pqxx::work txn(connection);
+        applyIncident(txn, {DbWriteRequest::Type::Incident, "Failed to update archival status", details.dump(), "05008"});
+        txn.commit();
+    } catch (const std::exception& e) {
+        std::cerr << "Database Operation Failed: " << e.what() << std::endl;
+    }
+}
+
+void DbWriter::reportFailure(const DbWriteRequest& request, const std::string& error) {
+    LoggingService* log = loggerFor(request);
+    if (request.type == DbWriteRequest::Type::Incident) {
+        std::cerr << "Database Operation Failed: " << error << std::endl;
+        if (log) {
+            log->error("Database Operation Failed", {{"error", error}},
+                       request.failureType.empty() ? "DB_OPERATION_FAIL" : request.failureType, true,
+                       request.failureCode.empty() ? "05003" : request.failureCode);
+        }
+        return;
+    }
+
+    std::cerr << "Failed to update archival status: " << error << std::endl;
+    if (log) {
+        log->error("Failed to update archival status", createLogInfo({{"error", error}, {"file", request.key}}),
+                   "ARCHIVE_UPDATE_FAIL", true, "05008");
+    }
+}
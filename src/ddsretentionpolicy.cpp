@@ -1,9 +1,9 @@
 #include "ddsretentionpolicy.hpp"
+#include "configservice.hpp"
 #include <ctime>
 #include <filesystem>
 #include <unordered_map>
 #include <nlohmann/json.hpp>
-#include <fstream>
 #include <iostream>
 
 // Remove const from declarations in header file and initialize from config
@@ -32,14 +32,13 @@ static bool config_loaded = false;
 void ddsretentionpolicy::loadConfig() {
     if (config_loaded) return;
     
-    std::ifstream configFile("config.json");
-    if (!configFile.is_open()) {
-        throw std::runtime_error("DDS Retention - Failed to open config.json");
+    auto snapshot = ConfigService::getInstance().current();
+    if (!snapshot->isLoaded()) {
+        throw std::runtime_error("DDS Retention - Failed to load config.json: " + snapshot->error());
     }
     
     try {
-        nlohmann::json config;
-        configFile >> config;
+        nlohmann::json config = snapshot->json();
         
         auto ddsConfig = config["dds_retention_policy"];
         
@@ -112,8 +111,6 @@ void ddsretentionpolicy::loadConfig() {
     } catch (const nlohmann::json::exception& e) {
         throw std::runtime_error("Failed to parse config.json: " + std::string(e.what()));
     }
-    
-    configFile.close();
 }
 
 ddsretentionpolicy::ddsretentionpolicy() {
@@ -138,6 +135,18 @@ std::string ddsretentionpolicy::getLogDirectory() {
     return logDir;
 }
 
+namespace {
+    // {"mp4", "avi"} -> "mp4,avi"
+    std::string joinFileTypes(const std::vector<std::string>& fileTypes) {
+        std::string joined;
+        for (const auto& fileType : fileTypes) {
+            if (!joined.empty()) joined += ',';
+            joined += fileType;
+        }
+        return joined;
+    }
+}
+
 std::unordered_map<std::string, std::unordered_map<std::string, std::string>> ddsretentionpolicy::to_dict() const {
     std::unordered_map<std::string, std::unordered_map<std::string, std::string>> result;
 
@@ -151,17 +160,20 @@ std::unordered_map<std::string, std::unordered_map<std::string, std::string>> dd
     result["DIAGNOSTIC_RETENTION_POLICY_PATH"] = {
         {"value", DIAGNOSTIC_RETENTION_POLICY.path},
         {"retentionPeriod", std::to_string(DIAGNOSTIC_RETENTION_POLICY.retentionPeriod)},
-        {"enabled", DIAGNOSTIC_RETENTION_POLICY.enabled ? "True" : "False"}
+        {"enabled", DIAGNOSTIC_RETENTION_POLICY.enabled ? "True" : "False"},
+        {"fileTypes", joinFileTypes(DIAGNOSTIC_RETENTION_POLICY.fileExtensions)}
     };
     result["LOG_RETENTION_POLICY_PATH"] = {
         {"value", LOG_RETENTION_POLICY.path},
         {"retentionPeriod", std::to_string(LOG_RETENTION_POLICY.retentionPeriod)},
-        {"enabled", LOG_RETENTION_POLICY.enabled ? "True" : "False"}
+        {"enabled", LOG_RETENTION_POLICY.enabled ? "True" : "False"},
+        {"fileTypes", joinFileTypes(LOG_RETENTION_POLICY.fileExtensions)}
     };
     result["VIDEO_CLIPS_RETENTION_POLICY_PATH"] = {
         {"value", VIDEO_CLIPS_RETENTION_POLICY.path},
         {"retentionPeriod", std::to_string(VIDEO_CLIPS_RETENTION_POLICY.retentionPeriod)},
-        {"enabled", VIDEO_CLIPS_RETENTION_POLICY.enabled ? "True" : "False"}
+        {"enabled", VIDEO_CLIPS_RETENTION_POLICY.enabled ? "True" : "False"},
+        {"fileTypes", joinFileTypes(VIDEO_CLIPS_RETENTION_POLICY.fileExtensions)}
     };
 
     result["LOG_DIRECTORY"] = {{"value", LOG_DIRECTORY}};
@@ -174,14 +186,16 @@ std::unordered_map<std::string, std::unordered_map<std::string, std::string>> dd
         result["VIDEO_RETENTION_POLICY_" + station] = {
             {"value", policy.path},
             {"retentionPeriod", std::to_string(policy.retentionPeriod)},
-            {"enabled", policy.enabled ? "True" : "False"}
+            {"enabled", policy.enabled ? "True" : "False"},
+            {"fileTypes", joinFileTypes(policy.fileExtensions)}
         };
     }
     for (const auto& [station, policy] : ANALYSIS_STATION_POLICIES) {
         result["ANALYSIS_RETENTION_POLICY_" + station] = {
             {"value", policy.path},
             {"retentionPeriod", std::to_string(policy.retentionPeriod)},
-            {"enabled", policy.enabled ? "True" : "False"}
+            {"enabled", policy.enabled ? "True" : "False"},
+            {"fileTypes", joinFileTypes(policy.fileExtensions)}
         };
     }
 
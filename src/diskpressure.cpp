@@ -0,0 +1,62 @@
+#include "diskpressure.hpp"
+#include <cstdint>
+#include <exception>
+#include <tuple>
+
+DiskPressureMonitor::DiskPressureMonitor(std::chrono::steady_clock::duration retriggerAfter)
+    : retriggerAfter(retriggerAfter) {}
+
+void DiskPressureMonitor::addVolume(const std::string& name, const std::string& path, int thresholdPercent,
+                                    Handler handler) {
+    Volume volume;
+    volume.name = name;
+    volume.path = path;
+    volume.thresholdPercent = thresholdPercent;
+    volume.handler = std::move(handler);
+    volumes.push_back(std::move(volume));
+}
+
+void DiskPressureMonitor::setThreshold(const std::string& name, int thresholdPercent) {
+    for (auto& volume : volumes) {
+        if (volume.name == name) {
+            volume.thresholdPercent = thresholdPercent;
+        }
+    }
+}
+
+std::size_t DiskPressureMonitor::sample(std::chrono::steady_clock::time_point now) {
+    std::size_t reported = 0;
+    for (auto& volume : volumes) {
+        double used = utilization(volume.path);
+        if (used < 0 || used <= volume.thresholdPercent) {
+            volume.overThreshold = false;
+            continue;
+        }
+        // Report on the crossing, then only as a reminder while eviction has not caught up
+        if (!volume.overThreshold || now - volume.lastReported >= retriggerAfter) {
+            volume.overThreshold = true;
+            volume.lastReported = now;
+            ++reported;
+            volume.handler(volume.name, used);
+        }
+    }
+    return reported;
+}
+
+double DiskPressureMonitor::utilization(const std::string& path) {
+    FileService fileService;
+    try {
+        return utilization(fileService, path);
+    } catch (const std::exception& e) {
+        return -1.0;
+    }
+}
+
+double DiskPressureMonitor::utilization(FileService& fileService, const std::string& path) {
+    auto details = fileService.get_memory_details(path);
+    std::uint64_t total = std::get<0>(details);
+    if (total == 0) {
+        return -1.0;
+    }
+    return static_cast<double>(std::get<1>(details)) / static_cast<double>(total) * 100.0;
+}
@@ -0,0 +1,203 @@
+#include "iopressure.hpp"
+#include "configservice.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+
+namespace {
+    // Longest a paused coordinator waits before looking at its token again
+    constexpr auto CANCEL_POLL = std::chrono::milliseconds(100);
+
+    bool readNumber(const nlohmann::json& section, const char* key, double min, double max, double& value,
+                    std::string& problem) {
+        if (!section.contains(key)) return true;
+        const auto& number = section[key];
+        if (!number.is_number() || number.get<double>() < min || number.get<double>() > max) {
+            std::ostringstream message;
+            message << key << " must be a number in [" << min << ", " << max << "]";
+            problem = message.str();
+            return false;
+        }
+        value = number.get<double>();
+        return true;
+    }
+}
+
+const char* pressureLevelName(PressureLevel level) {
+    switch (level) {
+        case PressureLevel::Clear: return "clear";
+        case PressureLevel::Slowed: return "slowed";
+        case PressureLevel::Paused: return "paused";
+    }
+    return "unknown";
+}
+
+PressureThrottle& PressureThrottle::getInstance() {
+    static PressureThrottle instance;
+    return instance;
+}
+
+void PressureThrottle::setLevel(PressureLevel level) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        current = level;
+    }
+    changed.notify_all();
+}
+
+PressureLevel PressureThrottle::level() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return current;
+}
+
+void PressureThrottle::setLimits(std::chrono::milliseconds delay, int bandwidthKb) {
+    std::lock_guard<std::mutex> lock(mutex);
+    slowDelay = delay;
+    slowBandwidthKb = bandwidthKb;
+}
+
+bool PressureThrottle::pace(const CancellationToken& token) {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (current == PressureLevel::Paused) {
+        if (token.isCancelled()) return false;
+        changed.wait_for(lock, CANCEL_POLL);
+    }
+    if (current == PressureLevel::Slowed) {
+        // Woken early if pressure clears; a renewed pause is caught at the next file
+        const auto until = std::chrono::steady_clock::now() + slowDelay;
+        while (current == PressureLevel::Slowed && std::chrono::steady_clock::now() < until) {
+            if (token.isCancelled()) return false;
+            changed.wait_until(lock, std::min(until, std::chrono::steady_clock::now() + CANCEL_POLL));
+        }
+    }
+    return !token.isCancelled();
+}
+
+int PressureThrottle::bandwidthKb(int limitKb) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    // Copies already running when a pause starts slow down rather than hold a pool worker
+    if (current == PressureLevel::Clear || slowBandwidthKb <= 0) {
+        return limitKb;
+    }
+    return limitKb > 0 ? std::min(limitKb, slowBandwidthKb) : slowBandwidthKb;
+}
+
+PsiMonitor::Settings PsiMonitor::configured() {
+    Settings settings;
+    try {
+        const auto& section = ConfigService::getInstance().current()->section("io_pressure");
+        Settings parsed;
+        // Validated on load; a bad section keeps the defaults, which leave the monitor off
+        if (section.is_object() && parseSettings(section, parsed).empty()) {
+            settings = parsed;
+        }
+    } catch (const nlohmann::json::exception& e) {
+        // Keep defaults
+    }
+    return settings;
+}
+
+std::string PsiMonitor::parseSettings(const nlohmann::json& section, Settings& settings) {
+    if (!section.is_object()) {
+        return "must be an object";
+    }
+    if (section.contains("enabled")) {
+        if (!section["enabled"].is_boolean()) return "enabled must be a boolean";
+        settings.enabled = section["enabled"].get<bool>();
+    }
+    if (section.contains("sources")) {
+        const auto& sources = section["sources"];
+        if (!sources.is_array()) return "sources must be an array of paths";
+        settings.sources.clear();
+        for (const auto& source : sources) {
+            if (!source.is_string() || source.get<std::string>().empty()) return "sources must be an array of paths";
+            settings.sources.push_back(source.get<std::string>());
+        }
+    }
+
+    std::string problem;
+    double sampleSeconds = settings.sampleSeconds;
+    double slowDelay = static_cast<double>(settings.slowDelay.count());
+    double slowBandwidth = settings.slowBandwidthKb;
+    Thresholds& thresholds = settings.thresholds;
+    if (!readNumber(section, "sample_interval_seconds", 1, 3600, sampleSeconds, problem) ||
+        !readNumber(section, "slow_above", 0, 100, thresholds.slowAbove, problem) ||
+        !readNumber(section, "pause_above", 0, 100, thresholds.pauseAbove, problem) ||
+        !readNumber(section, "resume_below", 0, 100, thresholds.resumeBelow, problem) ||
+        !readNumber(section, "slow_delay_ms", 0, 60000, slowDelay, problem) ||
+        !readNumber(section, "slow_bandwidth_kb", 0, 1 << 30, slowBandwidth, problem)) {
+        return problem;
+    }
+    if (thresholds.resumeBelow > thresholds.slowAbove || thresholds.slowAbove > thresholds.pauseAbove) {
+        return "thresholds must satisfy resume_below <= slow_above <= pause_above";
+    }
+    settings.sampleSeconds = static_cast<int>(sampleSeconds);
+    settings.slowDelay = std::chrono::milliseconds(static_cast<std::int64_t>(slowDelay));
+    settings.slowBandwidthKb = static_cast<int>(slowBandwidth);
+    return "";
+}
+
+PsiMonitor::PsiMonitor(std::vector<std::string> sources, const Thresholds& thresholds, PressureThrottle& throttle,
+                       Handler handler)
+    : sources(std::move(sources)), thresholds(thresholds), throttle(throttle), handler(std::move(handler)) {}
+
+void PsiMonitor::setThresholds(const Thresholds& updated) {
+    thresholds = updated;
+}
+
+double PsiMonitor::sample() {
+    double stall = -1.0;
+    for (const auto& source : sources) {
+        stall = std::max(stall, readStall(source));
+    }
+    PressureLevel previous = throttle.level();
+    PressureLevel level = nextLevel(previous, stall, thresholds);
+    if (level != previous) {
+        throttle.setLevel(level);
+        if (handler) {
+            handler(level, stall);
+        }
+    }
+    return stall;
+}
+
+double PsiMonitor::readStall(const std::string& path) {
+    // some avg10=1.23 avg60=0.50 avg300=0.10 total=123456
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream fields(line);
+        std::string kind;
+        std::string field;
+        if (!(fields >> kind >> field) || kind != "some" || field.rfind("avg10=", 0) != 0) {
+            continue;
+        }
+        try {
+            return std::stod(field.substr(6));
+        } catch (const std::exception& e) {
+            return -1.0;
+        }
+    }
+    return -1.0;
+}
+
+PressureLevel PsiMonitor::nextLevel(PressureLevel current, double stall, const Thresholds& thresholds) {
+    if (stall < 0) {
+        // Nothing to go by; never hold the pipelines back on a missing file
+        return PressureLevel::Clear;
+    }
+    if (stall >= thresholds.pauseAbove) {
+        return PressureLevel::Paused;
+    }
+    if (stall < thresholds.resumeBelow) {
+        return PressureLevel::Clear;
+    }
+    if (current == PressureLevel::Paused) {
+        return stall < thresholds.slowAbove ? PressureLevel::Slowed : PressureLevel::Paused;
+    }
+    if (current == PressureLevel::Slowed || stall >= thresholds.slowAbove) {
+        return PressureLevel::Slowed;
+    }
+    return PressureLevel::Clear;
+}
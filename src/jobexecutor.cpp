@@ -0,0 +1,200 @@
+#include "jobexecutor.hpp"
+#include "configservice.hpp"
+#include <iostream>
+#include <stdexcept>
+#include <nlohmann/json.hpp>
+
+namespace {
+    // Reads scheduler.io_concurrency from the config snapshot.
+    std::size_t loadIoConcurrency() {
+        int concurrency = 2;  // Default value
+        try {
+            concurrency = ConfigService::getInstance().current()->section("scheduler").value("io_concurrency", concurrency);
+        } catch (const nlohmann::json::exception& e) {
+            // Keep defaults
+        }
+        return concurrency < 1 ? 1 : static_cast<std::size_t>(concurrency);
+    }
+}
+
+JobExecutor::~JobExecutor() {
+    shutdown();
+}
+
+void JobExecutor::addJob(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (stopping || jobs.count(name)) return;
+
+    auto job = std::make_unique<Job>();
+    job->name = name;
+    Job& ref = *job;
+    jobs.emplace(name, std::move(job));
+    ref.worker = std::thread(&JobExecutor::work, this, std::ref(ref));
+}
+
+void JobExecutor::setFinishedListener(FinishedListener listener) {
+    std::lock_guard<std::mutex> lock(mutex);
+    finishedListener = std::move(listener);
+}
+
+bool JobExecutor::submit(const std::string& name, Task task, OverlapPolicy overlap) {
+    RunOptions options;
+    options.overlap = overlap;
+    return submit(name, [task = std::move(task)](const CancellationToken&) { task(); }, options);
+}
+
+bool JobExecutor::submit(const std::string& name, CancellableTask task, RunOptions options) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = jobs.find(name);
+    if (it == jobs.end()) {
+        throw std::invalid_argument("JobExecutor: unknown job " + name);
+    }
+    if (stopping) return false;
+
+    Job& job = *it->second;
+    if ((job.running || !job.queued.empty()) && options.overlap == OverlapPolicy::Skip) {
+        ++job.skipped;
+        return false;
+    }
+    // A queued run of the same kind covers this one; never drop a run of another kind
+    for (auto& queued : job.queued) {
+        if (queued.options.overlap == OverlapPolicy::Queue && queued.options.kind == options.kind) {
+            queued.task = std::move(task);
+            queued.options = options;
+            return true;
+        }
+    }
+    job.queued.push_back(QueuedRun{std::move(task), options});
+    changed.notify_all();
+    return true;
+}
+
+bool JobExecutor::preempt(const std::string& name, const std::string& reason) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = jobs.find(name);
+    if (it == jobs.end()) {
+        throw std::invalid_argument("JobExecutor: unknown job " + name);
+    }
+    Job& job = *it->second;
+    if (!job.running || !job.runningPreemptible) {
+        return false;
+    }
+    job.token.cancel(reason);
+    return true;
+}
+
+void JobExecutor::work(Job& job) {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        changed.wait(lock, [&] { return stopping || !job.queued.empty(); });
+        if (stopping) return;
+
+        QueuedRun next = std::move(job.queued.front());
+        job.queued.pop_front();
+        CancellableTask task = std::move(next.task);
+        job.running = true;
+        job.runningPreemptible = next.options.preemptible;
+        job.token = CancellationToken();
+        if (next.options.timeLimit > std::chrono::steady_clock::duration::zero()) {
+            job.token.setDeadline(std::chrono::steady_clock::now() + next.options.timeLimit);
+        }
+        CancellationToken token = job.token;
+        lock.unlock();
+
+        // A failed run must not take the worker (or the other jobs) down with it
+        try {
+            task(token);
+        } catch (const std::exception& e) {
+            std::cerr << "Job " << job.name << " failed: " << e.what() << std::endl;
+        }
+
+        lock.lock();
+        job.running = false;
+        ++job.completed;
+        changed.notify_all();
+        if (finishedListener) {
+            FinishedListener listener = finishedListener;
+            lock.unlock();
+            listener(job.name);
+            lock.lock();
+        }
+    }
+}
+
+const JobExecutor::Job& JobExecutor::find(const std::string& name) const {
+    auto it = jobs.find(name);
+    if (it == jobs.end()) {
+        throw std::invalid_argument("JobExecutor: unknown job " + name);
+    }
+    return *it->second;
+}
+
+bool JobExecutor::isRunning(const std::string& name) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    const Job& job = find(name);
+    return job.running || !job.queued.empty();
+}
+
+std::uint64_t JobExecutor::completedRuns(const std::string& name) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return find(name).completed;
+}
+
+std::uint64_t JobExecutor::skippedRuns(const std::string& name) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return find(name).skipped;
+}
+
+void JobExecutor::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        for (auto& entry : jobs) {
+            entry.second->queued.clear();
+            if (entry.second->running) {
+                entry.second->token.cancel("shutdown");
+            }
+        }
+        changed.notify_all();
+    }
+    // Jobs are only added while not stopping, so the map is stable here
+    for (auto& entry : jobs) {
+        if (entry.second->worker.joinable()) {
+            entry.second->worker.join();
+        }
+    }
+}
+
+IoBudget& IoBudget::getInstance() {
+    static IoBudget instance(loadIoConcurrency());
+    return instance;
+}
+
+IoBudget::IoBudget(std::size_t slots) : slots(slots == 0 ? 1 : slots) {}
+
+std::size_t IoBudget::inUse() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return used;
+}
+
+void IoBudget::acquire() {
+    std::unique_lock<std::mutex> lock(mutex);
+    available.wait(lock, [this] { return used < slots; });
+    ++used;
+}
+
+void IoBudget::release() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        --used;
+    }
+    available.notify_one();
+}
+
+IoBudget::Permit::Permit(IoBudget& budget) : budget(budget) {
+    budget.acquire();
+}
+
+IoBudget::Permit::~Permit() {
+    budget.release();
+}
@@ -0,0 +1,40 @@
+#include "loglevel.hpp"
+#include "configservice.hpp"
+#include <nlohmann/json.hpp>
+
+namespace {
+    // Reads logging.level from the config snapshot; defaults to info.
+    LogLevel loadRuntimeLogLevel() {
+        LogLevel level = LogLevel::Info;
+        auto snapshot = ConfigService::getInstance().current();
+        try {
+            parseLogLevel(snapshot->section("logging").value("level", std::string("info")), level);
+        } catch (const nlohmann::json::exception& e) {
+            // Keep default
+        }
+        return level;
+    }
+}
+
+std::atomic<int>& runtimeLogLevelStorage() {
+    static std::atomic<int> level{static_cast<int>(loadRuntimeLogLevel())};
+    return level;
+}
+
+bool parseLogLevel(const std::string& name, LogLevel& level) {
+    static const std::pair<const char*, LogLevel> names[] = {
+        {"trace", LogLevel::Trace},
+        {"debug", LogLevel::Debug},
+        {"info", LogLevel::Info},
+        {"warning", LogLevel::Warning},
+        {"error", LogLevel::Error},
+        {"off", LogLevel::Off}
+    };
+    for (const auto& [candidate, value] : names) {
+        if (name == candidate) {
+            level = value;
+            return true;
+        }
+    }
+    return false;
+}
@@ -1,6 +1,7 @@
 #include <sys/prctl.h>
 #include <unistd.h>
 #include <cstring>
+#include <algorithm>
 #include <chrono>
 #include <iostream>
 #include "ddsretentionpolicy.hpp"
@@ -8,15 +9,39 @@
 #include "archivalcontroller.hpp"
 #include "retentioncontroller.hpp"
 #include "logutils.hpp"
-#include <thread>
+#include "schemamigrator.hpp"
+#include "archivalnotifier.hpp"
+#include "configservice.hpp"
+#include "loglevel.hpp"
+#include "reactor.hpp"
+#include "jobexecutor.hpp"
+#include "diskpressure.hpp"
+#include "iopressure.hpp"
+#include "adaptiveinterval.hpp"
+#include "archivalscope.hpp"
+#include "schedulerstate.hpp"
+#include "dbwriter.hpp"
+#include "asynclogger.hpp"
+#include "binarylog.hpp"
+#include <csignal>
 #include <nlohmann/json.hpp>
-#include <fstream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
 
 class JobScheduler {
 private:
+    // Blocks the handled signals before any other thread starts, so they are
+    // only ever delivered through the reactor
+    SignalSource signals{SIGTERM, SIGINT, SIGHUP, SIGUSR1};
+
     // Policy and controller objects
     vecowretentionpolicy vecow_retention_policy;
     ddsretentionpolicy dds_retention_policy;
+
+    // Categories with their own archival.categories entry; the rest stay with archival_controller
+    std::vector<ArchivalScope> category_scopes;
     
     // Controllers
     ArchivalController archival_controller;
@@ -29,36 +54,524 @@ private:
     // Configuration values
     int archival_interval_minutes;
     int retention_interval_minutes;
-    int poll_interval_seconds;
+    int max_run_minutes;
+    bool run_schema_migrations;
+    bool listen_notify_enabled;
+    int notify_max_pending;
+    bool disk_pressure_enabled;
+    int disk_pressure_sample_seconds;
+    int disk_pressure_retrigger_seconds;
+    bool incremental_enabled;
+    int incremental_tick_seconds;
+
+    // Set when archival.listen_notify_enabled; feeds newly registered files between scans
+    std::unique_ptr<ArchivalNotifier> archival_notifier;
+
+    // Set when disk_pressure.enabled; starts eviction as soon as a volume crosses its threshold
+    std::unique_ptr<DiskPressureMonitor> pressure_monitor;
+
+    // Set when io_pressure.enabled; slows or pauses the normal pipelines while the node stalls on I/O or memory
+    std::unique_ptr<PsiMonitor> psi_monitor;
+    int psi_sample_seconds = 2;
     
+    // Config snapshot the values above were read from
+    std::uint64_t config_version = 0;
+
+    // Wakeup sources: one timer per job, config reloads and notified files
+    Reactor reactor;
+    DeadlineTimer archival_timer;
+    DeadlineTimer retention_timer;
+    WakeupEvent config_changed;
+    WakeupEvent files_notified;
+    DeadlineTimer pressure_timer;
+    DeadlineTimer psi_timer;
+    WakeupEvent archival_finished;
+    WakeupEvent job_finished;
+
+    // Archival interval adapted to the backlog each normal run leaves behind
+    AdaptiveInterval archival_interval{std::chrono::minutes(30), std::chrono::minutes(30), std::chrono::minutes(30)};
+    // Handed from the archival worker to the reactor thread
+    std::mutex backlog_mutex;
+    std::optional<ArchivalBacklog> archival_backlog;
+    // Jobs whose run just ended, likewise handed to the reactor thread
+    std::mutex finished_mutex;
+    std::vector<std::string> finished_jobs;
+
+    // Notified files waiting for one pipeline's job; its next "notified" run takes them all, so
+    // coalescing queued runs loses no files
+    struct NotifiedFiles {
+        std::mutex mutex;
+        std::vector<std::string> paths;
+
+        void add(std::string path) {
+            std::lock_guard<std::mutex> lock(mutex);
+            paths.push_back(std::move(path));
+        }
+        std::vector<std::string> take() {
+            std::lock_guard<std::mutex> lock(mutex);
+            std::vector<std::string> taken;
+            taken.swap(paths);
+            return taken;
+        }
+    };
+    // Notified files of the categories archival_controller owns
+    NotifiedFiles notified_files;
+
+    // A category's own archival pipeline: controller, job (named after its scope) and fixed-interval timer
+    struct CategoryPipeline {
+        NotifiedFiles notified;
+        std::unique_ptr<ArchivalController> controller;
+        DeadlineTimer timer;
+        std::chrono::steady_clock::time_point last_run;
+        int interval_minutes = 0;
+    };
+    std::vector<std::unique_ptr<CategoryPipeline>> category_pipelines;
+
+    // Runs each job on its own worker; declared last so workers are joined before the controllers go away
+    JobExecutor executor;
+
     void loadConfig() {
-        std::ifstream configFile("../configuration/config.json");
-        if (!configFile.is_open()) {
-            throw std::runtime_error("Main - Failed to open config.json");
+        auto snapshot = ConfigService::getInstance().current();
+        if (!snapshot->isLoaded()) {
+            throw std::runtime_error("Main - Failed to load config.json: " + snapshot->error());
         }
         
         try {
-            nlohmann::json config;
-            configFile >> config;
+            nlohmann::json config = snapshot->json();
             
             auto scheduler = config["scheduler"];
             archival_interval_minutes = scheduler["archival_interval_minutes"].get<int>();
+            // Without bounds the interval stays fixed
+            archival_interval = AdaptiveInterval(
+                std::chrono::minutes(archival_interval_minutes),
+                std::chrono::minutes(scheduler.value("archival_min_interval_minutes", archival_interval_minutes)),
+                std::chrono::minutes(scheduler.value("archival_max_interval_minutes", archival_interval_minutes)));
             retention_interval_minutes = scheduler["retention_interval_minutes"].get<int>();
-            poll_interval_seconds = scheduler["poll_interval_seconds"].get<int>();
+            max_run_minutes = scheduler.value("max_run_minutes", 0);
+            run_schema_migrations = config.value("database", nlohmann::json::object()).value("run_migrations", true);
+
+            auto archival = config.value("archival", nlohmann::json::object());
+            listen_notify_enabled = archival.value("listen_notify_enabled", false);
+            notify_max_pending = archival.value("notify_max_pending", 10000);
+
+            auto disk_pressure = config.value("disk_pressure", nlohmann::json::object());
+            disk_pressure_enabled = disk_pressure.value("enabled", true);
+            disk_pressure_sample_seconds = disk_pressure.value("sample_interval_seconds", 5);
+            disk_pressure_retrigger_seconds = disk_pressure.value("retrigger_seconds", 60);
+
+            auto incremental = config.value("incremental", nlohmann::json::object());
+            incremental_enabled = incremental.value("enabled", false);
+            incremental_tick_seconds = incremental.value("tick_seconds", 60);
             
         } catch (const nlohmann::json::exception& e) {
             throw std::runtime_error("Failed to parse config.json: " + std::string(e.what()));
         }
-        
-        configFile.close();
+        config_version = snapshot->version();
+    }
+
+    // Picks up scheduler intervals from a reloaded snapshot and moves the job deadlines to match.
+    void refreshConfig() {
+        auto snapshot = ConfigService::getInstance().current();
+        if (snapshot->version() == config_version) {
+            return;
+        }
+        config_version = snapshot->version();
+        const auto& scheduler = snapshot->section("scheduler");
+        archival_interval_minutes = scheduler.value("archival_interval_minutes", archival_interval_minutes);
+        archival_interval.setBounds(
+            std::chrono::minutes(archival_interval_minutes),
+            std::chrono::minutes(scheduler.value("archival_min_interval_minutes", archival_interval_minutes)),
+            std::chrono::minutes(scheduler.value("archival_max_interval_minutes", archival_interval_minutes)));
+        retention_interval_minutes = scheduler.value("retention_interval_minutes", retention_interval_minutes);
+        max_run_minutes = scheduler.value("max_run_minutes", max_run_minutes);
+        const auto& incremental = snapshot->section("incremental");
+        incremental_enabled = incremental.value("enabled", incremental_enabled);
+        incremental_tick_seconds = incremental.value("tick_seconds", incremental_tick_seconds);
+        std::cout << "Configuration version " << config_version << " applied" << std::endl;
+
+        if (pressure_monitor) {
+            pressure_monitor->setThreshold("mounted", snapshot->section("vecow_retention_policy")
+                .value("threshold_storage_utilization", static_cast<int>(vecowretentionpolicy::THRESHOLD_STORAGE_UTILIZATION)));
+            pressure_monitor->setThreshold("dds", snapshot->section("dds_retention_policy")
+                .value("threshold_storage_utilization", static_cast<int>(ddsretentionpolicy::THRESHOLD_STORAGE_UTILIZATION)));
+        }
+        if (psi_monitor) {
+            // Turning the monitor on or off and changing its sources needs a restart
+            PsiMonitor::Settings psi = PsiMonitor::configured();
+            psi_monitor->setThresholds(psi.thresholds);
+            PressureThrottle::getInstance().setLimits(psi.slowDelay, psi.slowBandwidthKb);
+            psi_sample_seconds = psi.sampleSeconds;
+        }
+
+        archival_timer.armAt(last_archival_run + archival_interval.current());
+        retention_timer.armAt(last_retention_run + std::chrono::minutes(retention_interval_minutes));
+
+        // Intervals apply on reload; adding or removing a category, or changing its concurrency or priority, needs a restart
+        for (const auto& scope : loadArchivalScopes()) {
+            for (auto& pipeline : category_pipelines) {
+                if (pipeline->controller->getScope().name == scope.name) {
+                    pipeline->interval_minutes = scope.intervalMinutes;
+                    pipeline->timer.armAt(pipeline->last_run + std::chrono::minutes(pipeline->interval_minutes));
+                }
+            }
+        }
+    }
+
+    // Next deadline on the job's fixed grid after now; runs that were missed are skipped, not queued.
+    static std::chrono::steady_clock::time_point nextDeadline(std::chrono::steady_clock::time_point scheduled,
+                                                              std::chrono::steady_clock::duration interval) {
+        auto now = std::chrono::steady_clock::now();
+        auto next = scheduled + interval;
+        if (next <= now) {
+            next += interval * ((now - next) / interval + 1);
+        }
+        return next;
+    }
+
+    // Persisted run times are wall-clock; the timers run on steady_clock
+    static std::chrono::system_clock::time_point toWallClock(std::chrono::steady_clock::time_point when) {
+        return std::chrono::system_clock::now() -
+               std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::steady_clock::now() - when);
+    }
+
+    // Where a job's schedule picks up after a restart: the last run recorded in the
+    // state file, so an overdue job runs at once, or now if it never ran. A job
+    // whose scan was interrupted is due immediately to finish the pass.
+    static std::chrono::steady_clock::time_point restoredLastRun(const std::string& job,
+                                                                 std::chrono::steady_clock::duration interval) {
+        auto& state = SchedulerState::getInstance();
+        auto now = std::chrono::steady_clock::now();
+        auto last = now;
+        if (auto saved = state.lastRun(job)) {
+            // A clock set back since the last run counts as no time elapsed
+            auto elapsed = std::max(std::chrono::system_clock::now() - *saved, std::chrono::system_clock::duration::zero());
+            last = now - std::chrono::duration_cast<std::chrono::steady_clock::duration>(elapsed);
+            std::cout << "Job " << job << " last ran "
+                      << std::chrono::duration_cast<std::chrono::seconds>(elapsed).count() << " s ago" << std::endl;
+        }
+        if (!state.cursor(job).empty()) {
+            std::cout << "Job " << job << " has an interrupted scan, resuming now" << std::endl;
+            last = std::min(last, now - interval);
+        }
+        return last;
+    }
+
+    static void recordRun(const std::string& job, std::chrono::steady_clock::time_point when) {
+        auto& state = SchedulerState::getInstance();
+        state.setLastRun(job, toWallClock(when));
+        state.save();
+    }
+
+    // True if the timer fired ahead of the job's slot on its grid, i.e. for the next slice of an
+    // incremental pass; the timer goes back to that slot and the grid stays where it was.
+    static bool continuationTick(DeadlineTimer& timer, std::chrono::steady_clock::time_point scheduled) {
+        if (scheduled <= std::chrono::steady_clock::now()) {
+            return false;
+        }
+        timer.armAt(scheduled);
+        return true;
+    }
+
+    RunOptions scheduledRun(bool preemptible) const {
+        RunOptions options;
+        options.preemptible = preemptible;
+        options.kind = "scheduled";
+        options.timeLimit = std::chrono::minutes(max_run_minutes);
+        return options;
+    }
+
+    // Scheduled runs are skipped while the previous run of the same job is still going.
+    // Archival is background work: urgent eviction may preempt it.
+    void runArchivalJob() {
+        bool submitted = executor.submit("archival", [this](const CancellationToken& token) {
+            std::cout << "Running Archival Job" << std::endl;
+            publishBacklog(archival_controller.applyArchivalPolicy(token));
+        }, scheduledRun(true));
+        if (!submitted) {
+            std::cout << "Archival Job still running, skipping this run" << std::endl;
+        }
+    }
+
+    // Category pipelines run on fixed intervals and, like the default one, give way to eviction.
+    void runCategoryJob(CategoryPipeline& pipeline) {
+        ArchivalController* controller = pipeline.controller.get();
+        const std::string& job = controller->getScope().name;
+        bool submitted = executor.submit(job, [controller, job](const CancellationToken& token) {
+            std::cout << "Running Archival Job (" << job << ")" << std::endl;
+            controller->applyArchivalPolicy(token);
+        }, scheduledRun(true));
+        if (!submitted) {
+            std::cout << "Archival Job (" << job << ") still running, skipping this run" << std::endl;
+        }
+    }
+
+    void runRetentionJob() {
+        bool submitted = executor.submit("retention", [this](const CancellationToken& token) {
+            std::cout << "Running Retention Job" << std::endl;
+            retention_controller.applyRetentionPolicy(token);
+        }, scheduledRun(false));
+        if (!submitted) {
+            std::cout << "Retention Job still running, skipping this run" << std::endl;
+        }
+    }
+
+    // Runs on the archival worker; the reactor picks the next archival deadline from it
+    void publishBacklog(const ArchivalBacklog& backlog) {
+        {
+            std::lock_guard<std::mutex> lock(backlog_mutex);
+            archival_backlog = backlog;
+        }
+        archival_finished.notify();
+    }
+
+    // Re-arms archival relative to the end of the run that just finished
+    void scheduleAfterArchival() {
+        std::optional<ArchivalBacklog> backlog;
+        {
+            std::lock_guard<std::mutex> lock(backlog_mutex);
+            backlog.swap(archival_backlog);
+        }
+        if (!backlog || backlog->eviction) {
+            return;
+        }
+        if (backlog->yielded) {
+            // Mid-pass: the next slice follows shortly, the interval applies once the pass is done
+            archival_timer.armAt(std::min(std::chrono::steady_clock::now() + std::chrono::seconds(incremental_tick_seconds),
+                                          last_archival_run + archival_interval.current()));
+            return;
+        }
+        auto interval = archival_interval.update(*backlog);
+        std::cout << "Archival backlog: " << backlog->copiedFiles << " copied, " << backlog->pendingFiles
+                  << " pending (" << backlog->pendingBytes << " bytes); next run in "
+                  << interval.count() << " s" << std::endl;
+        last_archival_run = std::chrono::steady_clock::now();
+        recordRun("archival", last_archival_run);
+        archival_timer.armAt(last_archival_run + interval);
+    }
+
+    // Stops every archival pipeline's run in progress at its next chunk
+    void preemptArchivalJobs(const std::string& reason) {
+        if (executor.preempt("archival", reason)) {
+            std::cout << "Preempted Archival Job: " << reason << std::endl;
+        }
+        for (const auto& pipeline : category_pipelines) {
+            const std::string& job = pipeline->controller->getScope().name;
+            if (executor.preempt(job, reason)) {
+                std::cout << "Preempted Archival Job (" << job << "): " << reason << std::endl;
+            }
+        }
+    }
+
+    // Runs on the job's worker after every run
+    void publishFinished(const std::string& job) {
+        {
+            std::lock_guard<std::mutex> lock(finished_mutex);
+            finished_jobs.push_back(job);
+        }
+        job_finished.notify();
+    }
+
+    // In incremental mode a pass left unfinished (budget spent, or cancelled) gets its next
+    // slice after incremental.tick_seconds instead of at the job's next slot. The default
+    // archival job is handled by scheduleAfterArchival.
+    void continueIncrementalPasses() {
+        std::vector<std::string> jobs;
+        {
+            std::lock_guard<std::mutex> lock(finished_mutex);
+            jobs.swap(finished_jobs);
+        }
+        if (!incremental_enabled) {
+            return;
+        }
+        auto tick = std::chrono::steady_clock::now() + std::chrono::seconds(incremental_tick_seconds);
+        for (const auto& job : jobs) {
+            if (SchedulerState::getInstance().cursor(job).empty()) {
+                continue;
+            }
+            if (job == "retention") {
+                retention_timer.armAt(std::min(tick, last_retention_run + std::chrono::minutes(retention_interval_minutes)));
+            }
+            for (auto& pipeline : category_pipelines) {
+                if (pipeline->controller->getScope().name == job) {
+                    pipeline->timer.armAt(std::min(tick, pipeline->last_run + std::chrono::minutes(pipeline->interval_minutes)));
+                }
+            }
+        }
+    }
+
+    // Eviction runs stop the background archival runs and go next in line; each
+    // pipeline evicts from its own categories' roots
+    void runUrgentArchivalJob(const std::string& reason) {
+        preemptArchivalJobs(reason);
+        RunOptions options;
+        options.overlap = OverlapPolicy::Queue;
+        options.kind = "eviction";
+        executor.submit("archival", [this](const CancellationToken& token) {
+            std::cout << "Running Archival Job (eviction)" << std::endl;
+            publishBacklog(archival_controller.applyArchivalPolicy(token));
+        }, options);
+        for (const auto& pipeline : category_pipelines) {
+            ArchivalController* controller = pipeline->controller.get();
+            executor.submit(controller->getScope().name, [controller](const CancellationToken& token) {
+                std::cout << "Running Archival Job (" << controller->getScope().name << ", eviction)" << std::endl;
+                controller->applyArchivalPolicy(token);
+            }, options);
+        }
+    }
+
+    void runUrgentRetentionJob(const std::string& reason) {
+        // Archival copies write to DDS; stop them while retention frees it
+        preemptArchivalJobs(reason);
+        RunOptions options;
+        options.overlap = OverlapPolicy::Queue;
+        options.kind = "eviction";
+        executor.submit("retention", [this](const CancellationToken& token) {
+            std::cout << "Running Retention Job (eviction)" << std::endl;
+            retention_controller.applyRetentionPolicy(token);
+        }, options);
+    }
+
+    // Notified files go to the job of the pipeline that owns their category, so they never
+    // race that pipeline's scan; a notification during a scan is queued behind it rather than dropped
+    void queueNotifiedFiles() {
+        auto notified_paths = archival_notifier->drain();
+        if (notified_paths.empty()) {
+            return;
+        }
+        bool for_default = false;
+        std::vector<CategoryPipeline*> for_categories;
+        for (auto& path : notified_paths) {
+            FileCategory category = classifyFile(path);
+            auto owner = std::find_if(category_pipelines.begin(), category_pipelines.end(),
+                                      [category](const auto& pipeline) {
+                                          return pipeline->controller->getScope().includes(category);
+                                      });
+            if (owner == category_pipelines.end()) {
+                notified_files.add(std::move(path));
+                for_default = true;
+            } else {
+                (*owner)->notified.add(std::move(path));
+                if (std::find(for_categories.begin(), for_categories.end(), owner->get()) == for_categories.end()) {
+                    for_categories.push_back(owner->get());
+                }
+            }
+        }
+
+        RunOptions options;
+        options.overlap = OverlapPolicy::Queue;
+        options.preemptible = true;
+        options.kind = "notified";
+        if (for_default) {
+            executor.submit("archival", [this](const CancellationToken& token) {
+                archiveNotifiedFiles(archival_controller, notified_files, token);
+            }, options);
+        }
+        for (CategoryPipeline* pipeline : for_categories) {
+            executor.submit(pipeline->controller->getScope().name, [pipeline](const CancellationToken& token) {
+                archiveNotifiedFiles(*pipeline->controller, pipeline->notified, token);
+            }, options);
+        }
+    }
+
+    // Archive files announced by the analytics trigger without waiting for the next scan
+    static void archiveNotifiedFiles(ArchivalController& controller, NotifiedFiles& notified,
+                                     const CancellationToken& token) {
+        auto notified_paths = notified.take();
+        if (!notified_paths.empty()) {
+            std::cout << "Archiving " << notified_paths.size() << " notified files (" << controller.getScope().name
+                      << ")" << std::endl;
+            controller.archiveFiles(notified_paths, token);
+        }
+    }
+
+    // A volume crossed its threshold between scheduled runs. The jobs pick the
+    // max-utilization pipeline themselves, so this only starts them early; the
+    // scheduled deadlines stay where they are.
+    void startPressureMonitor() {
+        pressure_monitor = std::make_unique<DiskPressureMonitor>(std::chrono::seconds(disk_pressure_retrigger_seconds));
+        pressure_monitor->addVolume("mounted", vecowretentionpolicy::MOUNTED_PATH,
+                                    static_cast<int>(vecowretentionpolicy::THRESHOLD_STORAGE_UTILIZATION),
+                                    [this](const std::string& volume, double utilization) {
+                                        std::cout << "Disk pressure on " << volume << " (" << utilization
+                                                  << "%), starting archival eviction" << std::endl;
+                                        runUrgentArchivalJob("disk pressure on " + volume);
+                                    });
+        pressure_monitor->addVolume("dds", ddsretentionpolicy::DDS_PATH,
+                                    static_cast<int>(ddsretentionpolicy::THRESHOLD_STORAGE_UTILIZATION),
+                                    [this](const std::string& volume, double utilization) {
+                                        std::cout << "Disk pressure on " << volume << " (" << utilization
+                                                  << "%), starting retention eviction" << std::endl;
+                                        runUrgentRetentionJob("disk pressure on " + volume);
+                                    });
+
+        reactor.add(pressure_timer.fd(), [this] {
+            if (pressure_timer.consume() == 0) return;
+            pressure_monitor->sample();
+            pressure_timer.armAt(std::chrono::steady_clock::now() + std::chrono::seconds(disk_pressure_sample_seconds));
+        });
+        pressure_timer.armAt(std::chrono::steady_clock::now() + std::chrono::seconds(disk_pressure_sample_seconds));
+    }
+
+    // Pressure stall information decides how hard the normal pipelines back
+    // off; runs in progress see a level change at their next file.
+    void startPsiMonitor(const PsiMonitor::Settings& settings) {
+        PressureThrottle& throttle = PressureThrottle::getInstance();
+        throttle.setLimits(settings.slowDelay, settings.slowBandwidthKb);
+        psi_sample_seconds = settings.sampleSeconds;
+        psi_monitor = std::make_unique<PsiMonitor>(settings.sources, settings.thresholds, throttle,
+                                                   [](PressureLevel level, double stall) {
+                                                       std::cout << "I/O pressure " << pressureLevelName(level)
+                                                                 << " (stall " << stall << "%)" << std::endl;
+                                                   });
+
+        reactor.add(psi_timer.fd(), [this] {
+            if (psi_timer.consume() == 0) return;
+            psi_monitor->sample();
+            psi_timer.armAt(std::chrono::steady_clock::now() + std::chrono::seconds(psi_sample_seconds));
+        });
+        psi_timer.armAt(std::chrono::steady_clock::now() + std::chrono::seconds(psi_sample_seconds));
+    }
+
+    void handleSignals() {
+        while (int signal = signals.next()) {
+            switch (signal) {
+                case SIGTERM:
+                case SIGINT:
+                    std::cout << "Shutdown requested (signal " << signal << ")" << std::endl;
+                    reactor.stop();
+                    break;
+                case SIGHUP:
+                    ConfigService::getInstance().reload();
+                    break;
+                case SIGUSR1:
+                    // External trigger: run both jobs now and restart their intervals from here
+                    last_archival_run = std::chrono::steady_clock::now();
+                    runArchivalJob();
+                    recordRun("archival", last_archival_run);
+                    last_retention_run = std::chrono::steady_clock::now();
+                    runRetentionJob();
+                    recordRun("retention", last_retention_run);
+                    archival_timer.armAt(last_archival_run + archival_interval.current());
+                    retention_timer.armAt(last_retention_run + std::chrono::minutes(retention_interval_minutes));
+                    for (auto& pipeline : category_pipelines) {
+                        pipeline->last_run = std::chrono::steady_clock::now();
+                        runCategoryJob(*pipeline);
+                        recordRun(pipeline->controller->getScope().name, pipeline->last_run);
+                        pipeline->timer.armAt(pipeline->last_run + std::chrono::minutes(pipeline->interval_minutes));
+                    }
+                    break;
+            }
+        }
     }
 
 public:
     JobScheduler() : 
+        category_scopes(loadArchivalScopes()),
         archival_controller(
             vecow_retention_policy.to_dict(),
             vecow_retention_policy.LOG_SOURCE,
-            vecow_retention_policy.LOG_FILE_PATH
+            vecow_retention_policy.LOG_FILE_PATH,
+            defaultArchivalScope(category_scopes)
         ),
         retention_controller(
             dds_retention_policy.to_dict(),
@@ -68,32 +581,139 @@ public:
         last_archival_run(std::chrono::steady_clock::now()),
         last_retention_run(std::chrono::steady_clock::now())
     {
+        // Spool and replay events, and replayed writes, belong to no controller; they go to the archival log
+        DbWriter::getInstance().setDefaultLogger(
+            LoggingService::getInstance(vecow_retention_policy.LOG_SOURCE, vecow_retention_policy.LOG_FILE_PATH));
         loadConfig();
+        executor.setFinishedListener([this](const std::string& job) { publishFinished(job); });
+        // Pick the schedule up where the previous process left it
+        last_archival_run = restoredLastRun("archival", archival_interval.current());
+        last_retention_run = restoredLastRun("retention", std::chrono::minutes(retention_interval_minutes));
+        executor.addJob("archival");
+        executor.addJob("retention");
+
+        // Each configured category gets its own pipeline instance, so a cheap category never waits behind a video walk
+        for (const auto& scope : category_scopes) {
+            auto pipeline = std::make_unique<CategoryPipeline>();
+            pipeline->controller = std::make_unique<ArchivalController>(
+                vecow_retention_policy.to_dict(), vecow_retention_policy.LOG_SOURCE,
+                vecow_retention_policy.LOG_FILE_PATH, scope);
+            pipeline->last_run = restoredLastRun(scope.name, std::chrono::minutes(scope.intervalMinutes));
+            pipeline->interval_minutes = scope.intervalMinutes;
+            executor.addJob(scope.name);
+            category_pipelines.push_back(std::move(pipeline));
+        }
+
+        // Retune on config.json edits without a restart; pipelines pick the snapshot up between directories
+        ConfigService::getInstance().addListener([this](const ConfigSnapshot& snapshot) {
+            LogLevel level;
+            if (parseLogLevel(snapshot.section("logging").value("level", std::string("info")), level)) {
+                setRuntimeLogLevel(level);
+            }
+            config_changed.notify();
+        });
+        ConfigService::getInstance().startWatching();
+
+        // Bring indexes for the hot analytics/incident lookups up to date on a job of their own,
+        // so a long index build never holds up startup or the eviction that disk pressure starts
+        if (run_schema_migrations) {
+            executor.addJob("schema");
+            executor.submit("schema", [this] {
+                SchemaMigrator migrator(LoggingService::getInstance(vecow_retention_policy.LOG_SOURCE,
+                                                                    vecow_retention_policy.LOG_FILE_PATH));
+                migrator.migrate();
+            });
+        }
+
+        if (listen_notify_enabled) {
+            archival_notifier = std::make_unique<ArchivalNotifier>(
+                LoggingService::getInstance(vecow_retention_policy.LOG_SOURCE, vecow_retention_policy.LOG_FILE_PATH),
+                static_cast<std::size_t>(notify_max_pending));
+            archival_notifier->setWakeup(&files_notified);
+            archival_notifier->start();
+        }
     }
 
+    // Sleeps in epoll until a job deadline, signal, config reload or notification arrives.
     void run() {
-        while (true) {
-            auto now = std::chrono::steady_clock::now();
-            
-            // Check if configured minutes have passed since last archival run
-            auto archival_duration = std::chrono::duration_cast<std::chrono::minutes>(now - last_archival_run);
-            if (archival_duration.count() >= archival_interval_minutes) {
-                std::cout << "Running Archival Job" << std::endl;
-                archival_controller.applyArchivalPolicy();
-                last_archival_run = now;
-            }
+        reactor.add(archival_timer.fd(), [this] {
+            if (archival_timer.consume() == 0) return;
+            auto scheduled = last_archival_run + archival_interval.current();
+            runArchivalJob();
+            if (continuationTick(archival_timer, scheduled)) return;
+            archival_timer.armAt(nextDeadline(scheduled, archival_interval.current()));
+            last_archival_run = scheduled;
+            recordRun("archival", scheduled);
+        });
+        reactor.add(retention_timer.fd(), [this] {
+            if (retention_timer.consume() == 0) return;
+            auto scheduled = last_retention_run + std::chrono::minutes(retention_interval_minutes);
+            runRetentionJob();
+            if (continuationTick(retention_timer, scheduled)) return;
+            retention_timer.armAt(nextDeadline(scheduled, std::chrono::minutes(retention_interval_minutes)));
+            last_retention_run = scheduled;
+            recordRun("retention", scheduled);
+        });
+        for (auto& entry : category_pipelines) {
+            CategoryPipeline* pipeline = entry.get();
+            reactor.add(pipeline->timer.fd(), [this, pipeline] {
+                if (pipeline->timer.consume() == 0) return;
+                auto interval = std::chrono::minutes(pipeline->interval_minutes);
+                auto scheduled = pipeline->last_run + interval;
+                runCategoryJob(*pipeline);
+                if (continuationTick(pipeline->timer, scheduled)) return;
+                pipeline->timer.armAt(nextDeadline(scheduled, interval));
+                pipeline->last_run = scheduled;
+                recordRun(pipeline->controller->getScope().name, scheduled);
+            });
+            pipeline->timer.armAt(pipeline->last_run + std::chrono::minutes(pipeline->interval_minutes));
+        }
+        reactor.add(archival_finished.fd(), [this] {
+            archival_finished.consume();
+            scheduleAfterArchival();
+        });
+        reactor.add(job_finished.fd(), [this] {
+            job_finished.consume();
+            continueIncrementalPasses();
+        });
+        reactor.add(config_changed.fd(), [this] {
+            config_changed.consume();
+            refreshConfig();
+        });
+        reactor.add(signals.fd(), [this] { handleSignals(); });
+        if (disk_pressure_enabled) {
+            startPressureMonitor();
+        }
+        PsiMonitor::Settings psi = PsiMonitor::configured();
+        if (psi.enabled) {
+            startPsiMonitor(psi);
+        }
+        if (archival_notifier) {
+            reactor.add(files_notified.fd(), [this] {
+                files_notified.consume();
+                queueNotifiedFiles();
+            });
+            // Paths that arrived before the reactor was listening
+            queueNotifiedFiles();
+        }
 
-            // Check if configured minutes have passed since last retention run
-            auto retention_duration = std::chrono::duration_cast<std::chrono::minutes>(now - last_retention_run);
-            if (retention_duration.count() >= retention_interval_minutes) {
-                std::cout << "Running Retention Job" << std::endl;
-                retention_controller.applyRetentionPolicy();
-                last_retention_run = now;
-            }
+        archival_timer.armAt(last_archival_run + archival_interval.current());
+        retention_timer.armAt(last_retention_run + std::chrono::minutes(retention_interval_minutes));
+        reactor.run();
 
-            // Sleep for configured interval to prevent busy-waiting
-            std::this_thread::sleep_for(std::chrono::seconds(poll_interval_seconds));
+        // Cancels the runs in progress; copies stop at their next chunk, scans at their next directory
+        executor.shutdown();
+        // The cancelled scans left their cursors; the next start resumes from them
+        SchedulerState::getInstance().save();
+        ConfigService::getInstance().stopWatching();
+        if (archival_notifier) {
+            archival_notifier->stop();
         }
+        // Drain the background writers now, while the connection pool and log sinks they write
+        // to still exist; left to static destruction they would run in no particular order
+        DbWriter::getInstance().shutdown();
+        AsyncLogger::stopAll();
+        BinaryEventLog::getInstance().flush();
     }
 };
 
@@ -0,0 +1,281 @@
+#include "pathclassifier.hpp"
+#include <algorithm>
+#include <cctype>
+#include <limits>
+
+namespace {
+    const std::uint32_t NO_NODE = std::numeric_limits<std::uint32_t>::max();
+
+    char lowerAscii(char c) {
+        return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+
+    bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+        if (a.size() != b.size()) return false;
+        for (std::size_t i = 0; i < a.size(); ++i) {
+            if (lowerAscii(a[i]) != lowerAscii(b[i])) return false;
+        }
+        return true;
+    }
+
+    // Calls visit(component, isLast) for each component; an absolute path starts with "/".
+    template <typename Visitor>
+    void forEachComponent(std::string_view path, Visitor&& visit) {
+        std::size_t position = 0;
+        if (!path.empty() && path[0] == '/') {
+            if (!visit(path.substr(0, 1), path.size() == 1)) return;
+            position = 1;
+        }
+        while (position < path.size()) {
+            std::size_t end = path.find('/', position);
+            if (end == std::string_view::npos) end = path.size();
+            if (end > position) {
+                bool isLast = path.find_first_not_of('/', end) == std::string_view::npos;
+                if (!visit(path.substr(position, end - position), isLast)) return;
+            }
+            position = end + 1;
+        }
+    }
+}
+
+std::string_view fileExtension(std::string_view filePath) {
+    std::size_t nameStart = filePath.rfind('/');
+    nameStart = nameStart == std::string_view::npos ? 0 : nameStart + 1;
+    std::size_t dot = filePath.rfind('.');
+    if (dot == std::string_view::npos || dot <= nameStart) {
+        return {};
+    }
+    return filePath.substr(dot + 1);
+}
+
+const char* categoryDirectory(FileCategory category) {
+    switch (category) {
+        case FileCategory::Video: return "Videos";
+        case FileCategory::Analysis: return "Analysis";
+        case FileCategory::Diagnostic: return "Diagnostics";
+        case FileCategory::Log: return "Logs";
+        case FileCategory::VideoClip: return "VideoClips";
+        case FileCategory::Unknown: break;
+    }
+    return "";
+}
+
+FileCategory categoryOfComponent(std::string_view component) {
+    switch (component.size()) {
+        case 4:
+            if (component == "Logs") return FileCategory::Log;
+            break;
+        case 6:
+            if (component == "Videos") return FileCategory::Video;
+            break;
+        case 8:
+            if (component == "Analysis") return FileCategory::Analysis;
+            break;
+        case 10:
+            if (component == "VideoClips") return FileCategory::VideoClip;
+            break;
+        case 11:
+            if (component == "Diagnostics") return FileCategory::Diagnostic;
+            break;
+    }
+    return FileCategory::Unknown;
+}
+
+FileCategory classifyFile(std::string_view filePath) {
+    FileCategory category = FileCategory::Unknown;
+    forEachComponent(filePath, [&category](std::string_view component, bool isLast) {
+        if (isLast) return false;
+        category = categoryOfComponent(component);
+        return category == FileCategory::Unknown;
+    });
+    return category;
+}
+
+std::uint32_t ExtensionTable::hash(std::string_view extension, std::uint32_t seed) {
+    // FNV-1a over the lower-cased bytes, seeded
+    std::uint32_t value = 2166136261u ^ seed;
+    for (char c : extension) {
+        value ^= static_cast<unsigned char>(lowerAscii(c));
+        value *= 16777619u;
+    }
+    return value ^ (value >> 15);
+}
+
+void ExtensionTable::build(const std::vector<std::string>& extensionList) {
+    std::vector<std::string> distinct;
+    for (const auto& extension : extensionList) {
+        std::string lowered(extension.size(), '\0');
+        std::transform(extension.begin(), extension.end(), lowered.begin(), lowerAscii);
+        if (!lowered.empty() && std::find(distinct.begin(), distinct.end(), lowered) == distinct.end()) {
+            distinct.push_back(std::move(lowered));
+        }
+    }
+    count = distinct.size();
+
+    std::size_t tableSize = 8;
+    while (tableSize < distinct.size() * 2) {
+        tableSize <<= 1;
+    }
+
+    // Search for a seed with no collisions, growing the table if none is found quickly
+    while (true) {
+        for (std::uint32_t candidate = 1; candidate <= 4096; ++candidate) {
+            std::vector<Slot> trial(tableSize);
+            bool collision = false;
+            for (std::size_t id = 0; id < distinct.size() && !collision; ++id) {
+                Slot& slot = trial[hash(distinct[id], candidate) & (tableSize - 1)];
+                if (slot.id != -1) {
+                    collision = true;
+                } else {
+                    slot.extension = distinct[id];
+                    slot.id = static_cast<int>(id);
+                }
+            }
+            if (!collision) {
+                slots = std::move(trial);
+                seed = candidate;
+                mask = static_cast<std::uint32_t>(tableSize - 1);
+                return;
+            }
+        }
+        tableSize <<= 1;
+    }
+}
+
+int ExtensionTable::find(std::string_view extension) const {
+    if (count == 0 || extension.empty()) return -1;
+    const Slot& slot = slots[hash(extension, seed) & mask];
+    return slot.id != -1 && equalsIgnoreCase(slot.extension, extension) ? slot.id : -1;
+}
+
+PathClassifier::PathClassifier() {
+    Node root;
+    root.ownRule.fill(NO_RULE);
+    root.inheritedRule.fill(NO_RULE);
+    nodes.push_back(std::move(root));
+}
+
+PathClassifier::PathClassifier(std::vector<std::pair<FileCategory, RetentionRule>> categoryRules) : PathClassifier() {
+    std::vector<std::string> allExtensions;
+    for (const auto& [category, rule] : categoryRules) {
+        allExtensions.insert(allExtensions.end(), rule.fileTypes.begin(), rule.fileTypes.end());
+    }
+    extensions.build(allExtensions);
+
+    for (auto& [category, rule] : categoryRules) {
+        if (category == FileCategory::Unknown) continue;
+
+        std::uint32_t node = 0;
+        forEachComponent(rule.root, [this, &node](std::string_view component, bool) {
+            node = addChild(node, component);
+            return true;
+        });
+
+        // First rule for a root and category wins
+        auto& slot = nodes[node].ownRule[categoryIndex(category)];
+        if (slot != NO_RULE) continue;
+        slot = static_cast<std::int32_t>(rules.size());
+
+        std::uint64_t allowed = 0;
+        for (const auto& fileType : rule.fileTypes) {
+            int id = extensions.find(fileType);
+            if (id >= 0 && static_cast<std::size_t>(id) < MAX_EXTENSIONS) {
+                allowed |= std::uint64_t(1) << id;
+            } else if (id >= 0) {
+                allowed = 0;
+                break;
+            }
+        }
+        extensionMasks.push_back(allowed);
+        rules.push_back(std::move(rule));
+    }
+
+    // Children always follow their parent in nodes, so one forward pass propagates inherited rules
+    nodes[0].inheritedRule = nodes[0].ownRule;
+    for (std::size_t i = 0; i < nodes.size(); ++i) {
+        for (const auto& [component, child] : nodes[i].children) {
+            for (std::size_t c = 0; c < FILE_CATEGORY_COUNT; ++c) {
+                std::int32_t own = nodes[child].ownRule[c];
+                nodes[child].inheritedRule[c] = own != NO_RULE ? own : nodes[i].inheritedRule[c];
+            }
+        }
+    }
+}
+
+std::uint32_t PathClassifier::childOf(std::uint32_t node, std::string_view component) const {
+    const auto& children = nodes[node].children;
+    auto it = std::lower_bound(children.begin(), children.end(), component,
+                               [](const std::pair<std::string, std::uint32_t>& child, std::string_view key) {
+                                   return std::string_view(child.first) < key;
+                               });
+    if (it != children.end() && it->first == component) {
+        return it->second;
+    }
+    return NO_NODE;
+}
+
+std::uint32_t PathClassifier::addChild(std::uint32_t node, std::string_view component) {
+    std::uint32_t existing = childOf(node, component);
+    if (existing != NO_NODE) return existing;
+
+    auto child = static_cast<std::uint32_t>(nodes.size());
+    Node created;
+    created.ownRule.fill(NO_RULE);
+    created.inheritedRule.fill(NO_RULE);
+    nodes.push_back(std::move(created));
+
+    auto& children = nodes[node].children;
+    auto it = std::lower_bound(children.begin(), children.end(), component,
+                               [](const std::pair<std::string, std::uint32_t>& entry, std::string_view key) {
+                                   return std::string_view(entry.first) < key;
+                               });
+    children.insert(it, {std::string(component), child});
+    return child;
+}
+
+std::uint32_t PathClassifier::walk(std::string_view filePath, FileCategory* category) const {
+    std::uint32_t deepest = 0;
+    bool inTrie = true;
+    forEachComponent(filePath, [&](std::string_view component, bool isLast) {
+        if (inTrie) {
+            std::uint32_t next = childOf(deepest, component);
+            if (next == NO_NODE) {
+                inTrie = false;
+            } else {
+                deepest = next;
+            }
+        }
+        if (category && *category == FileCategory::Unknown && !isLast) {
+            *category = categoryOfComponent(component);
+        }
+        return inTrie || (category && *category == FileCategory::Unknown);
+    });
+    return deepest;
+}
+
+PathMatch PathClassifier::classify(std::string_view filePath) const {
+    PathMatch match;
+    std::uint32_t node = walk(filePath, &match.category);
+    if (match.category == FileCategory::Unknown) {
+        return match;
+    }
+
+    std::int32_t ruleIndex = nodes[node].inheritedRule[categoryIndex(match.category)];
+    if (ruleIndex == NO_RULE) {
+        return match;
+    }
+    match.rule = &rules[ruleIndex];
+
+    std::uint64_t allowed = extensionMasks[ruleIndex];
+    if (allowed != 0) {
+        int id = extensions.find(fileExtension(filePath));
+        match.extensionAllowed = id >= 0 && (allowed & (std::uint64_t(1) << id)) != 0;
+    }
+    return match;
+}
+
+const RetentionRule* PathClassifier::ruleFor(FileCategory category, std::string_view filePath) const {
+    if (category == FileCategory::Unknown) return nullptr;
+    std::int32_t ruleIndex = nodes[walk(filePath, nullptr)].inheritedRule[categoryIndex(category)];
+    return ruleIndex == NO_RULE ? nullptr : &rules[ruleIndex];
+}
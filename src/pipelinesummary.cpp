@@ -0,0 +1,144 @@
+#include "pipelinesummary.hpp"
+#include "configservice.hpp"
+#include "binarylog.hpp"
+#include <algorithm>
+#include <nlohmann/json.hpp>
+
+namespace {
+    struct SummaryLoggingSettings {
+        bool summaryEnabled = true;
+        double perFileRatePerSecond = 10.0;
+        double perFileBurst = 50.0;
+    };
+
+    // Reads the optional "logging" section of the config snapshot; falls back to defaults.
+    SummaryLoggingSettings loadSummaryLoggingSettings() {
+        SummaryLoggingSettings settings;
+        auto snapshot = ConfigService::getInstance().current();
+        try {
+            const auto& logging = snapshot->section("logging");
+            settings.summaryEnabled = logging.value("summary_enabled", settings.summaryEnabled);
+            settings.perFileRatePerSecond = logging.value("per_file_rate_per_second", settings.perFileRatePerSecond);
+            settings.perFileBurst = logging.value("per_file_burst", settings.perFileBurst);
+        } catch (const nlohmann::json::exception& e) {
+            // Keep defaults
+        }
+        return settings;
+    }
+}
+
+PipelineCounters& PipelineCounters::operator+=(const PipelineCounters& other) {
+    filesSeen += other.filesSeen;
+    eligible += other.eligible;
+    archived += other.archived;
+    deleted += other.deleted;
+    bytesCopied += other.bytesCopied;
+    bytesDeleted += other.bytesDeleted;
+    errors += other.errors;
+    pending += other.pending;
+    pendingBytes += other.pendingBytes;
+    return *this;
+}
+
+LogRecord& PipelineCounters::appendTo(LogRecord& record) const {
+    return record.add("files_seen", filesSeen)
+                 .add("eligible", eligible)
+                 .add("archived", archived)
+                 .add("deleted", deleted)
+                 .add("bytes_copied", bytesCopied)
+                 .add("bytes_deleted", bytesDeleted)
+                 .add("errors", errors)
+                 .add("pending", pending);
+}
+
+TokenBucket::TokenBucket(double ratePerSecond, double burst)
+    : ratePerSecond(ratePerSecond), burst(std::max(burst, 1.0)), tokens(std::max(burst, 1.0)),
+      lastRefill(std::chrono::steady_clock::now()) {}
+
+bool TokenBucket::tryAcquire() {
+    if (ratePerSecond <= 0.0) return true;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto now = std::chrono::steady_clock::now();
+    double elapsed = std::chrono::duration<double>(now - lastRefill).count();
+    lastRefill = now;
+    tokens = std::min(burst, tokens + elapsed * ratePerSecond);
+
+    if (tokens >= 1.0) {
+        tokens -= 1.0;
+        return true;
+    }
+    suppressed.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+TokenBucket& perFileLogLimiter() {
+    static const SummaryLoggingSettings settings = loadSummaryLoggingSettings();
+    static TokenBucket limiter(settings.summaryEnabled ? settings.perFileRatePerSecond : 0.0,
+                               settings.perFileBurst);
+    return limiter;
+}
+
+PipelineSummary::PipelineSummary(AsyncLogger& log, const char* pipeline)
+    : log(log), pipeline(pipeline), startedAt(std::chrono::steady_clock::now()) {}
+
+PipelineSummary::~PipelineSummary() {
+    finish();
+}
+
+void PipelineSummary::beginDirectory(const std::string& path) {
+    endDirectory();
+    directory = path;
+    directoryCounters = PipelineCounters();
+    inDirectory = true;
+}
+
+void PipelineSummary::endDirectory() {
+    if (!inDirectory) return;
+    inDirectory = false;
+    ++directories;
+    cycleCounters += directoryCounters;
+
+    LogRecord record("Directory summary", "PIPELINE_DIR_SUMMARY");
+    record.add("pipeline", pipeline).add("directory", directory);
+    log.info(directoryCounters.appendTo(record));
+
+    const PipelineCounters& c = directoryCounters;
+    BinaryEventLog::getInstance().record(EventId::DirectorySummary, directory,
+        {static_cast<std::int64_t>(c.filesSeen), static_cast<std::int64_t>(c.eligible),
+         static_cast<std::int64_t>(c.archived), static_cast<std::int64_t>(c.deleted),
+         static_cast<std::int64_t>(c.bytesDeleted), static_cast<std::int64_t>(c.errors),
+         static_cast<std::int64_t>(c.bytesCopied)});
+}
+
+void PipelineSummary::merge(const PipelineCounters& taskCounters) {
+    std::lock_guard<std::mutex> lock(mergeMutex);
+    counters() += taskCounters;
+}
+
+void PipelineSummary::finish() {
+    if (finished) return;
+    endDirectory();
+    finished = true;
+
+    auto elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - startedAt).count();
+
+    LogRecord record("Pipeline cycle summary", "PIPELINE_CYCLE_SUMMARY");
+    record.add("pipeline", pipeline).add("directories", directories);
+    cycleCounters.appendTo(record)
+        .add("suppressed_file_lines", perFileLogLimiter().takeSuppressed())
+        .add("duration_ms", static_cast<long long>(elapsedMs));
+    log.info(record);
+
+    const PipelineCounters& c = cycleCounters;
+    auto& events = BinaryEventLog::getInstance();
+    events.record(EventId::CycleSummary, pipeline,
+        {static_cast<std::int64_t>(directories), static_cast<std::int64_t>(c.filesSeen),
+         static_cast<std::int64_t>(c.eligible), static_cast<std::int64_t>(c.archived),
+         static_cast<std::int64_t>(c.deleted), static_cast<std::int64_t>(c.bytesDeleted),
+         static_cast<std::int64_t>(c.errors), static_cast<std::int64_t>(elapsedMs),
+         static_cast<std::int64_t>(c.bytesCopied)});
+    // Bounds what a crash can lose to one cycle
+    events.flush();
+}
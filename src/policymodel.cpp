@@ -0,0 +1,235 @@
+#include "policymodel.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+    struct CategoryInfo {
+        FileCategory category;
+        const char* directory;
+        // Substrings identifying the category's policy keys
+        std::vector<const char*> policyKeys;
+    };
+
+    // Checked in this order; VIDEO_CLIPS before VIDEO so clip keys are not taken as video keys.
+    const std::vector<CategoryInfo>& categories() {
+        static const std::vector<CategoryInfo> table = {
+            {FileCategory::VideoClip, "VideoClips", {"VIDEO_CLIPS_RETENTION_POLICY"}},
+            {FileCategory::Video, "Videos", {"VIDEO_RETENTION_POLICY"}},
+            {FileCategory::Analysis, "Analysis", {"PARQUET_RETENTION_POLICY", "ANALYSIS_RETENTION_POLICY"}},
+            {FileCategory::Diagnostic, "Diagnostics", {"DIAGNOSTIC_RETENTION_POLICY"}},
+            {FileCategory::Log, "Logs", {"LOG_RETENTION_POLICY"}}
+        };
+        return table;
+    }
+
+    bool parseInt(const std::string& text, int& value) {
+        try {
+            std::size_t consumed = 0;
+            value = std::stoi(text, &consumed);
+            return consumed > 0;
+        } catch (const std::exception&) {
+            return false;
+        }
+    }
+
+    // Mirrors the long-standing check in ArchivalController::getAllFilePaths.
+    bool looksLikePath(const std::string& path) {
+        return !path.empty() && (path[0] == '/' || path.find('/') != std::string::npos) &&
+               !(path.length() < 10 && path[0] >= 'a' && path[0] <= 'z');
+    }
+
+    // "mp4, .MKV,avi" -> {"mp4", "MKV", "avi"}
+    std::vector<std::string> splitFileTypes(const std::string& list) {
+        std::vector<std::string> types;
+        std::size_t position = 0;
+        while (position <= list.size()) {
+            std::size_t end = std::min(list.find(',', position), list.size());
+            std::string type = list.substr(position, end - position);
+            type.erase(0, std::min(type.find_first_not_of(" \t."), type.size()));
+            type.erase(type.find_last_not_of(" \t") + 1);
+            if (!type.empty()) {
+                types.push_back(std::move(type));
+            }
+            position = end + 1;
+        }
+        return types;
+    }
+
+    void sortRulesBySpecificity(std::array<std::vector<RetentionRule>, FILE_CATEGORY_COUNT>& rules) {
+        for (auto& categoryRules : rules) {
+            std::stable_sort(categoryRules.begin(), categoryRules.end(),
+                             [](const RetentionRule& a, const RetentionRule& b) { return a.root.size() > b.root.size(); });
+        }
+    }
+}
+
+FileCategory categoryForPolicyKey(const std::string& key) {
+    for (const auto& info : categories()) {
+        for (const char* policyKey : info.policyKeys) {
+            if (key.find(policyKey) != std::string::npos) {
+                return info.category;
+            }
+        }
+    }
+    return FileCategory::Unknown;
+}
+
+std::string normalizePolicyPath(std::string path) {
+    while (path.size() > 1 && path.back() == '/') {
+        path.pop_back();
+    }
+    return path;
+}
+
+bool isUnderPath(const std::string& filePath, const std::string& root) {
+    if (root.empty() || filePath.compare(0, root.size(), root) != 0) {
+        return false;
+    }
+    return filePath.size() == root.size() || filePath[root.size()] == '/' || root.back() == '/';
+}
+
+CompiledPolicy CompiledPolicy::fromRetentionPolicy(
+    const std::unordered_map<std::string, std::unordered_map<std::string, std::string>>& policy,
+    const nlohmann::json& rules) {
+    CompiledPolicy compiled;
+
+    auto dds = policy.find("DDS_PATH");
+    if (dds != policy.end()) {
+        auto value = dds->second.find("value");
+        if (value != dds->second.end()) {
+            compiled.ddsPath = normalizePolicyPath(value->second);
+        }
+    }
+
+    auto threshold = policy.find("THRESHOLD_STORAGE_UTILIZATION");
+    if (threshold != policy.end()) {
+        auto value = threshold->second.find("value");
+        compiled.hasThreshold = value != threshold->second.end() && parseInt(value->second, compiled.thresholdPercent);
+    }
+
+    for (const auto& [key, config] : policy) {
+        FileCategory category = categoryForPolicyKey(key);
+        if (category == FileCategory::Unknown) continue;
+
+        auto value = config.find("value");
+        if (value == config.end()) {
+            compiled.keysWithoutPath.push_back(key);
+            continue;
+        }
+
+        RetentionRule rule;
+        rule.key = key;
+        rule.root = normalizePolicyPath(value->second);
+        auto period = config.find("retentionPeriod");
+        rule.hasRetentionPeriod = period != config.end() && parseInt(period->second, rule.retentionHours);
+        auto fileTypes = config.find("fileTypes");
+        if (fileTypes != config.end()) {
+            rule.fileTypes = splitFileTypes(fileTypes->second);
+        }
+
+        compiled.scanRoots.emplace_back(key, value->second);
+        compiled.retentionRules[categoryIndex(category)].push_back(std::move(rule));
+    }
+
+    sortRulesBySpecificity(compiled.retentionRules);
+
+    std::vector<std::pair<FileCategory, RetentionRule>> classifierRules;
+    for (std::size_t i = 0; i < FILE_CATEGORY_COUNT; ++i) {
+        for (const auto& rule : compiled.retentionRules[i]) {
+            classifierRules.emplace_back(static_cast<FileCategory>(i), rule);
+        }
+    }
+    compiled.classifier = PathClassifier(std::move(classifierRules));
+
+    std::array<std::string, FILE_CATEGORY_COUNT> defaults;
+    defaults.fill("age > retention");
+    compiled.deletionRules = compileCategoryRules(rules.value("retention", nlohmann::json::object()),
+                                                  defaults, compiled.ruleErrors);
+    return compiled;
+}
+
+CompiledPolicy CompiledPolicy::fromArchivalPolicy(const nlohmann::json& policy,
+                                                  const std::map<std::string, bool>& eligibility,
+                                                  const nlohmann::json& rules) {
+    CompiledPolicy compiled;
+    if (!policy.is_object()) {
+        return compiled;
+    }
+
+    if (policy.contains("MOUNTED_PATH") && policy["MOUNTED_PATH"].is_string()) {
+        compiled.mountedPath = normalizePolicyPath(policy["MOUNTED_PATH"].get<std::string>());
+    }
+    if (policy.contains("DDS_PATH") && policy["DDS_PATH"].is_string()) {
+        compiled.ddsPath = normalizePolicyPath(policy["DDS_PATH"].get<std::string>());
+    }
+    if (policy.contains("THRESHOLD_STORAGE_UTILIZATION") && policy["THRESHOLD_STORAGE_UTILIZATION"].is_string()) {
+        compiled.hasThreshold = parseInt(policy["THRESHOLD_STORAGE_UTILIZATION"].get<std::string>(),
+                                         compiled.thresholdPercent);
+    }
+
+    for (const auto& [key, value] : policy.items()) {
+        if (value.is_string() && key.find("RETENTION_POLICY") != std::string::npos &&
+            looksLikePath(value.get_ref<const std::string&>())) {
+            compiled.scanRoots.emplace_back(key, value.get<std::string>());
+        }
+    }
+
+    if (policy.contains("RETENTION_POLICIES") && policy["RETENTION_POLICIES"].is_object()) {
+        const auto& ages = policy["RETENTION_POLICIES"];
+        for (const auto& info : categories()) {
+            auto age = ages.find(info.directory);
+            if (age != ages.end() && age->is_number()) {
+                compiled.hasDeletionAge[categoryIndex(info.category)] = true;
+                compiled.deletionAgeHours[categoryIndex(info.category)] = age->get<double>();
+            }
+        }
+    }
+
+    compiled.eligibilityConfigured = !eligibility.empty();
+    for (const auto& info : categories()) {
+        auto flag = eligibility.find(info.directory);
+        compiled.archivalEligible[categoryIndex(info.category)] = flag != eligibility.end() && flag->second;
+    }
+
+    std::array<std::string, FILE_CATEGORY_COUNT> deletionDefaults;
+    std::array<std::string, FILE_CATEGORY_COUNT> archivalDefaults;
+    for (std::size_t i = 0; i < FILE_CATEGORY_COUNT; ++i) {
+        deletionDefaults[i] = compiled.hasDeletionAge[i] ? "age > retention" : "false";
+        archivalDefaults[i] = !compiled.eligibilityConfigured || compiled.archivalEligible[i] ? "true" : "false";
+    }
+    compiled.deletionRules = compileCategoryRules(rules.value("archival_deletion", nlohmann::json::object()),
+                                                  deletionDefaults, compiled.ruleErrors);
+    compiled.archivalRules = compileCategoryRules(rules.value("archival", nlohmann::json::object()),
+                                                  archivalDefaults, compiled.ruleErrors);
+
+    // Without a deletion age `retention` would read as 0 and `age > retention` would match every file
+    for (std::size_t i = 0; i < FILE_CATEGORY_COUNT; ++i) {
+        if (compiled.hasDeletionAge[i]) continue;
+        const char* directory = categoryDirectory(static_cast<FileCategory>(i));
+        if (compiled.deletionRules[i].needs(RULE_INPUT_RETENTION)) {
+            compiled.ruleErrors.push_back(std::string(directory) + ": deletion rule uses retention but " +
+                                          "RETENTION_POLICIES has no age for the category");
+            compiled.deletionRules[i] = RuleProgram::compile(deletionDefaults[i]);
+        }
+        if (compiled.archivalRules[i].needs(RULE_INPUT_RETENTION)) {
+            compiled.ruleErrors.push_back(std::string(directory) + ": archival rule uses retention but " +
+                                          "RETENTION_POLICIES has no age for the category");
+            compiled.archivalRules[i] = RuleProgram::compile(archivalDefaults[i]);
+        }
+    }
+    return compiled;
+}
+
+const RetentionRule* CompiledPolicy::findRetentionRule(FileCategory category, const std::string& filePath) const {
+    return classifier.ruleFor(category, filePath);
+}
+
+bool CompiledPolicy::toDdsPath(const std::string& filePath, std::string& ddsFilePath) const {
+    if (!isUnderPath(filePath, mountedPath)) {
+        return false;
+    }
+    ddsFilePath.reserve(ddsPath.size() + filePath.size() - mountedPath.size());
+    ddsFilePath.assign(ddsPath);
+    ddsFilePath.append(filePath, mountedPath.size(), std::string::npos);
+    return true;
+}
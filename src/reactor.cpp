@@ -0,0 +1,180 @@
+#include "reactor.hpp"
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <pthread.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+namespace {
+    std::runtime_error systemError(const char* what) {
+        return std::runtime_error(std::string(what) + ": " + std::strerror(errno));
+    }
+
+    // Reads one 8-byte counter (eventfd/timerfd); 0 if nothing was pending.
+    std::uint64_t readCounter(int fd) {
+        std::uint64_t value = 0;
+        ssize_t result;
+        do {
+            result = read(fd, &value, sizeof(value));
+        } while (result < 0 && errno == EINTR);
+        return result == sizeof(value) ? value : 0;
+    }
+}
+
+Reactor::Reactor() : epollFd(epoll_create1(EPOLL_CLOEXEC)), stopFd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) {
+    if (epollFd < 0 || stopFd < 0) {
+        if (epollFd >= 0) close(epollFd);
+        if (stopFd >= 0) close(stopFd);
+        throw systemError("Reactor setup failed");
+    }
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = stopFd;
+    if (epoll_ctl(epollFd, EPOLL_CTL_ADD, stopFd, &event) < 0) {
+        close(epollFd);
+        close(stopFd);
+        throw systemError("Reactor setup failed");
+    }
+}
+
+Reactor::~Reactor() {
+    close(stopFd);
+    close(epollFd);
+}
+
+void Reactor::add(int fd, Handler handler) {
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = fd;
+    int operation = handlers.count(fd) ? EPOLL_CTL_MOD : EPOLL_CTL_ADD;
+    if (epoll_ctl(epollFd, operation, fd, &event) < 0) {
+        throw systemError("Reactor add failed");
+    }
+    handlers[fd] = std::move(handler);
+}
+
+void Reactor::remove(int fd) {
+    if (handlers.erase(fd)) {
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+    }
+}
+
+void Reactor::run() {
+    stopping = false;
+    epoll_event events[16];
+    while (!stopping) {
+        int count = epoll_wait(epollFd, events, 16, -1);
+        if (count < 0) {
+            if (errno == EINTR) continue;
+            throw systemError("epoll_wait failed");
+        }
+        for (int i = 0; i < count && !stopping; ++i) {
+            int fd = events[i].data.fd;
+            if (fd == stopFd) {
+                readCounter(stopFd);
+                continue;
+            }
+            // Copy: the handler may remove itself
+            auto it = handlers.find(fd);
+            if (it != handlers.end()) {
+                Handler handler = it->second;
+                handler();
+            }
+        }
+    }
+}
+
+void Reactor::stop() {
+    stopping = true;
+    std::uint64_t one = 1;
+    ssize_t ignored = write(stopFd, &one, sizeof(one));
+    (void)ignored;
+}
+
+DeadlineTimer::DeadlineTimer() : timerFd(timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC)) {
+    if (timerFd < 0) {
+        throw systemError("timerfd_create failed");
+    }
+}
+
+DeadlineTimer::~DeadlineTimer() {
+    close(timerFd);
+}
+
+void DeadlineTimer::armAt(std::chrono::steady_clock::time_point deadline) {
+    // steady_clock is CLOCK_MONOTONIC on Linux
+    auto sinceEpoch = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline.time_since_epoch()).count();
+    if (sinceEpoch <= 0) {
+        sinceEpoch = 1;  // Zero would disarm; fire immediately instead
+    }
+    itimerspec spec{};
+    spec.it_value.tv_sec = static_cast<time_t>(sinceEpoch / 1000000000);
+    spec.it_value.tv_nsec = static_cast<long>(sinceEpoch % 1000000000);
+    if (timerfd_settime(timerFd, TFD_TIMER_ABSTIME, &spec, nullptr) < 0) {
+        throw systemError("timerfd_settime failed");
+    }
+}
+
+void DeadlineTimer::disarm() {
+    itimerspec spec{};
+    timerfd_settime(timerFd, 0, &spec, nullptr);
+}
+
+std::uint64_t DeadlineTimer::consume() {
+    return readCounter(timerFd);
+}
+
+WakeupEvent::WakeupEvent() : eventFd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) {
+    if (eventFd < 0) {
+        throw systemError("eventfd failed");
+    }
+}
+
+WakeupEvent::~WakeupEvent() {
+    close(eventFd);
+}
+
+void WakeupEvent::notify() {
+    std::uint64_t one = 1;
+    ssize_t ignored = write(eventFd, &one, sizeof(one));
+    (void)ignored;
+}
+
+std::uint64_t WakeupEvent::consume() {
+    return readCounter(eventFd);
+}
+
+SignalSource::SignalSource(std::initializer_list<int> signals) {
+    sigset_t mask;
+    sigemptyset(&mask);
+    for (int signal : signals) {
+        sigaddset(&mask, signal);
+    }
+    if (pthread_sigmask(SIG_BLOCK, &mask, nullptr) != 0) {
+        throw std::runtime_error("pthread_sigmask failed");
+    }
+    signalFd = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (signalFd < 0) {
+        throw systemError("signalfd failed");
+    }
+}
+
+SignalSource::~SignalSource() {
+    close(signalFd);
+}
+
+int SignalSource::next() {
+    signalfd_siginfo info{};
+    ssize_t result;
+    do {
+        result = read(signalFd, &info, sizeof(info));
+    } while (result < 0 && errno == EINTR);
+    return result == sizeof(info) ? static_cast<int>(info.ssi_signo) : 0;
+}
@@ -3,6 +3,18 @@
 #include <iostream>
 #include <stdexcept>
 #include "db_instance.hpp"  
+#include "dbwriter.hpp"
+#include "asynclogger.hpp"
+#include "pipelinesummary.hpp"
+#include "binarylog.hpp"
+#include "configservice.hpp"
+#include "jobexecutor.hpp"
+#include "taskexecutor.hpp"
+#include "schedulerstate.hpp"
+#include "workbudget.hpp"
+#include "iopressure.hpp"
+#include "threadisolation.hpp"
+#include "diskpressure.hpp"
 #include <vector>
 #include <string>
 #include <unordered_map>
@@ -14,19 +26,31 @@
 #include <sys/prctl.h>
 #include <unistd.h>
 #include <cstring>
+#include <filesystem>
+
+namespace {
+    // Scheduler job the scan cursor is kept under
+    const std::string RETENTION_JOB = "retention";
+}
 
 // Constructor: Initializes the retention controller, setting up logging and storing the retention policy.
 RetentionController::RetentionController(const std::unordered_map<std::string, std::unordered_map<std::string, std::string>>& retentionPolicy,
                                            const std::string& logFilePath, 
                                            const std::string& source) 
-    : retentionPolicy(retentionPolicy) {
+    : retentionPolicy(retentionPolicy),
+      ruleExpressions(loadRuleExpressions().dump()),
+      policy(CompiledPolicy::fromRetentionPolicy(retentionPolicy, nlohmann::json::parse(ruleExpressions))),
+      configVersion(ConfigService::getInstance().current()->version()) {
     try {
        
         // Get an instance of the logger.
         logger = LoggingService::getInstance(source, logFilePath);
+        // Per-file records go through the async front end so the file loop never waits on log I/O.
+        asyncLogger = &AsyncLogger::getInstance(logger);
         logger->info("RetentionController initialization started", 
                      createLogInfo({{"detail", "Initialization started successfully"}}), 
                      "RETEN_INIT_START");
+        reportRuleErrors();
     } catch (const std::exception& e) {
         throw std::runtime_error("Failed to initialize logging service: " + std::string(e.what()));
     }
@@ -34,42 +58,12 @@ RetentionController::RetentionController(const std::unordered_map<std::string, s
 
 // Logs an incident to the database by inserting an incident record.
 void RetentionController::logIncidentToDB(const std::string& message, const nlohmann::json& details, const std::string& error_code) {
-    try {
-        // Check if the most recent incident with this message is still active (no recovery attempts or failed recovery)
-        std::ostringstream checkQuery;
-        checkQuery << "SELECT i.id FROM incident i "
-                  << "LEFT JOIN recovery r ON i.id = r.incident_id "
-                  << "WHERE i.incident_message = '" << message << "' "
-                  << "AND i.process_name = 'EFMS' "
-                  << "AND (r.id IS NULL OR r.recovery_status = 'FAILED') "
-                  << "ORDER BY i.incident_time DESC LIMIT 1";
-        
-        auto result = db.executeSelect(checkQuery.str());
-        
-        // If no active incident exists, insert a new one
-        if (result.empty()) {
-            // Ensure error_code is included in the details JSON
-            nlohmann::json detailsWithCode = details;
-            detailsWithCode["error_code"] = error_code;
-            
-            std::ostringstream insertQuery;
-            insertQuery << "INSERT INTO incident (process_name, incident_message, incident_time, incident_details) "
-                       << "VALUES ('EFMS', '" << message << "', NOW(), '" << detailsWithCode.dump() << "') "
-                       << "RETURNING id";
-            
-            int lastInsertId = db.executeInsert(insertQuery.str());
-            std::cout << "Inserted incident with ID: " << lastInsertId << " for error code: " << error_code << std::endl;
-        } else {
-            std::cout << "Skipped duplicate incident: " << message << " (already active or no successful recovery)" << std::endl;
-        }
-    } catch (const std::exception& e) {
-        std::cerr << "Database Operation Failed: " << e.what() << std::endl;
-        logger->error("Database Operation Failed", {{"error", e.what()}}, "DB_INSERT_FAIL", true, "05013");
-    }
+    // Handed to the background DB writer so the file loop never waits on Postgres.
+    DbWriter::getInstance().enqueueIncident(message, details, error_code, "DB_INSERT_FAIL", "05013", logger);
 }
 
 // Applies the retention policy by verifying key configuration and choosing the appropriate pipeline.
-void RetentionController::applyRetentionPolicy() {
+void RetentionController::applyRetentionPolicy(const CancellationToken& token) {
     try {
         logger->info("Applying Retention Policy...", 
                      createLogInfo({{"detail", "Retention policy application initiated"}}));
@@ -122,10 +116,11 @@ void RetentionController::applyRetentionPolicy() {
         logger->info("Checking retention policy status", 
                      createLogInfo({{"detail", "Starting retention status check"}}));
         // Choose pipeline based on disk utilization.
+        refreshTunables();
         if (checkRetentionPolicy()) {
-            startMaxUtilizationPipeline();
+            startMaxUtilizationPipeline(token);
         } else {
-            startNormalPipeline();
+            startNormalPipeline(token);
         }
     } catch (const std::exception& e) {
         logger->critical("Error applying retention policy", 
@@ -140,25 +135,64 @@ void RetentionController::applyRetentionPolicy() {
 }
 
 // Maximum Utilization Pipeline: Deletes files until the retention policy condition is met.
-void RetentionController::startMaxUtilizationPipeline() {
+// Logs why a pipeline stops early; checked at directory boundaries.
+bool RetentionController::pipelineCancelled(const CancellationToken& token, const char* pipeline) {
+    if (!token.isCancelled()) {
+        return false;
+    }
+    asyncLogger->info(LogRecord("Pipeline cancelled", "PIPELINE_CANCELLED")
+                          .add("pipeline", pipeline)
+                          .add("reason", token.reason()));
+    return true;
+}
+
+void RetentionController::startMaxUtilizationPipeline(const CancellationToken& token) {
     logger->info("Maximum Utilization Pipeline Started", 
                  createLogInfo({{"detail", "Max utilization pipeline initiated"}}));
+    // The directory walks run on this thread; give it the lane of the work it feeds
+    ThreadIsolation::getInstance().apply(TaskPriority::Emergency);
+    PipelineSummary summary(*asyncLogger, "retention_max_utilization");
     try {
         auto filepaths = getAllFilePaths();
         for (const auto& filePath : filepaths) {
+            if (pipelineCancelled(token, "retention_max_utilization")) {
+                return;
+            }
+            refreshTunables();
+            summary.beginDirectory(filePath);
             // Recursively get all files and directories.
             auto [files, directories] = fileService.read_directory_recursively(filePath);
-            for (const auto& file : files) {
+            // Delete one batch per worker between utilization checks, so eviction runs in
+            // parallel but overshoots the threshold by at most one batch
+            const std::size_t batchSize = TaskExecutor::getInstance().workerCount();
+            for (std::size_t begin = 0; begin < files.size() && !token.isCancelled(); begin += batchSize) {
+                const std::size_t end = std::min(begin + batchSize, files.size());
                 // Check retention policy and file deletion permissions before deleting.
-                if (checkRetentionPolicy() && checkFilePermissions(file)) {
-                    logger->info("Deleting File", createLogInfo({{"file", file}}));
-                    fileService.delete_file(file);
+                if (!checkRetentionPolicy()) {
+                    summary.counters().filesSeen += end - begin;
+                    continue;
                 }
+                TaskGroup group(TaskPriority::Emergency);
+                for (std::size_t i = begin; i < end; ++i) {
+                    group.run([this, &summary, &file = files[i]] {
+                        PipelineCounters counters;
+                        ++counters.filesSeen;
+                        ++counters.eligible;
+                        if (!checkFilePermissions(file)) {
+                            ++counters.errors;
+                        } else {
+                            deleteFile(file, counters);
+                        }
+                        summary.merge(counters);
+                    });
+                }
+                group.wait();
             }
             // Remove empty directories.
             stopPipeline(directories);
         }
     } catch (const std::exception& e) {
+        ++summary.counters().errors;
         logger->critical("Error in Maximum Utilization Pipeline", 
                  createLogInfo({{"detail", e.what()}}), 
                  "RETENTION_ERR", true, "05018");
@@ -171,24 +205,106 @@ void RetentionController::startMaxUtilizationPipeline() {
 }
 
 // Normal Pipeline: Processes directories to delete files eligible for deletion.
-void RetentionController::startNormalPipeline() {
+void RetentionController::startNormalPipeline(const CancellationToken& token) {
     logger->info("Normal Pipeline Started", 
                  createLogInfo({{"detail", "Normal pipeline initiated"}}));
+    ThreadIsolation::getInstance().apply(TaskPriority::Normal);
+    PipelineSummary summary(*asyncLogger, "retention_normal");
+    // A pass cut short by cancellation or a restart picks up after the last directory it finished
+    SchedulerState& state = SchedulerState::getInstance();
     try {
         auto filepaths = getAllFilePaths();
-        for (const auto& filePath : filepaths) {
-            logger->info("Processing directory", createLogInfo({{"directory", filePath}}));
+        ScanCursor cursor = state.cursor(RETENTION_JOB);
+        const std::size_t first = resumeIndex(filepaths, cursor);
+        if (first >= filepaths.size() || filepaths[first] != cursor.root) {
+            cursor = ScanCursor();
+        } else if (!cursor.empty()) {
+            asyncLogger->info(LogRecord("Resuming scan", "PIPELINE_RESUME")
+                                  .add("pipeline", "retention_normal")
+                                  .add("root", cursor.root)
+                                  .add("directory", cursor.directory)
+                                  .add("file", cursor.file));
+        }
+
+        // In incremental mode the run yields once its budget is spent; the next tick continues at the cursor
+        WorkBudget budget(WorkBudget::configured());
+        auto yield = [&] {
+            state.save();
+            asyncLogger->info(LogRecord("Work budget spent, yielding", "PIPELINE_YIELD")
+                                  .add("pipeline", "retention_normal")
+                                  .add("files", budget.filesAdmitted())
+                                  .add("bytes", budget.bytesCharged()));
+        };
+        // Backs off while the node is under I/O or memory pressure
+        PressureThrottle& pressure = PressureThrottle::getInstance();
+
+        for (std::size_t index = first; index < filepaths.size(); ++index) {
+            const auto& filePath = filepaths[index];
+            // Returns early if the run is cancelled while paused
+            pressure.pace(token);
+            if (pipelineCancelled(token, "retention_normal")) {
+                state.save();
+                return;
+            }
+            if (budget.exhausted()) {
+                yield();
+                return;
+            }
+            asyncLogger->info(LogRecord("Processing directory").add("directory", filePath));
+            refreshTunables();
+            summary.beginDirectory(filePath);
             auto [files, directories] = fileService.read_directory_recursively(filePath);
-            for (const auto& file : files) {
-                if (isFileEligibleForDeletion(file) && checkFilePermissions(file)) {
-                    logger->info("Deleting File", createLogInfo({{"file", file}}));
-                    fileService.delete_file(file);
+            for (const auto& batch : groupByDirectory(files)) {
+                const std::size_t start = resumeOffset(filePath, batch, cursor);
+                if (start == batch.files.size()) {
+                    continue;
+                }
+                TaskGroup group(TaskPriority::Normal);
+                std::size_t next = start;
+                for (; next < batch.files.size() && pressure.pace(token) && budget.admit(); ++next) {
+                    group.run([this, &summary, &budget, &file = batch.files[next], &token] {
+                        if (token.isCancelled()) return;
+                        PipelineCounters counters;
+                        ++counters.filesSeen;
+                        if (isFileEligibleForDeletion(file)) {
+                            ++counters.eligible;
+                            if (!checkFilePermissions(file)) {
+                                ++counters.errors;
+                            } else {
+                                deleteFile(file, counters);
+                            }
+                        }
+                        budget.charge(counters.bytesDeleted);
+                        summary.merge(counters);
+                    });
+                }
+                group.wait();
+                if (pipelineCancelled(token, "retention_normal")) {
+                    state.save();
+                    return;
+                }
+                if (next < batch.files.size()) {
+                    // Every admitted file is done; resume after the last of them
+                    if (next > start) {
+                        state.setCursor(RETENTION_JOB, ScanCursor{filePath, batch.directory, batch.files[next - 1]});
+                    }
+                    yield();
+                    return;
                 }
+                state.setCursor(RETENTION_JOB, ScanCursor{filePath, batch.directory, ""});
+                state.checkpoint();
             }
             // Clean up any empty directories.
             stopPipeline(directories);
+            state.setCursor(RETENTION_JOB,
+                            index + 1 < filepaths.size() ? ScanCursor{filepaths[index + 1], ""} : ScanCursor());
+            state.checkpoint();
         }
+        state.save();
     } catch (const std::exception& e) {
+        // The cursor keeps the last finished directory; the next run retries from there
+        state.save();
+        ++summary.counters().errors;
         logger->critical("Error in Normal Pipeline", 
                  createLogInfo({{"detail", e.what()}}), 
                  "RETENTION_ERR", true, "05019");
@@ -200,28 +316,56 @@ void RetentionController::startNormalPipeline() {
     }
 }
 
+// Applies a newly published config snapshot between directories; deletions in
+// progress finish with the settings they started with.
+void RetentionController::refreshTunables() {
+    auto snapshot = ConfigService::getInstance().current();
+    if (snapshot->version() == configVersion) {
+        return;
+    }
+    configVersion = snapshot->version();
+
+    try {
+        // Recompiled first: the threshold below overrides the one from the policy
+        const auto& rules = snapshot->section("rules");
+        nlohmann::json expressions = rules.is_object() ? rules : nlohmann::json::object();
+        if (expressions.dump() != ruleExpressions) {
+            ruleExpressions = expressions.dump();
+            policy = CompiledPolicy::fromRetentionPolicy(retentionPolicy, expressions);
+            reportRuleErrors();
+        }
+        const auto& dds = snapshot->section("dds_retention_policy");
+        if (dds.contains("threshold_storage_utilization")) {
+            policy.thresholdPercent = dds["threshold_storage_utilization"].get<int>();
+            policy.hasThreshold = true;
+        }
+    } catch (const nlohmann::json::exception& e) {
+        // Keep current values
+    }
+    logger->info("Configuration reloaded",
+                 createLogInfo({{"version", configVersion}, {"threshold_percent", policy.thresholdPercent}}),
+                 "CONFIG_RELOADED");
+}
+
+void RetentionController::reportRuleErrors() {
+    for (const auto& error : policy.ruleErrors) {
+        nlohmann::json errInfo = createLogInfo({{"detail", error}});
+        logger->error("Invalid retention rule, using default", errInfo, "RULE_COMPILE_ERR", true, "05028");
+        logIncidentToDB("Invalid retention rule, using default", errInfo, "05028");
+    }
+}
+
 std::vector<std::string> RetentionController::getAllFilePaths() {
     std::vector<std::string> filepaths;
+    filepaths.reserve(policy.scanRoots.size());
 
-    // Loop through all keys in the station-specific retentionPolicy map
-    for (const auto& [key, config] : retentionPolicy) {
-        // Check if key ends with one of the known retention path suffixes
-        if (key.find("VIDEO_RETENTION_POLICY") != std::string::npos ||
-            key.find("PARQUET_RETENTION_POLICY") != std::string::npos ||
-            key.find("DIAGNOSTIC_RETENTION_POLICY") != std::string::npos ||
-            key.find("LOG_RETENTION_POLICY") != std::string::npos ||
-            key.find("VIDEO_CLIPS_RETENTION_POLICY") != std::string::npos) {
-            
-            auto it = config.find("value");
-            if (it != config.end()) {
-                filepaths.push_back(it->second);
-                logger->info("Station-specific policy path found", 
-                             createLogInfo({{"key", key}, {"path", it->second}}));
-            } else {
-                logger->warning("Missing 'value' in policy config", 
-                                createLogInfo({{"key", key}}));
-            }
-        }
+    // Station-specific policy paths, resolved when the policy was compiled
+    for (const auto& [key, path] : policy.scanRoots) {
+        filepaths.push_back(path);
+        asyncLogger->info(LogRecord("Station-specific policy path found").add("key", key).add("path", path));
+    }
+    for (const auto& key : policy.keysWithoutPath) {
+        asyncLogger->warning(LogRecord("Missing 'value' in policy config").add("key", key));
     }
 
     return filepaths;
@@ -231,26 +375,22 @@ std::vector<std::string> RetentionController::getAllFilePaths() {
 // Calculates disk space utilization (%) using the DDS_PATH from the retention policy.
 double RetentionController::diskSpaceUtilization() {
     try {
-        // Retrieve DDS_PATH details from the retention policy.
-        auto ddsPathIt = retentionPolicy.find("DDS_PATH");
-        if (ddsPathIt != retentionPolicy.end()) {
-            auto pathIt = ddsPathIt->second.find("value");
-            if (pathIt != ddsPathIt->second.end()) {
-                const std::string& path = pathIt->second;
-                auto [totalMemory, usedMemory, freeMemory] = fileService.get_memory_details(path);
-                
-                if (totalMemory == 0) {
-                    logger->critical("Total memory is zero", 
-                                     createLogInfo({{"detail", "Cannot calculate disk space utilization"}}), 
-                                     "RETENTION_ERR", true, "05020");
-                    return 0.0;
-                }
-
-                double utilization = static_cast<double>(usedMemory) / totalMemory * 100.0;
-                logger->info("Disk space utilization calculated", 
-                             createLogInfo({{"Utilization", std::to_string(utilization) + "%"}}));
-                return utilization;
+        // DDS_PATH resolved at construction; the map is only consulted to report what is missing.
+        if (!policy.ddsPath.empty()) {
+            double utilization = DiskPressureMonitor::utilization(fileService, policy.ddsPath);
+
+            if (utilization < 0) {
+                logger->critical("Total memory is zero", 
+                                 createLogInfo({{"detail", "Cannot calculate disk space utilization"}}), 
+                                 "RETENTION_ERR", true, "05020");
+                return 0.0;
             }
+
+            asyncLogger->info(LogRecord("Disk space utilization calculated")
+                                  .addFormatted("Utilization", "%f%%", utilization));
+            return utilization;
+        }
+        if (retentionPolicy.count("DDS_PATH")) {
             logger->critical("'PATH' key missing under 'DDS_PATH'", 
                  createLogInfo({{"detail", "Retention policy for DDS_PATH is missing a 'value' key"}}), 
                  "RETENTION_ERR", true, "05021");
@@ -280,12 +420,15 @@ double RetentionController::diskSpaceUtilization() {
 bool RetentionController::checkRetentionPolicy() {
     try {
         double memoryUtilization = diskSpaceUtilization();
-        int threshold = std::stoi(retentionPolicy.at("THRESHOLD_STORAGE_UTILIZATION").at("value"));
+        if (!policy.hasThreshold) {
+            throw std::runtime_error("THRESHOLD_STORAGE_UTILIZATION is missing or not a number");
+        }
+        int threshold = policy.thresholdPercent;
         bool exceeded = memoryUtilization > threshold;
         
         if (exceeded) {
-            logger->info("Storage threshold exceeded", 
-                         createLogInfo({{"Utilization", std::to_string(memoryUtilization) + "%, Threshold: " + std::to_string(threshold) + "%"}}));
+            asyncLogger->info(LogRecord("Storage threshold exceeded")
+                                  .addFormatted("Utilization", "%f%%, Threshold: %d%%", memoryUtilization, threshold));
         }
         
         return exceeded;
@@ -305,58 +448,62 @@ bool RetentionController::checkRetentionPolicy() {
 // Determines whether a file is eligible for deletion based on its age and the matching retention policy.
 bool RetentionController::isFileEligibleForDeletion(const std::string& filePath) {
     try {
-        // Identify policy key suffix based on file path
-        std::string policyKeySuffix;
-        if (filePath.find("/Videos/") != std::string::npos) {
-            policyKeySuffix = "VIDEO_RETENTION_POLICY";
-        } else if (filePath.find("/Analysis/") != std::string::npos) {
-            policyKeySuffix = "PARQUET_RETENTION_POLICY";
-        } else if (filePath.find("/Diagnostics/") != std::string::npos) {
-            policyKeySuffix = "DIAGNOSTIC_RETENTION_POLICY";
-        } else if (filePath.find("/Logs/") != std::string::npos) {
-            policyKeySuffix = "LOG_RETENTION_POLICY";
-        } else if (filePath.find("/VideoClips/") != std::string::npos) {
-            policyKeySuffix = "VIDEO_CLIPS_RETENTION_POLICY";
-        } else {
-            logger->info("No policy key matched for file", createLogInfo({{"detail", filePath}}));
+        PathMatch match = policy.classifier.classify(filePath);
+        if (match.category == FileCategory::Unknown) {
+            if (allowPerFileLog()) {
+                asyncLogger->info(LogRecord("No policy key matched for file").add("detail", filePath));
+            }
             return false;
         }
 
-        // Try to find the matching station-specific retention key
-        std::string matchedKey;
-        int retentionPeriod = 0;
-
-        for (const auto& [key, config] : retentionPolicy) {
-            if (key.find(policyKeySuffix) != std::string::npos) {
-                const std::string& policyPath = config.at("value");
-                if (filePath.find(policyPath) != std::string::npos) {
-                    matchedKey = key;
-                    if (config.find("retentionPeriod") != config.end()) {
-                        retentionPeriod = std::stoi(config.at("retentionPeriod"));
-                    } else {
-                        logger->warning("Missing 'retentionPeriod' for key", createLogInfo({{"key", key}}));
-                        return false;
-                    }
-                    break;
-                }
+        // Most specific station-specific rule for this category
+        const RetentionRule* rule = match.rule;
+        if (!rule) {
+            if (allowPerFileLog()) {
+                asyncLogger->info(LogRecord("No station-specific policy matched file").add("file", filePath));
             }
+            return false;
         }
-
-        if (matchedKey.empty()) {
-            logger->info("No station-specific policy matched file", createLogInfo({{"file", filePath}}));
+        if (!match.extensionAllowed) {
+            if (allowPerFileLog()) {
+                asyncLogger->info(LogRecord("File type not covered by policy")
+                                      .add("file", filePath)
+                                      .add("matched_policy", rule->key));
+            }
+            return false;
+        }
+        const RuleProgram& program = policy.deletionRules[categoryIndex(match.category)];
+        if (program.needs(RULE_INPUT_RETENTION) && !rule->hasRetentionPeriod) {
+            asyncLogger->warning(LogRecord("Missing 'retentionPeriod' for key").add("key", rule->key));
             return false;
         }
 
-        int fileAge = fileService.get_file_age_in_hours(filePath);
-        logger->info("Checking file eligibility", 
-                     createLogInfo({
-                         {"file", filePath}, 
-                         {"age", std::to_string(fileAge) + " hours"}, 
-                         {"retention_period", std::to_string(retentionPeriod) + " hours"},
-                         {"matched_policy", matchedKey}
-                     }));
+        FileFacts facts;
+        facts.category = match.category;
+        facts.extension = fileExtension(filePath);
+        facts.retentionHours = rule->retentionHours;
+        if (program.needs(RULE_INPUT_AGE)) {
+            facts.ageHours = fileService.get_file_age_in_hours(filePath);
+        }
+        if (program.needs(RULE_INPUT_SIZE)) {
+            std::error_code ec;
+            auto size = std::filesystem::file_size(filePath, ec);
+            facts.sizeBytes = ec ? 0 : size;
+        }
+        // Files under the DDS path are the archived copies
+        facts.archived = [] { return true; };
+
+        bool eligible = program.evaluate(facts);
+        if (allowPerFileLog()) {
+            asyncLogger->info(LogRecord("Checking file eligibility")
+                                  .add("file", filePath)
+                                  .addFormatted("age", "%.0f hours", facts.ageHours)
+                                  .add("rule", program.source())
+                                  .add("matched_policy", rule->key)
+                                  .add("eligible", eligible));
+        }
 
-        return fileAge > retentionPeriod;
+        return eligible;
 
     } catch (const std::exception& e) {
         logger->error("Error checking file eligibility", 
@@ -391,9 +538,29 @@ bool RetentionController::checkFilePermissions(const std::string& filePath) {
 void RetentionController::stopPipeline(const std::vector<std::string>& directories) {
     for (const auto& directory : directories) {
         if (fileService.is_directory_empty(directory)) {
-            logger->info("Deleting Empty Directory", 
-                         createLogInfo({{"detail", directory}}));
+            if (allowPerFileLog()) {
+                asyncLogger->info(LogRecord("Deleting Empty Directory").add("detail", directory));
+            }
             fileService.delete_directory(directory);
+            BinaryEventLog::getInstance().record(EventId::DirectoryDeleted, directory, {});
         }
     }
 }
+
+// Deletes a file and records it in the pipeline counters.
+void RetentionController::deleteFile(const std::string& file, PipelineCounters& counters) {
+    std::error_code ec;
+    auto size = std::filesystem::file_size(file, ec);
+    if (allowPerFileLog()) {
+        asyncLogger->info(LogRecord("Deleting File").add("file", file));
+    }
+    {
+        IoBudget::Permit permit(IoBudget::getInstance());
+        fileService.delete_file(file);
+    }
+    ++counters.deleted;
+    if (!ec) {
+        counters.bytesDeleted += size;
+    }
+    BinaryEventLog::getInstance().record(EventId::FileDeleted, file, {ec ? 0 : static_cast<std::int64_t>(size)});
+}
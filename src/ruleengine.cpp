@@ -0,0 +1,396 @@
+#include "ruleengine.hpp"
+#include "configservice.hpp"
+#include <cctype>
+#include <cstdlib>
+#include <stdexcept>
+
+namespace {
+    bool equalsKeyword(std::string_view word, const char* keyword) {
+        std::size_t i = 0;
+        for (; i < word.size() && keyword[i] != '\0'; ++i) {
+            if (std::tolower(static_cast<unsigned char>(word[i])) != keyword[i]) return false;
+        }
+        return i == word.size() && keyword[i] == '\0';
+    }
+
+    bool isWordChar(char c) {
+        return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '.' || c == '-';
+    }
+}
+
+class RuleProgram::Parser {
+public:
+    Parser(std::string_view source, RuleProgram& program) : source(source), program(program) {}
+
+    void parse() {
+        parseOr();
+        Token token = next();
+        if (token.kind != Token::End) {
+            fail(token, "unexpected '" + std::string(token.text) + "'");
+        }
+    }
+
+private:
+    struct Token {
+        enum Kind { Word, Symbol, End } kind;
+        std::string_view text;
+        std::size_t position;
+    };
+
+    Token lex(std::size_t& position) const {
+        while (position < source.size() && std::isspace(static_cast<unsigned char>(source[position]))) {
+            ++position;
+        }
+        std::size_t start = position;
+        if (position >= source.size()) {
+            return {Token::End, {}, start};
+        }
+
+        char c = source[position];
+        if (c == '"' || c == '\'') {
+            std::size_t close = source.find(c, position + 1);
+            if (close == std::string_view::npos) {
+                throw std::invalid_argument("rule: unterminated quote at position " + std::to_string(start));
+            }
+            position = close + 1;
+            return {Token::Word, source.substr(start + 1, close - start - 1), start};
+        }
+        if (isWordChar(c)) {
+            while (position < source.size() && isWordChar(source[position])) ++position;
+            return {Token::Word, source.substr(start, position - start), start};
+        }
+        if ((c == '<' || c == '>' || c == '=' || c == '!') && position + 1 < source.size() && source[position + 1] == '=') {
+            position += 2;
+            return {Token::Symbol, source.substr(start, 2), start};
+        }
+        ++position;
+        return {Token::Symbol, source.substr(start, 1), start};
+    }
+
+    Token peek() const {
+        std::size_t position = cursor;
+        return lex(position);
+    }
+
+    Token next() { return lex(cursor); }
+
+    bool acceptKeyword(const char* keyword) {
+        Token token = peek();
+        if (token.kind == Token::Word && equalsKeyword(token.text, keyword)) {
+            next();
+            return true;
+        }
+        return false;
+    }
+
+    bool acceptSymbol(const char* symbol) {
+        Token token = peek();
+        if (token.kind == Token::Symbol && token.text == symbol) {
+            next();
+            return true;
+        }
+        return false;
+    }
+
+    void expectSymbol(const char* symbol) {
+        Token token = next();
+        if (token.kind != Token::Symbol || token.text != symbol) {
+            fail(token, std::string("expected '") + symbol + "'");
+        }
+    }
+
+    [[noreturn]] void fail(const Token& token, const std::string& message) const {
+        throw std::invalid_argument("rule: " + message + " at position " + std::to_string(token.position));
+    }
+
+    std::size_t emit(Instruction instruction) {
+        program.code.push_back(instruction);
+        return program.code.size() - 1;
+    }
+
+    void patchJumps(const std::vector<std::size_t>& jumps) {
+        for (std::size_t jump : jumps) {
+            program.code[jump].argument = static_cast<std::uint32_t>(program.code.size());
+        }
+    }
+
+    void parseOr() {
+        std::vector<std::size_t> jumps;
+        parseAnd();
+        while (acceptKeyword("or")) {
+            jumps.push_back(emit({Op::JumpIfTrue}));
+            parseAnd();
+        }
+        patchJumps(jumps);
+    }
+
+    void parseAnd() {
+        std::vector<std::size_t> jumps;
+        parseFactor();
+        while (acceptKeyword("and")) {
+            jumps.push_back(emit({Op::JumpIfFalse}));
+            parseFactor();
+        }
+        patchJumps(jumps);
+    }
+
+    void parseFactor() {
+        Token token = next();
+        if (token.kind == Token::Symbol && token.text == "(") {
+            parseOr();
+            expectSymbol(")");
+            return;
+        }
+        if (token.kind != Token::Word) {
+            fail(token, "expected a condition");
+        }
+
+        if (equalsKeyword(token.text, "not")) {
+            parseFactor();
+            emit({Op::Not});
+        } else if (equalsKeyword(token.text, "true") || equalsKeyword(token.text, "false")) {
+            Instruction instruction{Op::Const};
+            instruction.constant = equalsKeyword(token.text, "true") ? 1 : 0;
+            emit(instruction);
+        } else if (equalsKeyword(token.text, "archived")) {
+            program.inputs |= RULE_INPUT_ARCHIVED;
+            emit({Op::Archived});
+        } else if (equalsKeyword(token.text, "ext")) {
+            parseExtensionTest();
+        } else if (equalsKeyword(token.text, "category")) {
+            parseCategoryTest();
+        } else {
+            parseComparison(token);
+        }
+    }
+
+    // Parses "== name", "!= name" or "in [names]"; returns true if the test is negated.
+    bool parseNames(std::vector<std::string_view>& names) {
+        Token token = next();
+        bool negated = false;
+        if (token.kind == Token::Symbol && (token.text == "==" || token.text == "!=")) {
+            negated = token.text == "!=";
+            Token name = next();
+            if (name.kind != Token::Word) fail(name, "expected a name");
+            names.push_back(name.text);
+            return negated;
+        }
+        if (token.kind != Token::Word || !equalsKeyword(token.text, "in")) {
+            fail(token, "expected '==', '!=' or 'in'");
+        }
+        expectSymbol("[");
+        do {
+            Token name = next();
+            if (name.kind != Token::Word) fail(name, "expected a name");
+            names.push_back(name.text);
+        } while (acceptSymbol(","));
+        expectSymbol("]");
+        return negated;
+    }
+
+    void parseExtensionTest() {
+        std::vector<std::string_view> names;
+        bool negated = parseNames(names);
+
+        std::vector<std::string> extensions;
+        for (std::string_view name : names) {
+            if (!name.empty() && name.front() == '.') name.remove_prefix(1);
+            extensions.emplace_back(name);
+        }
+        ExtensionTable table;
+        table.build(extensions);
+        program.extensionSets.push_back(std::move(table));
+
+        Instruction instruction{Op::ExtensionIn};
+        instruction.argument = static_cast<std::uint32_t>(program.extensionSets.size() - 1);
+        emit(instruction);
+        if (negated) emit({Op::Not});
+    }
+
+    void parseCategoryTest() {
+        std::size_t position = cursor;
+        std::vector<std::string_view> names;
+        bool negated = parseNames(names);
+
+        Instruction instruction{Op::CategoryIn};
+        for (std::string_view name : names) {
+            FileCategory category = categoryOfComponent(name);
+            if (category == FileCategory::Unknown) {
+                fail({Token::Word, name, position}, "unknown category '" + std::string(name) + "'");
+            }
+            instruction.argument |= 1u << categoryIndex(category);
+        }
+        emit(instruction);
+        if (negated) emit({Op::Not});
+    }
+
+    Operand operandOf(std::string_view word) {
+        if (equalsKeyword(word, "age")) {
+            program.inputs |= RULE_INPUT_AGE;
+            return Operand::Age;
+        }
+        if (equalsKeyword(word, "size")) {
+            program.inputs |= RULE_INPUT_SIZE;
+            return Operand::Size;
+        }
+        if (equalsKeyword(word, "retention")) {
+            program.inputs |= RULE_INPUT_RETENTION;
+            return Operand::Retention;
+        }
+        return Operand::Constant;
+    }
+
+    // Hours per unit for age/retention, bytes per unit for size.
+    double parseQuantity(const Token& token, Operand field) {
+        std::string text(token.text);
+        char* end = nullptr;
+        double value = std::strtod(text.c_str(), &end);
+        if (end == text.c_str()) {
+            fail(token, "expected a number or field, got '" + text + "'");
+        }
+        std::string_view unit(end);
+
+        static const std::pair<const char*, double> timeUnits[] = {
+            {"", 1}, {"m", 1.0 / 60}, {"h", 1}, {"d", 24}, {"w", 168}
+        };
+        static const std::pair<const char*, double> sizeUnits[] = {
+            {"", 1}, {"b", 1}, {"kb", 1024.0}, {"mb", 1024.0 * 1024}, {"gb", 1024.0 * 1024 * 1024},
+            {"tb", 1024.0 * 1024 * 1024 * 1024}
+        };
+        if (field == Operand::Size) {
+            for (const auto& [name, scale] : sizeUnits) {
+                if (equalsKeyword(unit, name)) return value * scale;
+            }
+        } else {
+            for (const auto& [name, scale] : timeUnits) {
+                if (equalsKeyword(unit, name)) return value * scale;
+            }
+        }
+        fail(token, "unit '" + std::string(unit) + "' does not apply here");
+    }
+
+    void parseComparison(const Token& fieldToken) {
+        Instruction instruction{Op::Compare};
+        instruction.lhs = operandOf(fieldToken.text);
+        if (instruction.lhs == Operand::Constant) {
+            fail(fieldToken, "unknown field '" + std::string(fieldToken.text) + "'");
+        }
+
+        static const std::pair<const char*, Comparison> comparisons[] = {
+            {"<", Comparison::Less}, {"<=", Comparison::LessEqual}, {">", Comparison::Greater},
+            {">=", Comparison::GreaterEqual}, {"==", Comparison::Equal}, {"!=", Comparison::NotEqual}
+        };
+        Token op = next();
+        bool known = false;
+        for (const auto& [symbol, comparison] : comparisons) {
+            if (op.kind == Token::Symbol && op.text == symbol) {
+                instruction.comparison = comparison;
+                known = true;
+            }
+        }
+        if (!known) fail(op, "expected a comparison");
+
+        Token value = next();
+        if (value.kind != Token::Word) fail(value, "expected a number or field");
+        instruction.rhs = operandOf(value.text);
+        if (instruction.rhs == Operand::Constant) {
+            instruction.constant = parseQuantity(value, instruction.lhs);
+        } else if ((instruction.lhs == Operand::Size) != (instruction.rhs == Operand::Size)) {
+            fail(value, "cannot compare size with a time");
+        }
+        emit(instruction);
+    }
+
+    std::string_view source;
+    RuleProgram& program;
+    std::size_t cursor = 0;
+};
+
+RuleProgram RuleProgram::compile(std::string_view expression) {
+    RuleProgram program;
+    program.text = std::string(expression);
+    Parser(program.text, program).parse();
+    return program;
+}
+
+bool RuleProgram::evaluate(const FileFacts& facts) const {
+    auto load = [&facts](Operand operand, double constant) {
+        switch (operand) {
+            case Operand::Age: return facts.ageHours;
+            case Operand::Size: return static_cast<double>(facts.sizeBytes);
+            case Operand::Retention: return facts.retentionHours;
+            case Operand::Constant: break;
+        }
+        return constant;
+    };
+
+    bool accumulator = false;
+    std::size_t pc = 0;
+    while (pc < code.size()) {
+        const Instruction& instruction = code[pc++];
+        switch (instruction.op) {
+            case Op::Const:
+                accumulator = instruction.constant != 0;
+                break;
+            case Op::Compare: {
+                double lhs = load(instruction.lhs, instruction.constant);
+                double rhs = load(instruction.rhs, instruction.constant);
+                switch (instruction.comparison) {
+                    case Comparison::Less: accumulator = lhs < rhs; break;
+                    case Comparison::LessEqual: accumulator = lhs <= rhs; break;
+                    case Comparison::Greater: accumulator = lhs > rhs; break;
+                    case Comparison::GreaterEqual: accumulator = lhs >= rhs; break;
+                    case Comparison::Equal: accumulator = lhs == rhs; break;
+                    case Comparison::NotEqual: accumulator = lhs != rhs; break;
+                }
+                break;
+            }
+            case Op::ExtensionIn:
+                accumulator = extensionSets[instruction.argument].find(facts.extension) >= 0;
+                break;
+            case Op::CategoryIn:
+                accumulator = facts.category != FileCategory::Unknown &&
+                              (instruction.argument & (1u << categoryIndex(facts.category))) != 0;
+                break;
+            case Op::Archived:
+                accumulator = facts.archived && facts.archived();
+                break;
+            case Op::Not:
+                accumulator = !accumulator;
+                break;
+            case Op::JumpIfFalse:
+                if (!accumulator) pc = instruction.argument;
+                break;
+            case Op::JumpIfTrue:
+                if (accumulator) pc = instruction.argument;
+                break;
+        }
+    }
+    return accumulator;
+}
+
+std::array<RuleProgram, FILE_CATEGORY_COUNT> compileCategoryRules(
+    const nlohmann::json& expressions,
+    const std::array<std::string, FILE_CATEGORY_COUNT>& defaults,
+    std::vector<std::string>& errors) {
+    std::array<RuleProgram, FILE_CATEGORY_COUNT> programs;
+    for (std::size_t i = 0; i < FILE_CATEGORY_COUNT; ++i) {
+        const char* directory = categoryDirectory(static_cast<FileCategory>(i));
+        if (expressions.is_object() && expressions.contains(directory) && expressions[directory].is_string()) {
+            try {
+                programs[i] = RuleProgram::compile(expressions[directory].get<std::string>());
+                continue;
+            } catch (const std::invalid_argument& e) {
+                errors.push_back(std::string(directory) + ": " + e.what());
+            }
+        }
+        programs[i] = RuleProgram::compile(defaults[i]);
+    }
+    return programs;
+}
+
+nlohmann::json loadRuleExpressions() {
+    auto snapshot = ConfigService::getInstance().current();
+    const auto& rules = snapshot->section("rules");
+    return rules.is_object() ? rules : nlohmann::json::object();
+}
@@ -0,0 +1,237 @@
+#include "schedulerstate.hpp"
+#include "configservice.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <unistd.h>
+#include <nlohmann/json.hpp>
+
+namespace {
+    constexpr int STATE_FORMAT_VERSION = 1;
+    // Cursor updates between directories are written at most this often
+    constexpr auto CHECKPOINT_INTERVAL = std::chrono::seconds(10);
+
+    // Reads scheduler.state_file from the config snapshot.
+    std::string loadStatePath() {
+        std::string path = "efms_scheduler_state.json";  // Default value
+        try {
+            path = ConfigService::getInstance().current()->section("scheduler").value("state_file", path);
+        } catch (const nlohmann::json::exception& e) {
+            // Keep defaults
+        }
+        return path;
+    }
+
+    std::string parentOf(const std::string& file) {
+        auto slash = file.rfind('/');
+        return slash == std::string::npos ? std::string() : file.substr(0, slash);
+    }
+
+    // Writes the whole buffer, retrying on short writes and EINTR.
+    bool writeAll(int fd, const std::string& data) {
+        const char* cursor = data.data();
+        std::size_t remaining = data.size();
+        while (remaining > 0) {
+            ssize_t written = ::write(fd, cursor, remaining);
+            if (written < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            cursor += written;
+            remaining -= static_cast<std::size_t>(written);
+        }
+        return true;
+    }
+}
+
+std::vector<DirectoryBatch> groupByDirectory(const std::vector<std::string>& files) {
+    std::vector<std::pair<std::string, const std::string*>> keyed;
+    keyed.reserve(files.size());
+    for (const auto& file : files) {
+        keyed.emplace_back(parentOf(file), &file);
+    }
+    std::sort(keyed.begin(), keyed.end(), [](const auto& a, const auto& b) {
+        return a.first != b.first ? a.first < b.first : *a.second < *b.second;
+    });
+
+    std::vector<DirectoryBatch> batches;
+    for (auto& [directory, file] : keyed) {
+        if (batches.empty() || batches.back().directory != directory) {
+            batches.push_back(DirectoryBatch{std::move(directory), {}});
+        }
+        batches.back().files.push_back(*file);
+    }
+    return batches;
+}
+
+std::size_t resumeIndex(const std::vector<std::string>& roots, const ScanCursor& cursor) {
+    if (cursor.empty()) return 0;
+    auto it = std::find(roots.begin(), roots.end(), cursor.root);
+    return it == roots.end() ? 0 : static_cast<std::size_t>(it - roots.begin());
+}
+
+std::size_t resumeOffset(const std::string& root, const DirectoryBatch& batch, const ScanCursor& cursor) {
+    if (cursor.root != root || batch.directory > cursor.directory) return 0;
+    if (batch.directory < cursor.directory || cursor.file.empty()) return batch.files.size();
+    // Files are sorted within a batch
+    return static_cast<std::size_t>(
+        std::upper_bound(batch.files.begin(), batch.files.end(), cursor.file) - batch.files.begin());
+}
+
+SchedulerState& SchedulerState::getInstance() {
+    static SchedulerState instance(loadStatePath());
+    return instance;
+}
+
+SchedulerState::SchedulerState(std::string path) : path(std::move(path)) {
+    if (this->path.empty()) return;
+    std::error_code ec;
+    auto parent = std::filesystem::path(this->path).parent_path();
+    if (!parent.empty()) {
+        std::filesystem::create_directories(parent, ec);
+    }
+    load();
+}
+
+void SchedulerState::load() {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        return;  // First start
+    }
+    try {
+        nlohmann::json document;
+        file >> document;
+        if (document.value("version", 0) != STATE_FORMAT_VERSION) {
+            std::cerr << "Ignoring scheduler state " << path << ": unsupported version" << std::endl;
+            return;
+        }
+        for (const auto& [job, entry] : document.at("jobs").items()) {
+            JobState state;
+            if (entry.contains("last_run")) {
+                state.lastRun = std::chrono::system_clock::time_point(
+                    std::chrono::seconds(entry["last_run"].get<std::int64_t>()));
+            }
+            if (entry.contains("cursor")) {
+                state.cursor.root = entry["cursor"].value("root", "");
+                state.cursor.directory = entry["cursor"].value("directory", "");
+                state.cursor.file = entry["cursor"].value("file", "");
+            }
+            jobs[job] = std::move(state);
+        }
+    } catch (const nlohmann::json::exception& e) {
+        // The rename keeps the file whole, but it may have been edited by hand
+        jobs.clear();
+        std::cerr << "Ignoring unreadable scheduler state " << path << ": " << e.what() << std::endl;
+    }
+}
+
+std::optional<std::chrono::system_clock::time_point> SchedulerState::lastRun(const std::string& job) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = jobs.find(job);
+    return it == jobs.end() ? std::nullopt : it->second.lastRun;
+}
+
+void SchedulerState::setLastRun(const std::string& job, std::chrono::system_clock::time_point when) {
+    std::lock_guard<std::mutex> lock(mutex);
+    jobs[job].lastRun = when;
+    dirty = true;
+}
+
+ScanCursor SchedulerState::cursor(const std::string& job) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = jobs.find(job);
+    return it == jobs.end() ? ScanCursor() : it->second.cursor;
+}
+
+void SchedulerState::setCursor(const std::string& job, const ScanCursor& cursor) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& current = jobs[job].cursor;
+    if (current.root == cursor.root && current.directory == cursor.directory && current.file == cursor.file) return;
+    current = cursor;
+    dirty = true;
+}
+
+bool SchedulerState::checkpoint() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!dirty || std::chrono::steady_clock::now() - lastSave < CHECKPOINT_INTERVAL) {
+            return true;
+        }
+    }
+    return save();
+}
+
+bool SchedulerState::save() {
+    std::lock_guard<std::mutex> saving(saveMutex);
+    nlohmann::json document;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!dirty) return true;
+        dirty = false;
+        lastSave = std::chrono::steady_clock::now();
+        if (path.empty()) return true;
+
+        nlohmann::json entries = nlohmann::json::object();
+        for (const auto& [job, state] : jobs) {
+            nlohmann::json entry = nlohmann::json::object();
+            if (state.lastRun) {
+                entry["last_run"] = std::chrono::duration_cast<std::chrono::seconds>(
+                    state.lastRun->time_since_epoch()).count();
+            }
+            if (!state.cursor.empty()) {
+                entry["cursor"] = {{"root", state.cursor.root}, {"directory", state.cursor.directory}};
+                if (!state.cursor.file.empty()) {
+                    entry["cursor"]["file"] = state.cursor.file;
+                }
+            }
+            if (!entry.empty()) {
+                entries[job] = std::move(entry);
+            }
+        }
+        document = {{"version", STATE_FORMAT_VERSION}, {"jobs", std::move(entries)}};
+    }
+
+    bool ok = write(document.dump(2) + "\n");
+    const int error = ok ? 0 : errno;
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!ok) {
+        // Retried at the next save; reported once per failure streak
+        dirty = true;
+        if (!lastSaveFailed) {
+            std::cerr << "Failed to save scheduler state " << path << ": " << std::strerror(error) << std::endl;
+        }
+    }
+    lastSaveFailed = !ok;
+    return ok;
+}
+
+bool SchedulerState::write(const std::string& contents) {
+    const std::string temporary = path + ".tmp";
+    int fd = ::open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    // Durable before it replaces the previous state
+    bool ok = writeAll(fd, contents) && ::fsync(fd) == 0;
+    ok = ::close(fd) == 0 && ok;
+    if (!ok || ::rename(temporary.c_str(), path.c_str()) != 0) {
+        int error = errno;
+        ::unlink(temporary.c_str());
+        errno = error;
+        return false;
+    }
+
+    // Make the rename itself durable
+    std::string directory = std::filesystem::path(path).parent_path().string();
+    int dirFd = ::open(directory.empty() ? "." : directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dirFd >= 0) {
+        ::fsync(dirFd);
+        ::close(dirFd);
+    }
+    return true;
+}
@@ -0,0 +1,149 @@
+#include "schemamigrator.hpp"
+#include "connectionpool.hpp"
+#include "dbwriter.hpp"
+#include "logutils.hpp"
+#include <iostream>
+
+namespace {
+    // Arbitrary key for pg_advisory_lock so two EFMS instances never migrate concurrently.
+    const long long MIGRATION_LOCK_KEY = 0x4546'4D53'0001LL;
+    // Longest a migration statement waits for a table lock held by the recorder or an operator
+    const char* MIGRATION_LOCK_TIMEOUT = "10s";
+}
+
+SchemaMigrator::SchemaMigrator(LoggingService* logger) : logger(logger) {}
+
+// Append new migrations at the end with the next version number; never edit applied ones.
+const std::vector<SchemaMigration>& SchemaMigrator::migrations() {
+    static const std::vector<SchemaMigration> list = {
+        {1, "Index analytics by video location (covers DDS video location)",
+         "CREATE INDEX CONCURRENTLY IF NOT EXISTS idx_analytics_video_file_location "
+         "ON analytics (video_file_location) INCLUDE (dds_video_file_location)",
+         "idx_analytics_video_file_location"},
+        {2, "Index analytics by parquet location (covers DDS parquet location)",
+         "CREATE INDEX CONCURRENTLY IF NOT EXISTS idx_analytics_parquet_file_location "
+         "ON analytics (parquet_file_location) INCLUDE (dds_parquet_file_location)",
+         "idx_analytics_parquet_file_location"},
+        {3, "Index incident by process and message, newest first",
+         "CREATE INDEX CONCURRENTLY IF NOT EXISTS idx_incident_process_message_time "
+         "ON incident (process_name, incident_message, incident_time DESC)",
+         "idx_incident_process_message_time"},
+        {4, "Index recovery by incident for the active-incident join",
+         "CREATE INDEX CONCURRENTLY IF NOT EXISTS idx_recovery_incident_id "
+         "ON recovery (incident_id)",
+         "idx_recovery_incident_id"},
+        {5, "Notify EFMS of new or updated analytics file locations",
+         "CREATE OR REPLACE FUNCTION efms_notify_analytics_insert() RETURNS trigger AS $$ "
+         "BEGIN "
+         "PERFORM pg_notify('efms_analytics_insert', json_build_object("
+         "'video_file_location', NEW.video_file_location, "
+         "'parquet_file_location', NEW.parquet_file_location)::text); "
+         "RETURN NEW; "
+         "END; $$ LANGUAGE plpgsql; "
+         "DROP TRIGGER IF EXISTS efms_analytics_insert_notify ON analytics; "
+         "CREATE TRIGGER efms_analytics_insert_notify "
+         "AFTER INSERT OR UPDATE OF video_file_location, parquet_file_location ON analytics "
+         "FOR EACH ROW EXECUTE FUNCTION efms_notify_analytics_insert()",
+         ""}
+    };
+    return list;
+}
+
+int SchemaMigrator::latestVersion() {
+    return migrations().empty() ? 0 : migrations().back().version;
+}
+
+bool SchemaMigrator::migrate() {
+    try {
+        auto lease = ConnectionPool::getInstance().acquire();
+        pqxx::connection& connection = *lease;
+
+        {
+            pqxx::nontransaction setup(connection);
+            setup.exec("CREATE TABLE IF NOT EXISTS efms_schema_version ("
+                       "version INTEGER PRIMARY KEY, "
+                       "description TEXT NOT NULL, "
+                       "applied_at TIMESTAMPTZ NOT NULL DEFAULT NOW())");
+            setup.exec(std::string("SET lock_timeout = '") + MIGRATION_LOCK_TIMEOUT + "'");
+            // Another instance migrating now brings the schema up to date without us
+            auto locked = setup.exec("SELECT pg_try_advisory_lock(" + std::to_string(MIGRATION_LOCK_KEY) + ")");
+            if (locked.empty() || !locked[0][0].as<bool>()) {
+                logger->info("Schema migration skipped, another instance holds the migration lock",
+                             createLogInfo({{"latest", latestVersion()}}), "SCHEMA_MIGRATE_BUSY");
+                return false;
+            }
+        }
+
+        bool success = true;
+        int version = 0;
+        try {
+            version = currentVersion(connection);
+            for (const auto& migration : migrations()) {
+                if (migration.version <= version) continue;
+
+                try {
+                    logger->info("Applying schema migration",
+                                 createLogInfo({{"version", migration.version}, {"description", migration.description}}),
+                                 "SCHEMA_MIGRATE");
+                    applyMigration(connection, migration);
+                    version = migration.version;
+                } catch (const std::exception& e) {
+                    nlohmann::json errInfo = createLogInfo({{"version", migration.version}, {"detail", e.what()}});
+                    logger->error("Schema migration failed", errInfo, "SCHEMA_MIGRATE_FAIL", true, "05026");
+                    DbWriter::getInstance().enqueueIncident("Schema migration failed", errInfo, "05026",
+                                                            "DB_OPERATION_FAIL", "05003", logger);
+                    success = false;
+                    break;
+                }
+            }
+        } catch (...) {
+            // Closing the session releases the advisory lock
+            lease.invalidate();
+            throw;
+        }
+
+        pqxx::nontransaction teardown(connection);
+        teardown.exec("SELECT pg_advisory_unlock(" + std::to_string(MIGRATION_LOCK_KEY) + ")");
+
+        logger->info("Schema version", createLogInfo({{"version", version}, {"latest", latestVersion()}}), "SCHEMA_VERSION");
+        return success;
+    } catch (const std::exception& e) {
+        // Database unreachable: run with the existing schema and retry on next start
+        std::cerr << "Schema migration skipped: " << e.what() << std::endl;
+        logger->error("Schema migration skipped", createLogInfo({{"detail", e.what()}}), "SCHEMA_MIGRATE_SKIP", false, "05027");
+        return false;
+    }
+}
+
+int SchemaMigrator::currentVersion(pqxx::connection& connection) {
+    pqxx::nontransaction txn(connection);
+    auto result = txn.exec("SELECT COALESCE(MAX(version), 0) FROM efms_schema_version");
+    return result.empty() ? 0 : result[0][0].as<int>();
+}
+
+void SchemaMigrator::applyMigration(pqxx::connection& connection, const SchemaMigration& migration) {
+    if (!migration.indexName.empty()) {
+        // A previously interrupted concurrent build leaves an INVALID index that IF NOT EXISTS would keep.
+        dropInvalidIndex(connection, migration.indexName);
+
+        pqxx::nontransaction build(connection);
+        build.exec(migration.sql);
+    }
+
+    pqxx::work txn(connection);
+    if (migration.indexName.empty()) {
+        txn.exec(migration.sql);
+    }
+    txn.exec("INSERT INTO efms_schema_version (version, description) VALUES (" +
+             std::to_string(migration.version) + ", " + txn.quote(migration.description) + ")");
+    txn.commit();
+}
+
+void SchemaMigrator::dropInvalidIndex(pqxx::connection& connection, const std::string& indexName) {
+    pqxx::nontransaction txn(connection);
+    auto result = txn.exec("SELECT 1 FROM pg_index i JOIN pg_class c ON c.oid = i.indexrelid "
+                           "WHERE c.relname = " + txn.quote(indexName) + " AND NOT i.indisvalid");
+    if (!result.empty()) {
+        txn.exec("DROP INDEX CONCURRENTLY IF EXISTS " + indexName);
+    }
+}
@@ -0,0 +1,214 @@
+#include "taskexecutor.hpp"
+#include "configservice.hpp"
+#include "threadisolation.hpp"
+#include <algorithm>
+#include <chrono>
+#include <optional>
+#include <nlohmann/json.hpp>
+
+namespace {
+    // Executor the current thread works for, and its index there
+    thread_local const TaskExecutor* currentExecutor = nullptr;
+    thread_local std::size_t currentWorker = 0;
+    // Tasks running on this thread; above 1 while a waiting task helps with queued ones
+    thread_local int taskDepth = 0;
+
+    // Reads executor.workers from the config snapshot; 0 picks a size from the hardware.
+    std::size_t loadWorkerCount() {
+        int workers = 0;  // Default value
+        try {
+            workers = ConfigService::getInstance().current()->section("executor").value("workers", workers);
+        } catch (const nlohmann::json::exception& e) {
+            // Keep defaults
+        }
+        if (workers > 0) {
+            return static_cast<std::size_t>(workers);
+        }
+        // Leave cores to the analytics stack on the edge box
+        std::size_t hardware = std::thread::hardware_concurrency();
+        return std::clamp<std::size_t>(hardware, 1, 4);
+    }
+}
+
+TaskExecutor& TaskExecutor::getInstance() {
+    static TaskExecutor instance(loadWorkerCount());
+    return instance;
+}
+
+TaskExecutor::TaskExecutor(std::size_t count) {
+    if (count == 0) count = 1;
+    workers.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        workers.push_back(std::make_unique<Worker>());
+    }
+    // Start only once every deque exists; workers steal from each other
+    for (std::size_t i = 0; i < count; ++i) {
+        workers[i]->thread = std::thread(&TaskExecutor::work, this, i);
+    }
+}
+
+TaskExecutor::~TaskExecutor() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    wakeup.notify_all();
+    for (auto& worker : workers) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+    }
+}
+
+bool TaskExecutor::onWorkerThread() const {
+    return currentExecutor == this;
+}
+
+void TaskExecutor::submit(TaskPriority priority, Task task) {
+    std::size_t target = onWorkerThread() ? currentWorker
+                                          : nextWorker.fetch_add(1, std::memory_order_relaxed) % workers.size();
+    {
+        std::lock_guard<std::mutex> lock(workers[target]->mutex);
+        workers[target]->lanes[static_cast<std::size_t>(priority)].push_back(std::move(task));
+    }
+    {
+        // Under the sleep mutex so a worker between its check and its wait cannot miss it
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        pending.fetch_add(1, std::memory_order_relaxed);
+    }
+    wakeup.notify_one();
+}
+
+bool TaskExecutor::takeTask(std::size_t self, Task& task, TaskPriority& priority) {
+    const std::size_t count = workers.size();
+    for (std::size_t lane = 0; lane < TASK_PRIORITY_COUNT; ++lane) {
+        // Own deque from the back: the most recently split work is still in cache
+        if (self < count) {
+            Worker& own = *workers[self];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.lanes[lane].empty()) {
+                task = std::move(own.lanes[lane].back());
+                own.lanes[lane].pop_back();
+                priority = static_cast<TaskPriority>(lane);
+                return true;
+            }
+        }
+        // Steal the oldest task of the others, starting after ourselves so thieves spread out
+        for (std::size_t offset = 1; offset <= count; ++offset) {
+            std::size_t victim = (self + offset) % count;
+            if (victim == self) continue;
+            Worker& other = *workers[victim];
+            std::lock_guard<std::mutex> lock(other.mutex);
+            if (!other.lanes[lane].empty()) {
+                task = std::move(other.lanes[lane].front());
+                other.lanes[lane].pop_front();
+                priority = static_cast<TaskPriority>(lane);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool TaskExecutor::runPendingTask() {
+    // Threads outside the pool steal from every worker
+    std::size_t self = onWorkerThread() ? currentWorker : workers.size();
+    Task task;
+    TaskPriority priority;
+    if (!takeTask(self, task, priority)) {
+        return false;
+    }
+    pending.fetch_sub(1, std::memory_order_relaxed);
+
+    // Run under the lane's I/O and CPU policy. A task that helps while it waits
+    // goes back to its own lane afterwards; at the top level the policy stays
+    // until a task of another lane comes along, saving the syscalls.
+    ThreadIsolation& isolation = ThreadIsolation::getInstance();
+    std::optional<TaskPriority> interrupted = taskDepth > 0 ? ThreadIsolation::current() : std::nullopt;
+    isolation.apply(priority);
+    ++taskDepth;
+    task();
+    --taskDepth;
+    if (interrupted) {
+        isolation.apply(*interrupted);
+    }
+    return true;
+}
+
+void TaskExecutor::work(std::size_t index) {
+    currentExecutor = this;
+    currentWorker = index;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            wakeup.wait(lock, [this] { return stopping || pending.load(std::memory_order_relaxed) > 0; });
+            if (stopping && pending.load(std::memory_order_relaxed) == 0) {
+                return;
+            }
+        }
+        // Another worker may have taken it first; then go back to sleep
+        runPendingTask();
+    }
+}
+
+TaskGroup::TaskGroup(TaskPriority priority, TaskExecutor& executor) : executor(executor), priority(priority) {}
+
+TaskGroup::~TaskGroup() {
+    waitForOutstanding(0);
+}
+
+void TaskGroup::run(TaskExecutor::Task task) {
+    if (maxInFlight > 0) {
+        waitForOutstanding(maxInFlight - 1);
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++outstanding;
+    }
+    executor.submit(priority, [this, task = std::move(task)] {
+        std::exception_ptr error;
+        try {
+            task();
+        } catch (...) {
+            error = std::current_exception();
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        if (error && !failure) {
+            failure = error;
+        }
+        if (--outstanding == 0 || maxInFlight > 0) {
+            done.notify_all();
+        }
+    });
+}
+
+void TaskGroup::wait() {
+    waitForOutstanding(0);
+    std::exception_ptr error;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::swap(error, failure);
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+void TaskGroup::waitForOutstanding(std::size_t limit) {
+    if (executor.onWorkerThread()) {
+        // Blocking a worker on its own subtasks could starve the pool; help instead
+        while (true) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (outstanding <= limit) return;
+            }
+            if (!executor.runPendingTask()) {
+                std::unique_lock<std::mutex> lock(mutex);
+                done.wait_for(lock, std::chrono::milliseconds(1), [this, limit] { return outstanding <= limit; });
+            }
+        }
+    }
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this, limit] { return outstanding <= limit; });
+}
@@ -0,0 +1,276 @@
+#include "threadisolation.hpp"
+#include "configservice.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <linux/capability.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+    // From linux/ioprio.h, which is not exported to user space everywhere
+    constexpr int IOPRIO_WHO_PROCESS = 1;
+    constexpr int IOPRIO_CLASS_SHIFT = 13;
+    constexpr int IOPRIO_CLASS_BE = 2;
+    constexpr int IOPRIO_CLASS_IDLE = 3;
+
+    thread_local std::optional<TaskPriority> currentLane;
+
+    const char* laneName(TaskPriority priority) {
+        switch (priority) {
+            case TaskPriority::Emergency: return "emergency";
+            case TaskPriority::Normal: return "normal";
+            case TaskPriority::Background: return "background";
+        }
+        return "unknown";
+    }
+
+    ThreadIsolation::Policies loadPolicies(bool& enabled) {
+        ThreadIsolation::Policies policies = ThreadIsolation::defaultPolicies();
+        enabled = false;
+        try {
+            const auto& isolation = ConfigService::getInstance().current()->section("isolation");
+            enabled = isolation.value("enabled", false);
+            for (std::size_t lane = 0; lane < TASK_PRIORITY_COUNT; ++lane) {
+                auto settings = isolation.find(laneName(static_cast<TaskPriority>(lane)));
+                if (settings != isolation.end()) {
+                    ThreadIsolation::parsePolicy(*settings, policies[lane]);
+                }
+            }
+        } catch (const nlohmann::json::exception& e) {
+            // Keep defaults
+        }
+        return policies;
+    }
+
+    std::string failure(const char* what) {
+        return std::string(what) + ": " + std::strerror(errno);
+    }
+
+    bool hasSysNice() {
+        __user_cap_header_struct header{};
+        header.version = _LINUX_CAPABILITY_VERSION_3;
+        header.pid = 0;
+        __user_cap_data_struct data[_LINUX_CAPABILITY_U32S_3]{};
+        if (syscall(SYS_capget, &header, data) != 0) {
+            return false;
+        }
+        return (data[CAP_TO_INDEX(CAP_SYS_NICE)].effective & CAP_TO_MASK(CAP_SYS_NICE)) != 0;
+    }
+
+    int startingNice() {
+        errno = 0;
+        int nice = getpriority(PRIO_PROCESS, 0);
+        return errno != 0 ? 0 : nice;
+    }
+
+    ThreadIsolation::Policies checkedPolicies(bool enabled, const ThreadIsolation::Policies& policies) {
+        if (!enabled) {
+            return policies;
+        }
+        const int floor = ThreadIsolation::niceFloor();
+        ThreadIsolation::Policies checked = ThreadIsolation::restorable(policies, floor, startingNice());
+        for (std::size_t lane = 0; lane < TASK_PRIORITY_COUNT; ++lane) {
+            if (checked[lane].nice != policies[lane].nice || checked[lane].schedIdle != policies[lane].schedIdle) {
+                std::cerr << "Thread isolation: nice values and SCHED_IDLE disabled for every lane; workers could "
+                             "not lower their nice value below " << floor
+                          << " again (needs CAP_SYS_NICE or a higher RLIMIT_NICE)" << std::endl;
+                break;
+            }
+        }
+        return checked;
+    }
+}
+
+ThreadIsolation& ThreadIsolation::getInstance() {
+    static ThreadIsolation instance = [] {
+        bool enabled = false;
+        Policies policies = loadPolicies(enabled);
+        return ThreadIsolation(enabled, policies);
+    }();
+    return instance;
+}
+
+ThreadIsolation::Policies ThreadIsolation::defaultPolicies() {
+    Policies policies;
+    ThreadPolicy& emergency = policies[static_cast<std::size_t>(TaskPriority::Emergency)];
+    emergency.ioClass = IoPriorityClass::BestEffort;
+    emergency.ioLevel = 0;
+
+    ThreadPolicy& normal = policies[static_cast<std::size_t>(TaskPriority::Normal)];
+    normal.ioClass = IoPriorityClass::BestEffort;
+    normal.ioLevel = 4;
+    normal.nice = 5;
+
+    ThreadPolicy& background = policies[static_cast<std::size_t>(TaskPriority::Background)];
+    background.ioClass = IoPriorityClass::Idle;
+    background.nice = 19;
+    background.schedIdle = true;
+    return policies;
+}
+
+int ThreadIsolation::niceFloor() {
+    if (hasSysNice()) {
+        return -20;
+    }
+    rlimit limit{};
+    if (getrlimit(RLIMIT_NICE, &limit) != 0) {
+        return 20;
+    }
+    if (limit.rlim_cur == RLIM_INFINITY || limit.rlim_cur >= 40) {
+        return -20;
+    }
+    return 20 - static_cast<int>(limit.rlim_cur);
+}
+
+ThreadIsolation::Policies ThreadIsolation::restorable(const Policies& policies, int floor, int startNice) {
+    int lowest = startNice;
+    int highest = startNice;
+    bool idle = false;
+    bool other = false;
+    for (const auto& policy : policies) {
+        lowest = std::min(lowest, policy.nice);
+        highest = std::max(highest, policy.nice);
+        (policy.schedIdle ? idle : other) = true;
+    }
+    // Leaving SCHED_IDLE is checked like lowering the nice value, down to the idle lane's own
+    const bool lowers = lowest < highest || (idle && other);
+    if (!lowers || lowest >= floor) {
+        return policies;
+    }
+    Policies checked = policies;
+    for (auto& policy : checked) {
+        policy.nice = startNice;
+        policy.schedIdle = false;
+    }
+    return checked;
+}
+
+ThreadIsolation::ThreadIsolation(bool enabled, const Policies& policies)
+    : enabled(enabled), policies(checkedPolicies(enabled, policies)) {
+    CPU_ZERO(&initialCpus);
+    if (sched_getaffinity(0, sizeof(initialCpus), &initialCpus) != 0) {
+        CPU_ZERO(&initialCpus);
+    }
+}
+
+const ThreadPolicy& ThreadIsolation::policy(TaskPriority priority) const {
+    return policies[static_cast<std::size_t>(priority)];
+}
+
+std::optional<TaskPriority> ThreadIsolation::current() {
+    return currentLane;
+}
+
+void ThreadIsolation::apply(TaskPriority priority) {
+    if (!enabled || currentLane == priority) {
+        return;
+    }
+    std::string problem = applyPolicy(policy(priority));
+    // A thread left partly between lanes is not in either; its next task applies its lane afresh
+    if (problem.empty()) {
+        currentLane = priority;
+    } else {
+        currentLane.reset();
+    }
+    auto& once = reported[static_cast<std::size_t>(priority)];
+    if (!problem.empty() && !once.exchange(true)) {
+        std::cerr << "Thread isolation for " << laneName(priority) << " work not fully applied: " << problem
+                  << std::endl;
+    }
+}
+
+std::string ThreadIsolation::applyPolicy(const ThreadPolicy& policy) const {
+    const pid_t tid = static_cast<pid_t>(syscall(SYS_gettid));
+    std::string problem;
+    auto note = [&problem](const std::string& what) {
+        problem += problem.empty() ? what : "; " + what;
+    };
+
+    // Scheduling class first: leaving SCHED_IDLE is what lets the nice value below count again
+    sched_param param{};
+    if (sched_setscheduler(tid, policy.schedIdle ? SCHED_IDLE : SCHED_OTHER, &param) != 0) {
+        note(failure("sched_setscheduler"));
+    }
+    // Per thread on Linux; raising priority back needs CAP_SYS_NICE or RLIMIT_NICE
+    if (setpriority(PRIO_PROCESS, static_cast<id_t>(tid), policy.nice) != 0) {
+        note(failure("setpriority"));
+    }
+
+    int ioprio = 0;
+    if (policy.ioClass == IoPriorityClass::BestEffort) {
+        ioprio = (IOPRIO_CLASS_BE << IOPRIO_CLASS_SHIFT) | policy.ioLevel;
+    } else if (policy.ioClass == IoPriorityClass::Idle) {
+        ioprio = IOPRIO_CLASS_IDLE << IOPRIO_CLASS_SHIFT;
+    }
+    if (syscall(SYS_ioprio_set, IOPRIO_WHO_PROCESS, tid, ioprio) != 0) {
+        note(failure("ioprio_set"));
+    }
+
+    cpu_set_t cpus = initialCpus;
+    if (!policy.cpus.empty()) {
+        CPU_ZERO(&cpus);
+        for (int cpu : policy.cpus) {
+            CPU_SET(cpu, &cpus);
+        }
+    }
+    if (CPU_COUNT(&cpus) > 0 && sched_setaffinity(tid, sizeof(cpus), &cpus) != 0) {
+        note(failure("sched_setaffinity"));
+    }
+    return problem;
+}
+
+std::string ThreadIsolation::parsePolicy(const nlohmann::json& settings, ThreadPolicy& policy) {
+    if (!settings.is_object()) {
+        return "must be an object";
+    }
+    if (settings.contains("io_class")) {
+        const auto& ioClass = settings["io_class"];
+        std::string name = ioClass.is_string() ? ioClass.get<std::string>() : "";
+        if (name == "none") {
+            policy.ioClass = IoPriorityClass::None;
+        } else if (name == "best-effort") {
+            policy.ioClass = IoPriorityClass::BestEffort;
+        } else if (name == "idle") {
+            policy.ioClass = IoPriorityClass::Idle;
+        } else {
+            return "io_class must be \"none\", \"best-effort\" or \"idle\"";
+        }
+    }
+    if (settings.contains("io_level")) {
+        const auto& level = settings["io_level"];
+        if (!level.is_number_integer() || level.get<int>() < 0 || level.get<int>() > 7) {
+            return "io_level must be an integer in [0, 7]";
+        }
+        policy.ioLevel = level.get<int>();
+    }
+    if (settings.contains("nice")) {
+        const auto& nice = settings["nice"];
+        if (!nice.is_number_integer() || nice.get<int>() < -20 || nice.get<int>() > 19) {
+            return "nice must be an integer in [-20, 19]";
+        }
+        policy.nice = nice.get<int>();
+    }
+    if (settings.contains("sched_idle")) {
+        if (!settings["sched_idle"].is_boolean()) {
+            return "sched_idle must be a boolean";
+        }
+        policy.schedIdle = settings["sched_idle"].get<bool>();
+    }
+    if (settings.contains("cpus")) {
+        const auto& cpus = settings["cpus"];
+        if (!cpus.is_array()) {
+            return "cpus must be an array of CPU numbers";
+        }
+        policy.cpus.clear();
+        for (const auto& cpu : cpus) {
+            if (!cpu.is_number_integer() || cpu.get<int>() < 0 || cpu.get<int>() >= CPU_SETSIZE) {
+                return "cpus must be an array of CPU numbers";
+            }
+            policy.cpus.push_back(cpu.get<int>());
+        }
+    }
+    return "";
+}
@@ -1,8 +1,8 @@
 #include "vecowretentionpolicy.hpp"
+#include "configservice.hpp"
 #include <ctime>
 #include <filesystem>
 #include <nlohmann/json.hpp>
-#include <fstream>
 #include <iostream>
 
 // Remove const from declarations in header file and initialize from config
@@ -32,14 +32,13 @@ static bool config_loaded = false;
 void vecowretentionpolicy::loadConfig() {
     if (config_loaded) return;
     
-    std::ifstream configFile("config.json");
-    if (!configFile.is_open()) {
-        throw std::runtime_error("Vecow Retention-Failed to open config.json");
+    auto snapshot = ConfigService::getInstance().current();
+    if (!snapshot->isLoaded()) {
+        throw std::runtime_error("Vecow Retention-Failed to load config.json: " + snapshot->error());
     }
     
     try {
-        nlohmann::json config;
-        configFile >> config;
+        nlohmann::json config = snapshot->json();
         
         auto vecowConfig = config["vecow_retention_policy"];
         
@@ -113,8 +112,6 @@ void vecowretentionpolicy::loadConfig() {
     } catch (const nlohmann::json::exception& e) {
         throw std::runtime_error("Failed to parse config.json: " + std::string(e.what()));
     }
-    
-    configFile.close();
 }
 
 vecowretentionpolicy::vecowretentionpolicy() {
@@ -0,0 +1,40 @@
+#include "workbudget.hpp"
+#include "configservice.hpp"
+#include <nlohmann/json.hpp>
+
+WorkBudget::Limits WorkBudget::configured() {
+    Limits limits;
+    try {
+        const auto& incremental = ConfigService::getInstance().current()->section("incremental");
+        if (!incremental.value("enabled", false)) {
+            return limits;
+        }
+        limits.files = incremental.value("max_files", std::uint64_t(0));
+        limits.bytes = incremental.value("max_megabytes", std::uint64_t(0)) * 1024 * 1024;
+        limits.duration = std::chrono::milliseconds(incremental.value("max_milliseconds", std::int64_t(0)));
+    } catch (const nlohmann::json::exception& e) {
+        // Keep defaults
+        limits = Limits();
+    }
+    return limits;
+}
+
+WorkBudget::WorkBudget(const Limits& limits) : limits(limits), started(std::chrono::steady_clock::now()) {}
+
+bool WorkBudget::admit() {
+    if (exhausted()) {
+        return false;
+    }
+    ++files;
+    return true;
+}
+
+void WorkBudget::charge(std::uint64_t amount) {
+    bytes += amount;
+}
+
+bool WorkBudget::exhausted() const {
+    if (limits.files > 0 && files.load() >= limits.files) return true;
+    if (limits.bytes > 0 && bytes.load() >= limits.bytes) return true;
+    return limits.duration.count() > 0 && std::chrono::steady_clock::now() - started >= limits.duration;
+}
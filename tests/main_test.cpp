@@ -6,6 +6,32 @@
 #include "retentioncontroller.hpp"
 #include "ddsretentionpolicy.hpp"
 #include "vecowretentionpolicy.hpp"
+#include "boundedqueue.hpp"
+#include "dbwriter.hpp"
+#include "dbspool.hpp"
+#include "schemamigrator.hpp"
+#include "archivalnotifier.hpp"
+#include "ringbuffer.hpp"
+#include "asynclogger.hpp"
+#include "pipelinesummary.hpp"
+#include "binarylog.hpp"
+#include "loglevel.hpp"
+#include "policymodel.hpp"
+#include "pathclassifier.hpp"
+#include "ruleengine.hpp"
+#include "configservice.hpp"
+#include "reactor.hpp"
+#include "jobexecutor.hpp"
+#include "taskexecutor.hpp"
+#include "diskpressure.hpp"
+#include "cancellation.hpp"
+#include "chunkedcopy.hpp"
+#include "adaptiveinterval.hpp"
+#include "archivalscope.hpp"
+#include "schedulerstate.hpp"
+#include "workbudget.hpp"
+#include "threadisolation.hpp"
+#include "iopressure.hpp"
 
 #include <nlohmann/json.hpp>
 #include <fstream>
@@ -14,6 +40,16 @@
 #include <iostream>
 #include <thread>
 #include <chrono>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <set>
+#include <csignal>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
 
 // Forward declare the ArchivalConfig namespace
 namespace ArchivalConfig {
@@ -95,6 +131,7 @@ public:
         
         // Create test configuration file
         createTestConfig();
+        ConfigService::getInstance().reload();
         
         // Load configurations for real services
         try {
@@ -474,6 +511,32 @@ TEST_CASE("3. Archival Process & Data Management Tests") {
         // The startNormalPipeline() should not crash and should handle real file operations
         REQUIRE_NOTHROW(controller.startNormalPipeline());
     }
+
+    SECTION("3.4 Failed Copy Keeps The Original") {
+        const std::string original = "test_data/Logs/old.log";
+        {
+            std::ofstream out(original);
+            out << "log line\n";
+        }
+        // Past its one-hour deletion age
+        std::filesystem::last_write_time(original,
+                                         std::filesystem::file_time_type::clock::now() - std::chrono::hours(48));
+        // A plain file where the DDS directory belongs makes the copy fail while DDS itself is reachable
+        std::filesystem::remove_all("test_dds/Logs");
+        {
+            std::ofstream blocker("test_dds/Logs");
+        }
+
+        nlohmann::json policy = setup.createValidArchivalPolicy();
+        policy["LOG_RETENTION_POLICY"] = "test_data/Logs";
+        policy["RETENTION_POLICIES"] = {{"Logs", 1}};
+        ArchivalController logs(policy, "test_source", "test.log");
+        ArchivalBacklog backlog = logs.startNormalPipeline();
+
+        REQUIRE(std::filesystem::exists(original));
+        REQUIRE(backlog.pendingFiles >= 1);
+        std::filesystem::remove("test_dds/Logs");
+    }
 }
 
 
@@ -594,4 +657,1640 @@ TEST_CASE("5. Job Scheduling & Integration Tests") {
         REQUIRE(used >= 0);
         REQUIRE(free >= 0);
     }
-}
\ No newline at end of file
+}
+
+
+TEST_CASE("6. Asynchronous DB Writer Tests") {
+    SECTION("6.1 Bounded Queue Backpressure") {
+        BoundedQueue<int> queue(2);
+        REQUIRE(queue.tryPush(1));
+        REQUIRE(queue.tryPush(2));
+        REQUIRE_FALSE(queue.tryPush(3)); // Full: producers must wait
+
+        std::vector<int> batch;
+        REQUIRE(queue.popBatch(batch, 10, std::chrono::milliseconds(10)) == 2);
+        REQUIRE(batch == std::vector<int>{1, 2});
+        REQUIRE(queue.tryPush(3));
+    }
+
+    SECTION("6.2 Blocked Producer Resumes After Drain") {
+        BoundedQueue<int> queue(1);
+        REQUIRE(queue.push(1));
+
+        std::thread producer([&queue] { queue.push(2); });
+        std::vector<int> batch;
+        queue.popBatch(batch, 1, std::chrono::milliseconds(100));
+        producer.join();
+
+        REQUIRE(queue.size() == 1);
+    }
+
+    SECTION("6.3 Closed Queue Drains Remaining Items") {
+        BoundedQueue<int> queue(4);
+        queue.push(1);
+        queue.close();
+
+        REQUIRE_FALSE(queue.push(2));
+        std::vector<int> batch;
+        REQUIRE(queue.popBatch(batch, 4, std::chrono::milliseconds(10)) == 1);
+        REQUIRE(queue.popBatch(batch, 4, std::chrono::milliseconds(10)) == 0);
+    }
+
+    SECTION("6.4 Writer Flush Completes") {
+        // Writes are applied (or fail against an unavailable DB) without blocking the caller
+        DbWriter& writer = DbWriter::getInstance();
+        REQUIRE_NOTHROW(writer.enqueueIncident("EFMS test incident", {{"detail", "test"}}, "05999"));
+        REQUIRE_NOTHROW(writer.flush());
+        REQUIRE(writer.pendingWrites() == 0);
+    }
+
+    SECTION("6.5 Queued Archival Status Counts As Pending") {
+        // Seen from the moment it is enqueued, not only once it reaches the spool
+        DbWriter& writer = DbWriter::getInstance();
+        const std::string path = "test_data/Videos/inflight.mp4";
+        writer.enqueueVideoArchivalStatus(path, "test_dds/Videos/inflight.mp4");
+        REQUIRE(writer.hasPendingArchivalStatus(path));
+        writer.flush();
+        // The stubbed database is unreachable, so the update now waits in the spool
+        REQUIRE(writer.hasPendingArchivalStatus(path));
+        REQUIRE_FALSE(writer.hasPendingArchivalStatus("test_data/Videos/never-enqueued.mp4"));
+    }
+}
+
+
+TEST_CASE("7. DB Write-Ahead Spool Tests") {
+    const std::string spool_path = "test_spool/db_spool.jsonl";
+    std::filesystem::remove_all("test_spool");
+
+    DbWriteRequest video{DbWriteRequest::Type::VideoArchivalStatus, "test_data/Videos/a.mp4", "test_dds/Videos/a.mp4", ""};
+    DbWriteRequest incident{DbWriteRequest::Type::Incident, "DDS path not accessible", "{\"detail\":\"x\"}", "05004",
+                            "DB_INSERT_FAIL", "05013"};
+
+    SECTION("7.1 Append and Read Back") {
+        DbSpool spool(spool_path);
+        REQUIRE(spool.empty());
+        REQUIRE(spool.append({&video, &incident}));
+
+        auto records = spool.readAll();
+        REQUIRE(records.size() == 2);
+        REQUIRE(records[0].type == DbWriteRequest::Type::VideoArchivalStatus);
+        REQUIRE(records[0].value == "test_dds/Videos/a.mp4");
+        REQUIRE(records[1].errorCode == "05004");
+        // A replayed insert that fails is still reported under the caller's code
+        REQUIRE(records[1].failureType == "DB_INSERT_FAIL");
+        REQUIRE(records[1].failureCode == "05013");
+        REQUIRE(records[0].failureCode.empty());
+        REQUIRE(spool.hasPendingArchivalStatus("test_data/Videos/a.mp4"));
+    }
+
+    SECTION("7.2 Spool Survives Restart and Skips Torn Records") {
+        {
+            DbSpool spool(spool_path);
+            REQUIRE(spool.append({&video}));
+        }
+        std::ofstream torn(spool_path, std::ios::app);
+        torn << "{\"type\":\"incident\",\"key\":";
+        torn.close();
+
+        DbSpool reopened(spool_path);
+        REQUIRE(reopened.size() == 1);
+        REQUIRE(reopened.hasPendingArchivalStatus("test_data/Videos/a.mp4"));
+    }
+
+    SECTION("7.3 Clear After Replay") {
+        DbSpool spool(spool_path);
+        REQUIRE(spool.append({&video}));
+        spool.clear();
+        REQUIRE(spool.empty());
+        REQUIRE(spool.readAll().empty());
+        REQUIRE_FALSE(spool.hasPendingArchivalStatus("test_data/Videos/a.mp4"));
+    }
+
+    std::filesystem::remove_all("test_spool");
+}
+
+
+TEST_CASE("8. Schema Migration Definition Tests") {
+    SECTION("8.1 Versions Are Strictly Increasing") {
+        const auto& migrations = SchemaMigrator::migrations();
+        REQUIRE_FALSE(migrations.empty());
+
+        int previous = 0;
+        for (const auto& migration : migrations) {
+            REQUIRE(migration.version > previous);
+            REQUIRE_FALSE(migration.sql.empty());
+            previous = migration.version;
+        }
+        REQUIRE(SchemaMigrator::latestVersion() == previous);
+    }
+}
+
+
+TEST_CASE("9. Archival Notification Tests") {
+    TestSetup setup;
+    ArchivalNotifier notifier(LoggingService::getInstance("test_source", "test.log"), 2);
+
+    SECTION("9.1 Payload Paths Are Queued Once") {
+        notifier.handlePayload(R"({"video_file_location": "test_data/Videos/a.mp4", "parquet_file_location": null})");
+        notifier.handlePayload(R"({"video_file_location": "test_data/Videos/a.mp4", "parquet_file_location": ""})");
+
+        auto paths = notifier.drain();
+        REQUIRE(paths == std::vector<std::string>{"test_data/Videos/a.mp4"});
+        REQUIRE(notifier.pendingCount() == 0);
+    }
+
+    SECTION("9.2 Pending Set Is Bounded") {
+        notifier.handlePayload(R"({"video_file_location": "a.mp4", "parquet_file_location": "a.parquet"})");
+        notifier.handlePayload(R"({"video_file_location": "b.mp4"})");
+        REQUIRE(notifier.pendingCount() == 2);
+    }
+
+    SECTION("9.3 Malformed Payload Is Ignored") {
+        REQUIRE_NOTHROW(notifier.handlePayload("not json"));
+        REQUIRE(notifier.pendingCount() == 0);
+    }
+
+    SECTION("9.4 Notified Files Are Archived") {
+        setup.createTestFiles();
+        ArchivalController controller(setup.createValidArchivalPolicy(), "test_source", "test.log");
+        REQUIRE_NOTHROW(controller.archiveFiles({"test_data/Videos/test_video.mp4", "/elsewhere/file.mp4"}));
+    }
+}
+
+
+TEST_CASE("10. Async Logging Tests") {
+    SECTION("10.1 Ring Buffer Preserves Order And Rejects When Full") {
+        RingBuffer<int> buffer(3);
+        REQUIRE(buffer.getCapacity() == 4);
+
+        for (int i = 0; i < 4; ++i) {
+            REQUIRE(buffer.tryPush(i));
+        }
+        REQUIRE_FALSE(buffer.tryPush(4));
+        REQUIRE(buffer.size() == 4);
+
+        int value = -1;
+        for (int i = 0; i < 4; ++i) {
+            REQUIRE(buffer.tryPop(value));
+            REQUIRE(value == i);
+        }
+        REQUIRE_FALSE(buffer.tryPop(value));
+    }
+
+    SECTION("10.2 Ring Buffer Handles Concurrent Producers") {
+        RingBuffer<int> buffer(1024);
+        std::vector<std::thread> producers;
+        for (int t = 0; t < 4; ++t) {
+            producers.emplace_back([&buffer]() {
+                for (int i = 0; i < 200; ++i) {
+                    while (!buffer.tryPush(i)) {}
+                }
+            });
+        }
+        for (auto& producer : producers) producer.join();
+
+        int value = 0;
+        int count = 0;
+        while (buffer.tryPop(value)) ++count;
+        REQUIRE(count == 800);
+    }
+
+    SECTION("10.3 Async Logger Flushes And Stops Cleanly") {
+        AsyncLogger logger(LoggingService::getInstance("test_source", "test.log"), 16,
+                           AsyncLogger::OverflowPolicy::Block, true);
+        for (int i = 0; i < 100; ++i) {
+            logger.info(LogRecord("Checking file eligibility").add("file", i));
+        }
+        REQUIRE_NOTHROW(logger.flush());
+        REQUIRE(logger.droppedRecords() == 0);
+
+        // An idle flusher sleeps until a record arrives instead of polling
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        auto started = std::chrono::steady_clock::now();
+        logger.info(LogRecord("Record after idle"));
+        logger.flush();
+        REQUIRE(std::chrono::steady_clock::now() - started < std::chrono::milliseconds(500));
+        logger.stop();
+        REQUIRE_NOTHROW(logger.info(LogRecord("Logged synchronously after stop")));
+    }
+
+    SECTION("10.4 Overflow Policy Parsing") {
+        REQUIRE(AsyncLogger::parseOverflowPolicy("block") == AsyncLogger::OverflowPolicy::Block);
+        REQUIRE(AsyncLogger::parseOverflowPolicy("drop") == AsyncLogger::OverflowPolicy::Drop);
+        REQUIRE(AsyncLogger::parseOverflowPolicy("unknown") == AsyncLogger::OverflowPolicy::Drop);
+    }
+
+    SECTION("10.5 Log Record Converts To Log Info") {
+        std::string path = "test_data/Videos/test_video.mp4";
+        LogRecord record("Checking file eligibility", "FILE_CHECK");
+        record.add("file", path).add("age", 12).add("archived", true).addFormatted("period", "%d hours", 24);
+
+        auto info = record.toJson();
+        REQUIRE(std::string(record.code()) == "FILE_CHECK");
+        REQUIRE(info["file"] == path);
+        REQUIRE(info["age"] == 12);
+        REQUIRE(info["archived"] == true);
+        REQUIRE(info["period"] == "24 hours");
+        REQUIRE(info["timestamp"].get<std::string>().size() == 19);
+        REQUIRE_FALSE(info.contains("truncated"));
+    }
+
+    SECTION("10.6 Log Record Truncates Instead Of Growing") {
+        std::string longValue(LogRecord::TEXT_CAPACITY + 100, 'x');
+        LogRecord record("Long value");
+        record.add("value", longValue);
+        for (std::size_t i = 0; i < LogRecord::MAX_FIELDS; ++i) {
+            record.add("extra", i);
+        }
+
+        auto info = record.toJson();
+        REQUIRE(record.isTruncated());
+        REQUIRE(record.fieldCount() == LogRecord::MAX_FIELDS);
+        REQUIRE(info["value"].get<std::string>().size() == LogRecord::TEXT_CAPACITY);
+        REQUIRE(info["truncated"] == true);
+    }
+
+    SECTION("10.7 Async Logger Instance Per Logging Service") {
+        struct NamedLogger : LoggingService {
+            NamedLogger(const std::string& source, const std::string& path) : LoggingService(source, path) {}
+        };
+        // Shared instances outlive the section, so their loggers must too
+        static NamedLogger archivalLog("test_archival", "test_archival.log");
+        static NamedLogger retentionLog("test_retention", "test_retention.log");
+
+        AsyncLogger& archival = AsyncLogger::getInstance(&archivalLog);
+        AsyncLogger& retention = AsyncLogger::getInstance(&retentionLog);
+        REQUIRE(&archival != &retention);
+        REQUIRE(&AsyncLogger::getInstance(&archivalLog) == &archival);
+        REQUIRE(&AsyncLogger::getInstance(&retentionLog) == &retention);
+    }
+}
+
+
+TEST_CASE("11. Pipeline Summary Tests") {
+    SECTION("11.1 Token Bucket Limits Bursts") {
+        TokenBucket bucket(1.0, 3.0);
+        int allowed = 0;
+        for (int i = 0; i < 10; ++i) {
+            if (bucket.tryAcquire()) ++allowed;
+        }
+        REQUIRE(allowed == 3);
+        REQUIRE(bucket.takeSuppressed() == 7);
+        REQUIRE(bucket.takeSuppressed() == 0);
+    }
+
+    SECTION("11.2 Zero Rate Is Unlimited") {
+        TokenBucket bucket(0.0, 1.0);
+        for (int i = 0; i < 100; ++i) {
+            REQUIRE(bucket.tryAcquire());
+        }
+        REQUIRE(bucket.takeSuppressed() == 0);
+    }
+
+    SECTION("11.3 Directory Counters Roll Up Into Cycle Totals") {
+        AsyncLogger logger(LoggingService::getInstance("test_source", "test.log"), 16,
+                           AsyncLogger::OverflowPolicy::Block, false);
+        PipelineSummary summary(logger, "test_pipeline");
+
+        summary.beginDirectory("test_data/Videos");
+        summary.counters().filesSeen = 4;
+        summary.counters().deleted = 2;
+        summary.counters().bytesDeleted = 2048;
+        summary.counters().bytesCopied = 1024;
+        summary.beginDirectory("test_data/Analysis");
+        summary.counters().filesSeen = 1;
+        summary.counters().errors = 1;
+        summary.finish();
+
+        REQUIRE(summary.totals().filesSeen == 5);
+        REQUIRE(summary.totals().deleted == 2);
+        REQUIRE(summary.totals().bytesDeleted == 2048);
+        REQUIRE(summary.totals().bytesCopied == 1024);
+        REQUIRE(summary.totals().errors == 1);
+    }
+
+    SECTION("11.4 Counters Are Appended To Log Records") {
+        PipelineCounters counters;
+        counters.archived = 3;
+        LogRecord record("Directory summary");
+        auto info = counters.appendTo(record).toJson();
+        REQUIRE(info["archived"] == 3);
+        REQUIRE(info["files_seen"] == 0);
+
+        // The cycle summary carries every counter plus its own fields without truncation
+        LogRecord cycle("Pipeline cycle summary");
+        cycle.add("pipeline", "test_pipeline").add("directories", 1);
+        counters.appendTo(cycle).add("suppressed_file_lines", 0).add("duration_ms", 5);
+        REQUIRE_FALSE(cycle.isTruncated());
+        REQUIRE(cycle.toJson()["bytes_copied"] == 0);
+    }
+}
+
+
+TEST_CASE("12. Binary Event Log Tests") {
+    std::filesystem::create_directories("test_events");
+    const std::string events_path = "test_events/events.bin";
+    std::filesystem::remove(events_path);
+
+    SECTION("12.1 Events Round Trip With Interned Paths") {
+        {
+            BinaryEventLog log(events_path, 4096);
+            REQUIRE(log.isEnabled());
+            log.record(EventId::FileDeleted, "test_data/Videos/a.mp4", {1024});
+            log.record(EventId::FileArchived, "test_data/Videos/a.mp4", {2048});
+            log.record(EventId::DirectoryDeleted, "test_data/Videos/empty", {});
+        }
+        // A second session appends a new segment with its own string table
+        {
+            BinaryEventLog log(events_path, 4096);
+            log.record(EventId::FileDeleted, "test_data/Analysis/b.parquet", {7});
+        }
+
+        std::ifstream input(events_path, std::ios::binary);
+        BinaryEventReader reader(input);
+        std::vector<DecodedEvent> events;
+        DecodedEvent event;
+        while (reader.next(event)) {
+            events.push_back(event);
+        }
+
+        REQUIRE_FALSE(reader.isCorrupt());
+        REQUIRE(events.size() == 4);
+        REQUIRE(events[0].event == static_cast<std::uint16_t>(EventId::FileDeleted));
+        REQUIRE(events[0].path == "test_data/Videos/a.mp4");
+        REQUIRE(events[0].fields == std::vector<std::int64_t>{1024});
+        REQUIRE(events[1].path == "test_data/Videos/a.mp4");
+        REQUIRE(events[2].fields.empty());
+        REQUIRE(events[3].path == "test_data/Analysis/b.parquet");
+        REQUIRE(std::string(findEventSchema(events[1].event)->name) == "file_archived");
+    }
+
+    SECTION("12.2 Torn Tail Is Reported") {
+        {
+            BinaryEventLog log(events_path, 4096);
+            log.record(EventId::FileDeleted, "test_data/Videos/a.mp4", {1});
+        }
+        std::filesystem::resize_file(events_path, std::filesystem::file_size(events_path) - 3);
+
+        std::ifstream input(events_path, std::ios::binary);
+        BinaryEventReader reader(input);
+        DecodedEvent event;
+        REQUIRE_FALSE(reader.next(event));
+        REQUIRE(reader.isCorrupt());
+    }
+
+    SECTION("12.3 Disabled Sink Ignores Events") {
+        BinaryEventLog log("", 4096);
+        REQUIRE_FALSE(log.isEnabled());
+        REQUIRE_NOTHROW(log.record(EventId::FileDeleted, "test_data/Videos/a.mp4", {1}));
+    }
+
+    SECTION("12.4 Reader Resumes At The Next Session After A Torn Record") {
+        {
+            BinaryEventLog log(events_path, 4096);
+            log.record(EventId::FileDeleted, "test_data/Videos/a.mp4", {1});
+            log.record(EventId::FileDeleted, "test_data/Videos/b.mp4", {2});
+        }
+        // Crash mid-record, then a restart appends a new session
+        std::filesystem::resize_file(events_path, std::filesystem::file_size(events_path) - 3);
+        {
+            BinaryEventLog log(events_path, 4096);
+            log.record(EventId::FileArchived, "test_data/Analysis/c.parquet", {3});
+        }
+
+        std::ifstream input(events_path, std::ios::binary);
+        BinaryEventReader reader(input);
+        std::vector<DecodedEvent> events;
+        DecodedEvent event;
+        while (reader.next(event)) {
+            events.push_back(event);
+        }
+        REQUIRE(reader.isCorrupt());
+        REQUIRE(events.size() == 2);
+        REQUIRE(events[0].path == "test_data/Videos/a.mp4");
+        REQUIRE(events[1].path == "test_data/Analysis/c.parquet");
+        REQUIRE(events[1].fields == std::vector<std::int64_t>{3});
+    }
+
+    SECTION("12.5 String Table Stays Bounded") {
+        const std::size_t paths = BinaryEventLog::MAX_STRINGS + 10;
+        {
+            BinaryEventLog log(events_path, 64 * 1024);
+            for (std::size_t i = 0; i < paths; ++i) {
+                log.record(EventId::FileDeleted, "test_data/Videos/" + std::to_string(i) + ".mp4", {1});
+            }
+            // Seen before the reset, so interned again in the new segment
+            log.record(EventId::FileDeleted, "test_data/Videos/0.mp4", {2});
+        }
+
+        std::ifstream input(events_path, std::ios::binary);
+        BinaryEventReader reader(input);
+        std::size_t count = 0;
+        std::size_t mismatched = 0;
+        DecodedEvent event;
+        while (reader.next(event)) {
+            if (count < paths && event.path != "test_data/Videos/" + std::to_string(count) + ".mp4") {
+                ++mismatched;
+            }
+            ++count;
+        }
+        REQUIRE_FALSE(reader.isCorrupt());
+        REQUIRE(count == paths + 1);
+        REQUIRE(mismatched == 0);
+        REQUIRE(event.path == "test_data/Videos/0.mp4");
+    }
+
+    std::filesystem::remove_all("test_events");
+}
+
+
+TEST_CASE("13. Log Level Tests") {
+    SECTION("13.1 Level Names Parse") {
+        LogLevel level = LogLevel::Info;
+        REQUIRE(parseLogLevel("debug", level));
+        REQUIRE(level == LogLevel::Debug);
+        REQUIRE(parseLogLevel("off", level));
+        REQUIRE(level == LogLevel::Off);
+        REQUIRE_FALSE(parseLogLevel("verbose", level));
+        REQUIRE(level == LogLevel::Off);
+    }
+
+    SECTION("13.2 Filtered Statements Do Not Evaluate Arguments") {
+        LogLevel previous = runtimeLogLevel();
+        int evaluations = 0;
+        auto expensive = [&evaluations]() { return ++evaluations; };
+
+        setRuntimeLogLevel(LogLevel::Error);
+        EFMS_DEBUG("value " << expensive());
+        REQUIRE(evaluations == 0);
+
+        setRuntimeLogLevel(LogLevel::Trace);
+        EFMS_DEBUG("value " << expensive());
+        REQUIRE(evaluations == (logLevelCompiledIn(LogLevel::Debug) ? 1 : 0));
+
+        setRuntimeLogLevel(previous);
+    }
+
+    SECTION("13.3 Compile-Time Floor") {
+        STATIC_REQUIRE(logLevelCompiledIn(LogLevel::Error));
+        STATIC_REQUIRE_FALSE(logLevelCompiledIn(static_cast<LogLevel>(EFMS_COMPILE_LOG_LEVEL - 1)));
+    }
+}
+
+
+TEST_CASE("14. Compiled Policy Tests") {
+    TestSetup setup;
+
+    SECTION("14.1 Files Are Classified By Directory Component") {
+        REQUIRE(classifyFile("test_data/Videos/a.mp4") == FileCategory::Video);
+        REQUIRE(classifyFile("/mnt/Station1/Analysis/b.parquet") == FileCategory::Analysis);
+        REQUIRE(classifyFile("/mnt/VideoClips/c.mp4") == FileCategory::VideoClip);
+        REQUIRE(classifyFile("/mnt/Logs/app.log") == FileCategory::Log);
+        REQUIRE(classifyFile("/mnt/MyVideos.mp4") == FileCategory::Unknown);
+    }
+
+    SECTION("14.2 Retention Policy Is Compiled Once") {
+        auto compiled = CompiledPolicy::fromRetentionPolicy(setup.createValidRetentionPolicy());
+        REQUIRE(compiled.ddsPath == "test_dds");
+        REQUIRE(compiled.hasThreshold);
+        REQUIRE(compiled.thresholdPercent == 80);
+        REQUIRE(compiled.scanRoots.size() == 2);
+
+        const RetentionRule* rule = compiled.findRetentionRule(FileCategory::Video, "test_dds/Videos/a.mp4");
+        REQUIRE(rule != nullptr);
+        REQUIRE(rule->key == "VIDEO_RETENTION_POLICY_Station1");
+        REQUIRE(rule->hasRetentionPeriod);
+        REQUIRE(rule->retentionHours == 96);
+
+        REQUIRE(compiled.findRetentionRule(FileCategory::Analysis, "test_dds/Analysis/b.parquet") != nullptr);
+        REQUIRE(compiled.findRetentionRule(FileCategory::Video, "test_dds/VideosOld/a.mp4") == nullptr);
+    }
+
+    SECTION("14.3 Most Specific Root Wins") {
+        auto compiled = CompiledPolicy::fromRetentionPolicy({
+            {"VIDEO_RETENTION_POLICY_All", {{"value", "/data/"}, {"retentionPeriod", "48"}}},
+            {"VIDEO_RETENTION_POLICY_Station1", {{"value", "/data/Station1"}, {"retentionPeriod", "12"}}},
+            {"LOG_RETENTION_POLICY_PATH", {{"value", "/logs"}, {"retentionPeriod", "abc"}}}
+        });
+        REQUIRE(compiled.findRetentionRule(FileCategory::Video, "/data/Station1/Videos/a.mp4")->retentionHours == 12);
+        REQUIRE(compiled.findRetentionRule(FileCategory::Video, "/data/Station2/Videos/a.mp4")->retentionHours == 48);
+        REQUIRE_FALSE(compiled.findRetentionRule(FileCategory::Log, "/logs/Logs/a.log")->hasRetentionPeriod);
+        REQUIRE_FALSE(compiled.hasThreshold);
+    }
+
+    SECTION("14.4 Archival Policy Maps Paths To DDS") {
+        auto compiled = CompiledPolicy::fromArchivalPolicy(setup.createValidArchivalPolicy(),
+                                                           {{"Videos", true}, {"Analysis", false}});
+        REQUIRE(compiled.mountedPath == "test_data");
+        REQUIRE(compiled.scanRoots.size() == 2);
+        REQUIRE(compiled.eligibilityConfigured);
+        REQUIRE(compiled.archivalEligible[categoryIndex(FileCategory::Video)]);
+        REQUIRE_FALSE(compiled.archivalEligible[categoryIndex(FileCategory::Analysis)]);
+
+        std::string ddsFilePath;
+        REQUIRE(compiled.toDdsPath("test_data/Videos/a.mp4", ddsFilePath));
+        REQUIRE(ddsFilePath == "test_dds/Videos/a.mp4");
+        REQUIRE_FALSE(compiled.toDdsPath("other/Videos/a.mp4", ddsFilePath));
+    }
+}
+
+TEST_CASE("15. Path Classifier Tests") {
+    SECTION("15.1 Extension Table Is Case-Insensitive") {
+        ExtensionTable table;
+        table.build({"mp4", "MKV", "parquet", "mp4", "log"});
+        REQUIRE(table.size() == 4);
+        REQUIRE(table.find("mp4") == table.find("MP4"));
+        REQUIRE(table.find("mkv") >= 0);
+        REQUIRE(table.find("parquet") >= 0);
+        REQUIRE(table.find("avi") == -1);
+        REQUIRE(table.find("") == -1);
+    }
+
+    SECTION("15.2 Deepest Root Is Found In One Walk") {
+        RetentionRule all{"VIDEO_RETENTION_POLICY_All", "/data", true, 48, {}};
+        RetentionRule station{"VIDEO_RETENTION_POLICY_Station1", "/data/Station1", true, 12, {}};
+        RetentionRule logs{"LOG_RETENTION_POLICY_PATH", "/data/Station1", true, 6, {}};
+        PathClassifier classifier({{FileCategory::Video, all},
+                                   {FileCategory::Video, station},
+                                   {FileCategory::Log, logs}});
+        REQUIRE(classifier.ruleCount() == 3);
+
+        PathMatch match = classifier.classify("/data/Station1/Videos/a.mp4");
+        REQUIRE(match.category == FileCategory::Video);
+        REQUIRE(match.rule->key == "VIDEO_RETENTION_POLICY_Station1");
+        REQUIRE(classifier.classify("/data/Station2/Videos/a.mp4").rule->key == "VIDEO_RETENTION_POLICY_All");
+        REQUIRE(classifier.classify("/data/Station1/Logs/a.log").rule->key == "LOG_RETENTION_POLICY_PATH");
+        REQUIRE(classifier.classify("/data/Station2/Logs/a.log").rule == nullptr);
+        REQUIRE(classifier.classify("/other/Videos/a.mp4").rule == nullptr);
+        REQUIRE(classifier.classify("/data/Station1/Videos").category == FileCategory::Unknown);
+    }
+
+    SECTION("15.3 File Types Are Enforced") {
+        auto compiled = CompiledPolicy::fromRetentionPolicy({
+            {"VIDEO_RETENTION_POLICY_Station1", {{"value", "/data"}, {"retentionPeriod", "12"}, {"fileTypes", "mp4, .MKV"}}},
+            {"LOG_RETENTION_POLICY_PATH", {{"value", "/logs"}, {"retentionPeriod", "6"}, {"fileTypes", ""}}}
+        });
+        REQUIRE(compiled.classifier.classify("/data/Videos/a.mp4").extensionAllowed);
+        REQUIRE(compiled.classifier.classify("/data/Videos/a.mkv").extensionAllowed);
+        REQUIRE_FALSE(compiled.classifier.classify("/data/Videos/a.avi").extensionAllowed);
+        REQUIRE_FALSE(compiled.classifier.classify("/data/Videos/mp4").extensionAllowed);
+        REQUIRE(compiled.classifier.classify("/logs/Logs/anything.bin").extensionAllowed);
+    }
+}
+
+TEST_CASE("16. Rule Engine Tests") {
+    SECTION("16.1 Expressions Evaluate Against File Facts") {
+        auto rule = RuleProgram::compile("age > 96h AND ext in [mp4, .MKV] AND archived");
+        REQUIRE(rule.needs(RULE_INPUT_AGE));
+        REQUIRE(rule.needs(RULE_INPUT_ARCHIVED));
+        REQUIRE_FALSE(rule.needs(RULE_INPUT_SIZE));
+
+        FileFacts facts;
+        facts.ageHours = 100;
+        facts.extension = "mkv";
+        facts.archived = [] { return true; };
+        REQUIRE(rule.evaluate(facts));
+        facts.extension = "avi";
+        REQUIRE_FALSE(rule.evaluate(facts));
+
+        auto sized = RuleProgram::compile("size > 2GB and age > 1d or category == Logs");
+        facts.sizeBytes = 3ull * 1024 * 1024 * 1024;
+        facts.ageHours = 25;
+        REQUIRE(sized.evaluate(facts));
+        facts.ageHours = 23;
+        REQUIRE_FALSE(sized.evaluate(facts));
+        facts.category = FileCategory::Log;
+        REQUIRE(sized.evaluate(facts));
+    }
+
+    SECTION("16.2 Evaluation Short-Circuits") {
+        int lookups = 0;
+        FileFacts facts;
+        facts.ageHours = 10;
+        facts.retentionHours = 96;
+        facts.archived = [&lookups] { ++lookups; return true; };
+
+        REQUIRE_FALSE(RuleProgram::compile("age > retention AND archived").evaluate(facts));
+        REQUIRE(lookups == 0);
+        REQUIRE(RuleProgram::compile("NOT (age > retention) OR archived").evaluate(facts));
+        REQUIRE(lookups == 0);
+        REQUIRE(RuleProgram::compile("age < retention AND archived").evaluate(facts));
+        REQUIRE(lookups == 1);
+    }
+
+    SECTION("16.3 Invalid Rules Fall Back To Defaults") {
+        REQUIRE_THROWS_AS(RuleProgram::compile("age > 2GB"), std::invalid_argument);
+        REQUIRE_THROWS_AS(RuleProgram::compile("colour == red"), std::invalid_argument);
+        REQUIRE_THROWS_AS(RuleProgram::compile("(age > 1h"), std::invalid_argument);
+        REQUIRE_THROWS_AS(RuleProgram::compile("category in [Pictures]"), std::invalid_argument);
+
+        std::array<std::string, FILE_CATEGORY_COUNT> defaults;
+        defaults.fill("false");
+        std::vector<std::string> errors;
+        auto programs = compileCategoryRules({{"Videos", "true"}, {"Logs", "age >"}}, defaults, errors);
+        REQUIRE(programs[categoryIndex(FileCategory::Video)].evaluate({}));
+        REQUIRE(programs[categoryIndex(FileCategory::Log)].source() == "false");
+        REQUIRE(errors.size() == 1);
+    }
+
+    SECTION("16.4 Compiled Policies Carry Rules") {
+        auto compiled = CompiledPolicy::fromRetentionPolicy(
+            {{"VIDEO_RETENTION_POLICY_Station1", {{"value", "/data"}, {"retentionPeriod", "12"}}}},
+            {{"retention", {{"Videos", "age > retention AND size > 1MB"}}}});
+        REQUIRE(compiled.ruleErrors.empty());
+        REQUIRE(compiled.deletionRules[categoryIndex(FileCategory::Video)].needs(RULE_INPUT_SIZE));
+        REQUIRE(compiled.deletionRules[categoryIndex(FileCategory::Log)].source() == "age > retention");
+
+        auto archival = CompiledPolicy::fromArchivalPolicy(nlohmann::json::object(), {{"Videos", true}});
+        REQUIRE(archival.archivalRules[categoryIndex(FileCategory::Video)].evaluate({}));
+        REQUIRE_FALSE(archival.archivalRules[categoryIndex(FileCategory::Log)].evaluate({}));
+        REQUIRE_FALSE(archival.deletionRules[categoryIndex(FileCategory::Video)].evaluate({}));
+
+        // `retention` in a category without a deletion age falls back to the default instead of reading as 0
+        auto unaged = CompiledPolicy::fromArchivalPolicy(
+            {{"RETENTION_POLICIES", {{"Videos", 72}}}}, {{"Videos", true}, {"Logs", true}},
+            {{"archival_deletion", {{"Videos", "age > retention"}, {"Logs", "age > retention"}}},
+             {"archival", {{"Logs", "age > retention"}}}});
+        REQUIRE(unaged.ruleErrors.size() == 2);
+        REQUIRE(unaged.deletionRules[categoryIndex(FileCategory::Video)].source() == "age > retention");
+        REQUIRE(unaged.deletionRules[categoryIndex(FileCategory::Log)].source() == "false");
+        REQUIRE(unaged.archivalRules[categoryIndex(FileCategory::Log)].source() == "true");
+        FileFacts facts;
+        facts.ageHours = 1000;
+        REQUIRE_FALSE(unaged.deletionRules[categoryIndex(FileCategory::Log)].evaluate(facts));
+    }
+}
+
+TEST_CASE("17. Config Service Tests") {
+    const std::string path = "test_config_service.json";
+    auto writeConfig = [&path](const std::string& text) {
+        std::ofstream("test_config_service.tmp") << text;
+        std::filesystem::rename("test_config_service.tmp", path);
+    };
+    writeConfig(R"({"archival": {"bandwidth_limit_kb": 2048}, "vecow_retention_policy": {"threshold_storage_utilization": 75}})");
+
+    ConfigService service(path);
+    auto first = service.current();
+    REQUIRE(first->isLoaded());
+    REQUIRE(first->version() == 1);
+    REQUIRE(first->section("archival").value("bandwidth_limit_kb", 0) == 2048);
+    REQUIRE(first->section("missing").empty());
+
+    SECTION("17.1 Valid Edits Are Published Atomically") {
+        std::uint64_t notified = 0;
+        service.addListener([&notified](const ConfigSnapshot& snapshot) { notified = snapshot.version(); });
+
+        writeConfig(R"({"archival": {"bandwidth_limit_kb": 512}})");
+        REQUIRE(service.reload());
+        REQUIRE(service.current()->version() == 2);
+        REQUIRE(service.current()->section("archival").value("bandwidth_limit_kb", 0) == 512);
+        REQUIRE(notified == 2);
+        // Readers holding the old snapshot keep a consistent view
+        REQUIRE(first->section("archival").value("bandwidth_limit_kb", 0) == 2048);
+
+        // The retired poll interval is ignored, whatever its value
+        writeConfig(R"({"scheduler": {"poll_interval_seconds": 0}})");
+        REQUIRE(service.reload());
+    }
+
+    SECTION("17.2 Invalid Edits Keep The Current Snapshot") {
+        writeConfig(R"({"vecow_retention_policy": {"threshold_storage_utilization": 150}})");
+        REQUIRE_FALSE(service.reload());
+        REQUIRE(service.lastError().find("threshold_storage_utilization") != std::string::npos);
+
+        writeConfig(R"({"rules": {"retention": {"Videos": "age >"}}})");
+        REQUIRE_FALSE(service.reload());
+
+        writeConfig("{ \"archival\": ");
+        REQUIRE_FALSE(service.reload());
+        REQUIRE(service.current()->version() == 1);
+        REQUIRE(service.current() == first);
+    }
+
+    SECTION("17.3 File Changes Are Picked Up By The Watcher") {
+        service.startWatching();
+        writeConfig(R"({"archival": {"bandwidth_limit_kb": 4096}})");
+
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (service.current()->version() == 1 && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        service.stopWatching();
+        REQUIRE(service.current()->version() == 2);
+        REQUIRE(service.current()->section("archival").value("bandwidth_limit_kb", 0) == 4096);
+    }
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("18. Reactor Tests") {
+    Reactor reactor;
+
+    SECTION("18.1 Timer Fires At Its Absolute Deadline") {
+        DeadlineTimer timer;
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(50);
+        std::chrono::steady_clock::time_point fired;
+        reactor.add(timer.fd(), [&] {
+            REQUIRE(timer.consume() == 1);
+            fired = std::chrono::steady_clock::now();
+            reactor.stop();
+        });
+        timer.armAt(deadline);
+        reactor.run();
+        REQUIRE(fired >= deadline);
+        REQUIRE(fired - deadline < std::chrono::seconds(1));
+    }
+
+    SECTION("18.2 Wakeup From Another Thread") {
+        WakeupEvent wakeup;
+        int wakeups = 0;
+        reactor.add(wakeup.fd(), [&] {
+            wakeups += static_cast<int>(wakeup.consume());
+            reactor.stop();
+        });
+        std::thread notifier([&wakeup] {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            wakeup.notify();
+        });
+        reactor.run();
+        notifier.join();
+        REQUIRE(wakeups == 1);
+    }
+
+    SECTION("18.3 Signals Arrive Through The Reactor") {
+        SignalSource signals{SIGUSR2};
+        int received = 0;
+        reactor.add(signals.fd(), [&] {
+            while (int signal = signals.next()) received = signal;
+            reactor.stop();
+        });
+        // Directed at this thread, which has SIGUSR2 blocked
+        pthread_kill(pthread_self(), SIGUSR2);
+        reactor.run();
+        REQUIRE(received == SIGUSR2);
+    }
+
+    SECTION("18.4 Stop From Another Thread Ends Run") {
+        std::thread stopper([&reactor] {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            reactor.stop();
+        });
+        reactor.run();
+        stopper.join();
+        SUCCEED();
+    }
+}
+
+TEST_CASE("19. Job Executor Tests") {
+    JobExecutor executor;
+    executor.addJob("archival");
+    executor.addJob("retention");
+
+    std::mutex mutex;
+    std::condition_variable changed;
+    bool release = false;
+    auto waitForRelease = [&] {
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [&] { return release; });
+    };
+    auto waitUntil = [](const std::function<bool()>& condition) {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (!condition() && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        return condition();
+    };
+
+    SECTION("19.1 A Busy Job Does Not Block Another") {
+        REQUIRE(executor.submit("archival", waitForRelease));
+        std::atomic<bool> retentionRan{false};
+        REQUIRE(executor.submit("retention", [&] { retentionRan = true; }));
+        REQUIRE(waitUntil([&] { return retentionRan.load(); }));
+        REQUIRE(executor.isRunning("archival"));
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            release = true;
+        }
+        changed.notify_all();
+        REQUIRE(waitUntil([&] { return executor.completedRuns("archival") == 1; }));
+    }
+
+    SECTION("19.2 Runs Of The Same Job Never Overlap") {
+        std::atomic<bool> started{false};
+        REQUIRE(executor.submit("archival", [&] {
+            started = true;
+            waitForRelease();
+        }));
+        REQUIRE(waitUntil([&] { return started.load(); }));
+
+        REQUIRE_FALSE(executor.submit("archival", [] {}));
+        REQUIRE(executor.skippedRuns("archival") == 1);
+
+        std::atomic<int> queuedRuns{0};
+        REQUIRE(executor.submit("archival", [&] { ++queuedRuns; }, OverlapPolicy::Queue));
+        REQUIRE(executor.submit("archival", [&] { ++queuedRuns; }, OverlapPolicy::Queue));
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            release = true;
+        }
+        changed.notify_all();
+        REQUIRE(waitUntil([&] { return executor.completedRuns("archival") == 2; }));
+        // Queued runs coalesce into one
+        REQUIRE(queuedRuns == 1);
+    }
+
+    SECTION("19.3 A Failing Run Leaves The Worker Usable") {
+        REQUIRE(executor.submit("retention", [] { throw std::runtime_error("disk unavailable"); }));
+        REQUIRE(waitUntil([&] { return executor.completedRuns("retention") == 1; }));
+        std::atomic<bool> ran{false};
+        REQUIRE(executor.submit("retention", [&] { ran = true; }));
+        REQUIRE(waitUntil([&] { return ran.load(); }));
+    }
+
+    SECTION("19.4 IoBudget Bounds Concurrent Operations") {
+        IoBudget budget(2);
+        std::atomic<int> active{0};
+        std::atomic<int> peak{0};
+        std::vector<std::thread> workers;
+        for (int i = 0; i < 6; ++i) {
+            workers.emplace_back([&] {
+                IoBudget::Permit permit(budget);
+                int now = ++active;
+                int previous = peak.load();
+                while (now > previous && !peak.compare_exchange_weak(previous, now)) {}
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                --active;
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        REQUIRE(peak <= 2);
+        REQUIRE(budget.inUse() == 0);
+    }
+
+    SECTION("19.5 Queued Runs Of Different Kinds Are All Kept") {
+        std::atomic<bool> started{false};
+        REQUIRE(executor.submit("archival", [&] {
+            started = true;
+            waitForRelease();
+        }));
+        REQUIRE(waitUntil([&] { return started.load(); }));
+
+        std::mutex orderMutex;
+        std::vector<std::string> order;
+        auto record = [&](const std::string& run) {
+            return [&, run](const CancellationToken&) {
+                std::lock_guard<std::mutex> lock(orderMutex);
+                order.push_back(run);
+            };
+        };
+        RunOptions eviction;
+        eviction.overlap = OverlapPolicy::Queue;
+        eviction.kind = "eviction";
+        RunOptions notified = eviction;
+        notified.kind = "notified";
+        REQUIRE(executor.submit("archival", record("eviction"), eviction));
+        REQUIRE(executor.submit("archival", record("notified 1"), notified));
+        // Replaces the queued notified run, not the eviction ahead of it
+        REQUIRE(executor.submit("archival", record("notified 2"), notified));
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            release = true;
+        }
+        changed.notify_all();
+        REQUIRE(waitUntil([&] { return executor.completedRuns("archival") == 3; }));
+        std::lock_guard<std::mutex> lock(orderMutex);
+        REQUIRE(order == std::vector<std::string>{"eviction", "notified 2"});
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        release = true;
+    }
+    changed.notify_all();
+    executor.shutdown();
+}
+
+TEST_CASE("20. Task Executor Tests") {
+    TaskExecutor executor(3);
+    REQUIRE(executor.workerCount() == 3);
+
+    SECTION("20.1 Group Waits For All Tasks") {
+        std::atomic<int> completed{0};
+        TaskGroup group(TaskPriority::Normal, executor);
+        for (int i = 0; i < 200; ++i) {
+            group.run([&completed] { ++completed; });
+        }
+        group.wait();
+        REQUIRE(completed == 200);
+    }
+
+    SECTION("20.2 Work Spreads Across Workers") {
+        std::mutex mutex;
+        std::set<std::thread::id> threads;
+        TaskGroup group(TaskPriority::Background, executor);
+        for (int i = 0; i < 30; ++i) {
+            group.run([&] {
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+                std::lock_guard<std::mutex> lock(mutex);
+                threads.insert(std::this_thread::get_id());
+            });
+        }
+        group.wait();
+        REQUIRE(threads.size() > 1);
+        REQUIRE(threads.count(std::this_thread::get_id()) == 0);
+    }
+
+    SECTION("20.3 Higher Lanes Run First") {
+        TaskExecutor single(1);
+        std::mutex mutex;
+        std::vector<TaskPriority> order;
+        std::atomic<bool> release{false};
+        TaskGroup blocker(TaskPriority::Normal, single);
+        blocker.run([&release] {
+            while (!release) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        });
+
+        auto record = [&](TaskPriority priority) {
+            return [&, priority] {
+                std::lock_guard<std::mutex> lock(mutex);
+                order.push_back(priority);
+            };
+        };
+        TaskGroup background(TaskPriority::Background, single);
+        TaskGroup normal(TaskPriority::Normal, single);
+        TaskGroup emergency(TaskPriority::Emergency, single);
+        background.run(record(TaskPriority::Background));
+        normal.run(record(TaskPriority::Normal));
+        emergency.run(record(TaskPriority::Emergency));
+        release = true;
+
+        blocker.wait();
+        background.wait();
+        normal.wait();
+        emergency.wait();
+        REQUIRE(order == std::vector<TaskPriority>{TaskPriority::Emergency, TaskPriority::Normal,
+                                                   TaskPriority::Background});
+    }
+
+    SECTION("20.4 Nested Groups And Exceptions") {
+        std::atomic<int> leaves{0};
+        TaskGroup outer(TaskPriority::Normal, executor);
+        for (int i = 0; i < 8; ++i) {
+            // Waiting on a worker helps instead of blocking, so nesting cannot deadlock
+            outer.run([&] {
+                TaskGroup inner(TaskPriority::Normal, executor);
+                for (int j = 0; j < 8; ++j) {
+                    inner.run([&leaves] { ++leaves; });
+                }
+                inner.wait();
+            });
+        }
+        outer.wait();
+        REQUIRE(leaves == 64);
+
+        TaskGroup failing(TaskPriority::Normal, executor);
+        failing.run([] { throw std::runtime_error("copy failed"); });
+        failing.run([] {});
+        REQUIRE_THROWS_WITH(failing.wait(), "copy failed");
+    }
+}
+
+TEST_CASE("21. Disk Pressure Monitor Tests") {
+    SECTION("21.1 Utilization From statvfs") {
+        double used = DiskPressureMonitor::utilization(".");
+        REQUIRE(used >= 0.0);
+        REQUIRE(used <= 100.0);
+        REQUIRE(DiskPressureMonitor::utilization("/nonexistent/efms/volume") < 0.0);
+
+        // The controllers' figure: what the FileService reports as used over total
+        struct FixedFileService : FileService {
+            std::tuple<uint64_t, uint64_t, uint64_t> details;
+            std::tuple<uint64_t, uint64_t, uint64_t> get_memory_details(const std::string&) override { return details; }
+        } fileService;
+        fileService.details = std::make_tuple(200, 50, 150);
+        REQUIRE(DiskPressureMonitor::utilization(fileService, "mounted") == Approx(25.0));
+        fileService.details = std::make_tuple(0, 0, 0);
+        REQUIRE(DiskPressureMonitor::utilization(fileService, "mounted") < 0.0);
+    }
+
+    SECTION("21.2 Crossing Is Reported Once Until Retrigger") {
+        DiskPressureMonitor monitor(std::chrono::seconds(60));
+        std::vector<std::string> reported;
+        // Threshold -1 keeps any readable volume over it
+        monitor.addVolume("mounted", ".", -1, [&](const std::string& volume, double) { reported.push_back(volume); });
+        monitor.addVolume("missing", "/nonexistent/efms/volume", -1,
+                          [&](const std::string& volume, double) { reported.push_back(volume); });
+
+        auto now = std::chrono::steady_clock::now();
+        REQUIRE(monitor.sample(now) == 1);
+        REQUIRE(monitor.sample(now + std::chrono::seconds(5)) == 0);
+        REQUIRE(monitor.sample(now + std::chrono::seconds(61)) == 1);
+        REQUIRE(reported == std::vector<std::string>{"mounted", "mounted"});
+
+        // Dropping below the threshold re-arms the crossing
+        monitor.setThreshold("mounted", 100);
+        REQUIRE(monitor.sample(now + std::chrono::seconds(62)) == 0);
+        monitor.setThreshold("mounted", -1);
+        REQUIRE(monitor.sample(now + std::chrono::seconds(63)) == 1);
+    }
+}
+
+TEST_CASE("22. Cancellation & Chunked Copy Tests") {
+    const std::string source = "test_chunked_source.bin";
+    const std::string destination = "test_chunked_dir/nested/copy.bin";
+    {
+        std::ofstream out(source, std::ios::binary);
+        std::string block(4096, 'x');
+        for (int i = 0; i < 64; ++i) {
+            out << block;
+        }
+    }
+    auto leftoverParts = [] {
+        std::size_t parts = 0;
+        std::error_code ec;
+        for (const auto& entry : std::filesystem::directory_iterator("test_chunked_dir/nested", ec)) {
+            parts += entry.path().filename().string().find(".efms-part") != std::string::npos ? 1 : 0;
+        }
+        return parts;
+    };
+
+    SECTION("22.1 Tokens And Deadlines") {
+        CancellationToken token;
+        REQUIRE_FALSE(token.isCancelled());
+        REQUIRE(token.reason().empty());
+
+        CancellationToken copy = token;
+        copy.cancel("preempted");
+        copy.cancel("shutdown");
+        REQUIRE(token.isCancelled());
+        REQUIRE(token.reason() == "preempted");
+
+        CancellationToken timed;
+        timed.setDeadline(std::chrono::steady_clock::now() - std::chrono::milliseconds(1));
+        REQUIRE(timed.isCancelled());
+        REQUIRE(timed.reason() == "deadline exceeded");
+        REQUIRE_FALSE(CancellationToken::none().isCancelled());
+    }
+
+    SECTION("22.2 Copy Publishes Complete Files Only") {
+        CopyResult result = copyFileChunked(source, destination, 0, CancellationToken::none(), 4096);
+        REQUIRE(result.status == CopyStatus::Copied);
+        REQUIRE(result.bytes == 64 * 4096);
+        REQUIRE(std::filesystem::file_size(destination) == 64 * 4096);
+        REQUIRE(leftoverParts() == 0);
+
+        CopyResult missing = copyFileChunked("test_chunked_missing.bin", destination, 0, CancellationToken::none());
+        REQUIRE(missing.status == CopyStatus::Failed);
+        REQUIRE_FALSE(missing.error.empty());
+    }
+
+    SECTION("22.3 Cancelled Copy Stops At A Chunk Boundary") {
+        CancellationToken token;
+        // 64 KB/s for 256 KB would take ~4 s; cancel shortly after it starts
+        std::thread canceller([token]() mutable {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            token.cancel("shutdown");
+        });
+        auto started = std::chrono::steady_clock::now();
+        CopyResult result = copyFileChunked(source, destination, 64, token, 4096);
+        canceller.join();
+
+        REQUIRE(result.status == CopyStatus::Cancelled);
+        REQUIRE(std::chrono::steady_clock::now() - started < std::chrono::seconds(2));
+        REQUIRE(result.bytes < 64 * 4096);
+        REQUIRE_FALSE(std::filesystem::exists(destination));
+        REQUIRE(leftoverParts() == 0);
+    }
+
+    SECTION("22.4 Executor Preempts And Cancels Runs") {
+        JobExecutor executor;
+        executor.addJob("archival");
+
+        std::atomic<bool> started{false};
+        std::atomic<bool> sawCancel{false};
+        RunOptions background;
+        background.preemptible = true;
+        REQUIRE(executor.submit("archival", [&](const CancellationToken& token) {
+            started = true;
+            while (!token.isCancelled()) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            sawCancel = token.reason() == "disk pressure";
+        }, background));
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (!started && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        REQUIRE(executor.preempt("archival", "disk pressure"));
+
+        // The urgent run is not preemptible but still bounded by its time limit
+        std::atomic<bool> urgentRan{false};
+        RunOptions urgent;
+        urgent.overlap = OverlapPolicy::Queue;
+        urgent.timeLimit = std::chrono::milliseconds(50);
+        REQUIRE(executor.submit("archival", [&](const CancellationToken& token) {
+            urgentRan = true;
+            while (!token.isCancelled()) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }, urgent));
+        while (!urgentRan && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        REQUIRE_FALSE(executor.preempt("archival", "ignored"));
+        while (executor.completedRuns("archival") < 2 && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        REQUIRE(sawCancel);
+        REQUIRE(urgentRan);
+        REQUIRE(executor.completedRuns("archival") == 2);
+    }
+
+    SECTION("22.5 Concurrent Copies To One Destination Do Not Interleave") {
+        const std::string other = "test_chunked_other.bin";
+        {
+            std::ofstream out(other, std::ios::binary);
+            out << std::string(64 * 4096, 'y');
+        }
+        CopyResult first;
+        CopyResult second;
+        std::thread racer([&] { first = copyFileChunked(source, destination, 0, CancellationToken::none(), 512); });
+        second = copyFileChunked(other, destination, 0, CancellationToken::none(), 512);
+        racer.join();
+
+        REQUIRE(first.status == CopyStatus::Copied);
+        REQUIRE(second.status == CopyStatus::Copied);
+        // Whichever rename came last, the destination holds one source whole
+        std::ifstream in(destination, std::ios::binary);
+        std::string content((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        REQUIRE(content.size() == 64 * 4096);
+        REQUIRE((content == std::string(64 * 4096, 'x') || content == std::string(64 * 4096, 'y')));
+        REQUIRE(leftoverParts() == 0);
+        std::filesystem::remove(other);
+    }
+
+    std::filesystem::remove(source);
+    std::filesystem::remove_all("test_chunked_dir");
+}
+
+TEST_CASE("23. Adaptive Archival Interval Tests") {
+    using std::chrono::minutes;
+    AdaptiveInterval interval(minutes(30), minutes(5), minutes(120));
+    REQUIRE(interval.current() == minutes(30));
+
+    auto copied = [](std::uint64_t files) {
+        ArchivalBacklog backlog;
+        backlog.copiedFiles = files;
+        return backlog;
+    };
+
+    SECTION("23.1 Backs Off When Runs Find Nothing") {
+        REQUIRE(interval.update(copied(0)) == minutes(60));
+        REQUIRE(interval.update(copied(0)) == minutes(120));
+        REQUIRE(interval.update(copied(0)) == minutes(120));
+        // Work returns: straight back to the base interval
+        REQUIRE(interval.update(copied(10)) == minutes(30));
+    }
+
+    SECTION("23.2 Speeds Up While The Backlog Grows") {
+        REQUIRE(interval.update(copied(30)) == minutes(30));
+        REQUIRE(interval.update(copied(90)) == minutes(15));
+        // Same rate per minute over the shorter interval: hold
+        REQUIRE(interval.update(copied(45)) == minutes(15));
+
+        ArchivalBacklog leftover = copied(100);
+        leftover.pendingFiles = 40;
+        REQUIRE(interval.update(leftover) == minutes(5));
+
+        ArchivalBacklog cut = copied(0);
+        cut.complete = false;
+        REQUIRE(interval.update(cut) == minutes(5));
+
+        // Eviction runs leave the interval alone
+        ArchivalBacklog eviction;
+        eviction.eviction = true;
+        REQUIRE(interval.update(eviction) == minutes(5));
+    }
+
+    SECTION("23.3 Bounds Keep It Predictable") {
+        interval.setBounds(minutes(30), minutes(30), minutes(30));
+        REQUIRE(interval.update(copied(0)) == minutes(30));
+        ArchivalBacklog leftover = copied(1);
+        leftover.pendingFiles = 1;
+        REQUIRE(interval.update(leftover) == minutes(30));
+
+        interval.setBounds(minutes(30), minutes(10), minutes(20));
+        REQUIRE(interval.current() == minutes(20));
+    }
+
+    SECTION("23.4 Backs Off While DDS Is Unreachable") {
+        ArchivalBacklog unreachable = copied(0);
+        unreachable.complete = false;
+        unreachable.ddsUnavailable = true;
+        unreachable.pendingFiles = 500;
+        REQUIRE(interval.update(unreachable) == minutes(60));
+        REQUIRE(interval.update(unreachable) == minutes(120));
+        // DDS is back and the backlog drains as fast as the minimum allows
+        ArchivalBacklog leftover = copied(200);
+        leftover.pendingFiles = 300;
+        REQUIRE(interval.update(leftover) == minutes(5));
+    }
+}
+
+TEST_CASE("24. Per-Category Archival Pipeline Tests") {
+    SECTION("24.1 Categories Parse Into Their Own Scopes") {
+        std::vector<ArchivalScope> scopes;
+        auto categories = nlohmann::json::parse(R"({
+            "Logs": {"interval_minutes": 240, "concurrency": 1},
+            "Videos": {"interval_minutes": 5, "concurrency": 4, "priority": "normal"}
+        })");
+        REQUIRE(parseArchivalScopes(categories, scopes).empty());
+        REQUIRE(scopes.size() == 2);
+        REQUIRE(scopes[0].name == "archival:Videos");
+        REQUIRE(scopes[0].intervalMinutes == 5);
+        REQUIRE(scopes[0].concurrency == 4);
+        REQUIRE(scopes[0].priority == TaskPriority::Normal);
+        REQUIRE(scopes[0].includes(FileCategory::Video));
+        REQUIRE_FALSE(scopes[0].includes(FileCategory::Log));
+        REQUIRE(scopes[1].name == "archival:Logs");
+        REQUIRE(scopes[1].priority == TaskPriority::Background);
+
+        // The default instance keeps everything else, including roots of no known category
+        ArchivalScope rest = defaultArchivalScope(scopes);
+        REQUIRE(rest.name == "archival");
+        REQUIRE_FALSE(rest.includes(FileCategory::Video));
+        REQUIRE_FALSE(rest.includes(FileCategory::Log));
+        REQUIRE(rest.includes(FileCategory::Analysis));
+        REQUIRE(rest.includes(FileCategory::Unknown));
+    }
+
+    SECTION("24.2 Invalid Entries Are Rejected") {
+        std::vector<ArchivalScope> scopes;
+        REQUIRE_FALSE(parseArchivalScopes(nlohmann::json::parse(R"({"Photos": {"interval_minutes": 5}})"), scopes).empty());
+        REQUIRE_FALSE(parseArchivalScopes(nlohmann::json::parse(R"({"Videos": {}})"), scopes).empty());
+        REQUIRE_FALSE(parseArchivalScopes(
+            nlohmann::json::parse(R"({"Videos": {"interval_minutes": 5, "priority": "emergency"}})"), scopes).empty());
+        REQUIRE_FALSE(parseArchivalScopes(
+            nlohmann::json::parse(R"({"Videos": {"interval_minutes": 5, "concurrency": -1}})"), scopes).empty());
+        REQUIRE(ConfigService::validate(nlohmann::json::parse(
+            R"({"archival": {"categories": {"Logs": {"interval_minutes": 0}}}})")).find("archival.categories.Logs") == 0);
+        REQUIRE(ConfigService::validate(nlohmann::json::parse(
+            R"({"archival": {"categories": {"Logs": {"interval_minutes": 60}}}})")).empty());
+    }
+
+    SECTION("24.3 In-Flight Limit Bounds A Group") {
+        TaskExecutor executor(4);
+        std::atomic<int> running{0};
+        std::atomic<int> peak{0};
+        TaskGroup group(TaskPriority::Background, executor);
+        group.setMaxInFlight(2);
+        for (int i = 0; i < 20; ++i) {
+            group.run([&] {
+                int now = ++running;
+                int seen = peak;
+                while (now > seen && !peak.compare_exchange_weak(seen, now)) {}
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+                --running;
+            });
+        }
+        group.wait();
+        REQUIRE(peak <= 2);
+        REQUIRE(peak >= 1);
+    }
+}
+
+TEST_CASE("25. Scheduler State Tests") {
+    const std::string state_path = "test_state/scheduler_state.json";
+    std::filesystem::remove_all("test_state");
+
+    SECTION("25.1 Last Runs And Cursors Survive A Restart") {
+        auto ranAt = std::chrono::system_clock::now() - std::chrono::minutes(45);
+        {
+            SchedulerState state(state_path);
+            REQUIRE_FALSE(state.lastRun("archival").has_value());
+            REQUIRE(state.cursor("archival").empty());
+            state.setLastRun("archival", ranAt);
+            state.setCursor("retention", ScanCursor{"/mnt/dds/d/Logs", "/mnt/dds/d/Logs/2026-10-17"});
+            REQUIRE(state.save());
+        }
+        REQUIRE(std::filesystem::exists(state_path));
+        REQUIRE_FALSE(std::filesystem::exists(state_path + ".tmp"));
+
+        SchedulerState restarted(state_path);
+        REQUIRE(restarted.lastRun("archival").has_value());
+        auto drift = *restarted.lastRun("archival") - ranAt;
+        REQUIRE(std::chrono::abs(drift) < std::chrono::seconds(1));
+        REQUIRE(restarted.cursor("retention").root == "/mnt/dds/d/Logs");
+        REQUIRE(restarted.cursor("retention").directory == "/mnt/dds/d/Logs/2026-10-17");
+
+        // A completed pass clears the cursor
+        restarted.setCursor("retention", ScanCursor());
+        REQUIRE(restarted.save());
+        REQUIRE(SchedulerState(state_path).cursor("retention").empty());
+    }
+
+    SECTION("25.2 Unreadable State Starts Cold") {
+        std::filesystem::create_directories("test_state");
+        std::ofstream(state_path) << "{\"version\": 1, \"jobs\": {";
+        SchedulerState state(state_path);
+        REQUIRE_FALSE(state.lastRun("archival").has_value());
+        REQUIRE(state.cursor("archival").empty());
+    }
+
+    SECTION("25.3 Scans Resume After The Cursor") {
+        auto batches = groupByDirectory({"/r/b/2.mp4", "/r/a/sub/3.mp4", "/r/b/1.mp4", "/r/a/4.mp4", "/r/a.x/5.mp4"});
+        REQUIRE(batches.size() == 4);
+        REQUIRE(batches[0].directory == "/r/a");
+        REQUIRE(batches[1].directory == "/r/a.x");
+        REQUIRE(batches[2].directory == "/r/a/sub");
+        REQUIRE(batches[3].directory == "/r/b");
+        REQUIRE(batches[3].files == std::vector<std::string>{"/r/b/1.mp4", "/r/b/2.mp4"});
+
+        std::vector<std::string> roots = {"/r1", "/r2", "/r3"};
+        REQUIRE(resumeIndex(roots, ScanCursor()) == 0);
+        REQUIRE(resumeIndex(roots, ScanCursor{"/r2", "/r2/x"}) == 1);
+        // A root that is no longer configured restarts the pass
+        REQUIRE(resumeIndex(roots, ScanCursor{"/gone", ""}) == 0);
+    }
+
+    std::filesystem::remove_all("test_state");
+}
+
+TEST_CASE("26. Incremental Work Budget Tests") {
+    SECTION("26.1 Limits Stop Admission") {
+        WorkBudget::Limits limits;
+        limits.files = 3;
+        WorkBudget byFiles(limits);
+        REQUIRE(byFiles.admit());
+        REQUIRE(byFiles.admit());
+        REQUIRE(byFiles.admit());
+        REQUIRE_FALSE(byFiles.admit());
+        REQUIRE(byFiles.filesAdmitted() == 3);
+
+        limits = WorkBudget::Limits();
+        limits.bytes = 1000;
+        WorkBudget byBytes(limits);
+        REQUIRE(byBytes.admit());
+        byBytes.charge(1500);
+        REQUIRE(byBytes.exhausted());
+        REQUIRE_FALSE(byBytes.admit());
+
+        limits = WorkBudget::Limits();
+        limits.duration = std::chrono::milliseconds(20);
+        WorkBudget byTime(limits);
+        REQUIRE(byTime.admit());
+        std::this_thread::sleep_for(std::chrono::milliseconds(30));
+        REQUIRE_FALSE(byTime.admit());
+
+        WorkBudget unbounded{WorkBudget::Limits()};
+        for (int i = 0; i < 1000; ++i) {
+            unbounded.admit();
+        }
+        REQUIRE_FALSE(unbounded.exhausted());
+    }
+
+    SECTION("26.2 Slices Resume After The Last File") {
+        DirectoryBatch batch{"/r/a", {"/r/a/1.mp4", "/r/a/2.mp4", "/r/a/3.mp4"}};
+        REQUIRE(resumeOffset("/r", batch, ScanCursor()) == 0);
+        REQUIRE(resumeOffset("/r", batch, ScanCursor{"/r", "/r/a", "/r/a/2.mp4"}) == 2);
+        // Finished directory, earlier directory, later directory
+        REQUIRE(resumeOffset("/r", batch, ScanCursor{"/r", "/r/a", ""}) == 3);
+        REQUIRE(resumeOffset("/r", batch, ScanCursor{"/r", "/r/b", ""}) == 3);
+        REQUIRE(resumeOffset("/r", batch, ScanCursor{"/r", "/r/0", "/r/0/9.mp4"}) == 0);
+        // A cursor in another root says nothing about this one
+        REQUIRE(resumeOffset("/r", batch, ScanCursor{"/s", "/s/z", ""}) == 0);
+
+        // A full pass in slices of two files visits every file exactly once
+        std::vector<std::string> files = {"/r/b/1", "/r/a/1", "/r/a/2", "/r/b/2", "/r/c/1"};
+        std::vector<std::string> visited;
+        ScanCursor cursor;
+        for (int slice = 0; slice < 10; ++slice) {
+            WorkBudget::Limits limits;
+            limits.files = 2;
+            WorkBudget budget(limits);
+            bool yielded = false;
+            for (const auto& dir : groupByDirectory(files)) {
+                std::size_t next = resumeOffset("/r", dir, cursor);
+                const std::size_t start = next;
+                for (; next < dir.files.size() && budget.admit(); ++next) {
+                    visited.push_back(dir.files[next]);
+                }
+                if (next < dir.files.size()) {
+                    if (next > start) cursor = ScanCursor{"/r", dir.directory, dir.files[next - 1]};
+                    yielded = true;
+                    break;
+                }
+                if (next > start) cursor = ScanCursor{"/r", dir.directory, ""};
+            }
+            if (!yielded) break;
+        }
+        REQUIRE(visited == std::vector<std::string>{"/r/a/1", "/r/a/2", "/r/b/1", "/r/b/2", "/r/c/1"});
+    }
+
+    SECTION("26.3 Executor Reports Finished Runs") {
+        JobExecutor executor;
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::vector<std::string> finished;
+        executor.setFinishedListener([&](const std::string& job) {
+            std::lock_guard<std::mutex> lock(mutex);
+            finished.push_back(job);
+            cv.notify_all();
+        });
+        executor.addJob("retention");
+        REQUIRE(executor.submit("retention", [] { throw std::runtime_error("disk unavailable"); }));
+        std::unique_lock<std::mutex> lock(mutex);
+        REQUIRE(cv.wait_for(lock, std::chrono::seconds(5), [&] { return !finished.empty(); }));
+        REQUIRE(finished.front() == "retention");
+    }
+}
+
+TEST_CASE("27. Thread Isolation Tests") {
+    SECTION("27.1 Lane Settings Parse And Validate") {
+        ThreadPolicy policy;
+        REQUIRE(ThreadIsolation::parsePolicy(
+            nlohmann::json::parse(R"({"io_class": "idle", "nice": 19, "sched_idle": true, "cpus": [0, 1]})"), policy).empty());
+        REQUIRE(policy.ioClass == IoPriorityClass::Idle);
+        REQUIRE(policy.nice == 19);
+        REQUIRE(policy.schedIdle);
+        REQUIRE(policy.cpus == std::vector<int>{0, 1});
+
+        REQUIRE_FALSE(ThreadIsolation::parsePolicy(nlohmann::json::parse(R"({"io_class": "realtime"})"), policy).empty());
+        REQUIRE_FALSE(ThreadIsolation::parsePolicy(nlohmann::json::parse(R"({"io_level": 8})"), policy).empty());
+        REQUIRE_FALSE(ThreadIsolation::parsePolicy(nlohmann::json::parse(R"({"nice": 40})"), policy).empty());
+        REQUIRE_FALSE(ThreadIsolation::parsePolicy(nlohmann::json::parse(R"({"cpus": "0-3"})"), policy).empty());
+        REQUIRE(ConfigService::validate(nlohmann::json::parse(
+            R"({"isolation": {"background": {"io_class": "lowest"}}})")).find("isolation.background") == 0);
+
+        auto defaults = ThreadIsolation::defaultPolicies();
+        REQUIRE(defaults[static_cast<std::size_t>(TaskPriority::Background)].schedIdle);
+        REQUIRE(defaults[static_cast<std::size_t>(TaskPriority::Emergency)].ioLevel == 0);
+    }
+
+    SECTION("27.2 Background Lane Runs Idle") {
+        ThreadIsolation isolation(true, ThreadIsolation::defaultPolicies());
+        int scheduler = -1;
+        int nice = 0;
+        long ioprio = -1;
+        std::optional<TaskPriority> lane;
+        // Settings are per thread; the test thread keeps its own
+        std::thread worker([&] {
+            isolation.apply(TaskPriority::Background);
+            lane = ThreadIsolation::current();
+            scheduler = sched_getscheduler(0);
+            errno = 0;
+            nice = getpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)));
+            ioprio = syscall(SYS_ioprio_get, 1, static_cast<int>(syscall(SYS_gettid)));
+        });
+        worker.join();
+        REQUIRE(lane == TaskPriority::Background);
+        REQUIRE(scheduler == SCHED_IDLE);
+        REQUIRE(nice == 19);
+        REQUIRE((ioprio >> 13) == 3);
+        REQUIRE(sched_getscheduler(0) != SCHED_IDLE);
+
+        ThreadIsolation disabled(false, ThreadIsolation::defaultPolicies());
+        std::thread untouched([&] {
+            disabled.apply(TaskPriority::Background);
+            scheduler = sched_getscheduler(0);
+        });
+        untouched.join();
+        REQUIRE(scheduler == SCHED_OTHER);
+    }
+
+    SECTION("27.3 Nice And SCHED_IDLE Only With A Way Back") {
+        const auto defaults = ThreadIsolation::defaultPolicies();
+        const std::size_t background = static_cast<std::size_t>(TaskPriority::Background);
+        const std::size_t normal = static_cast<std::size_t>(TaskPriority::Normal);
+
+        // CAP_SYS_NICE, or an RLIMIT_NICE reaching the starting nice value: lanes as configured
+        REQUIRE(ThreadIsolation::restorable(defaults, -20, 0)[background].nice == 19);
+        REQUIRE(ThreadIsolation::restorable(defaults, 0, 0)[background].schedIdle);
+
+        // RLIMIT_NICE 0: a worker back from nice 19 would stay there
+        auto stripped = ThreadIsolation::restorable(defaults, 20, 0);
+        for (const auto& policy : stripped) {
+            REQUIRE(policy.nice == 0);
+            REQUIRE_FALSE(policy.schedIdle);
+        }
+        REQUIRE(stripped[background].ioClass == IoPriorityClass::Idle);
+        REQUIRE(stripped[normal].ioLevel == 4);
+
+        // Lanes that never lower priority need nothing
+        ThreadIsolation::Policies flat = defaults;
+        for (auto& policy : flat) {
+            policy.nice = 0;
+            policy.schedIdle = false;
+        }
+        REQUIRE(ThreadIsolation::restorable(flat, 20, 0)[background].ioClass == IoPriorityClass::Idle);
+        REQUIRE(ThreadIsolation::niceFloor() >= -20);
+        REQUIRE(ThreadIsolation::niceFloor() <= 20);
+    }
+}
+
+TEST_CASE("28. I/O Pressure Throttling Tests") {
+    const std::string psiFile = "test_io_pressure";
+    auto writePsi = [&](double someAvg10) {
+        std::ofstream file(psiFile);
+        file << "some avg10=" << someAvg10 << " avg60=1.00 avg300=0.50 total=123456\n"
+             << "full avg10=0.00 avg60=0.00 avg300=0.00 total=654\n";
+    };
+
+    SECTION("28.1 Stall Readings And Hysteresis") {
+        writePsi(12.5);
+        REQUIRE(PsiMonitor::readStall(psiFile) == Approx(12.5));
+        REQUIRE(PsiMonitor::readStall("test_io_pressure_missing") < 0);
+
+        PsiMonitor::Thresholds thresholds;  // slow 10, pause 40, resume 5
+        REQUIRE(PsiMonitor::nextLevel(PressureLevel::Clear, 8.0, thresholds) == PressureLevel::Clear);
+        REQUIRE(PsiMonitor::nextLevel(PressureLevel::Clear, 12.0, thresholds) == PressureLevel::Slowed);
+        REQUIRE(PsiMonitor::nextLevel(PressureLevel::Slowed, 8.0, thresholds) == PressureLevel::Slowed);
+        REQUIRE(PsiMonitor::nextLevel(PressureLevel::Slowed, 4.0, thresholds) == PressureLevel::Clear);
+        REQUIRE(PsiMonitor::nextLevel(PressureLevel::Clear, 45.0, thresholds) == PressureLevel::Paused);
+        REQUIRE(PsiMonitor::nextLevel(PressureLevel::Paused, 20.0, thresholds) == PressureLevel::Paused);
+        REQUIRE(PsiMonitor::nextLevel(PressureLevel::Paused, 8.0, thresholds) == PressureLevel::Slowed);
+        REQUIRE(PsiMonitor::nextLevel(PressureLevel::Paused, -1.0, thresholds) == PressureLevel::Clear);
+
+        PressureThrottle throttle;
+        std::vector<PressureLevel> changes;
+        PsiMonitor monitor({"test_io_pressure_missing", psiFile}, thresholds, throttle,
+                           [&](PressureLevel level, double) { changes.push_back(level); });
+        writePsi(50.0);
+        REQUIRE(monitor.sample() == Approx(50.0));
+        REQUIRE(monitor.sample() == Approx(50.0));
+        REQUIRE(throttle.level() == PressureLevel::Paused);
+        writePsi(1.0);
+        monitor.sample();
+        REQUIRE(throttle.level() == PressureLevel::Clear);
+        REQUIRE(changes == std::vector<PressureLevel>{PressureLevel::Paused, PressureLevel::Clear});
+        std::filesystem::remove(psiFile);
+    }
+
+    SECTION("28.2 Settings Validate") {
+        PsiMonitor::Settings settings;
+        REQUIRE(PsiMonitor::parseSettings(nlohmann::json::parse(
+            R"({"enabled": true, "sources": ["/sys/fs/cgroup/io.pressure"], "slow_above": 20, "pause_above": 60})"),
+            settings).empty());
+        REQUIRE(settings.enabled);
+        REQUIRE(settings.sources == std::vector<std::string>{"/sys/fs/cgroup/io.pressure"});
+        REQUIRE(settings.thresholds.pauseAbove == Approx(60.0));
+
+        REQUIRE(ConfigService::validate(nlohmann::json::parse(
+            R"({"io_pressure": {"slow_above": 50, "pause_above": 30}})")).find("io_pressure") == 0);
+        REQUIRE(ConfigService::validate(nlohmann::json::parse(
+            R"({"io_pressure": {"slow_delay_ms": -1}})")).find("io_pressure") == 0);
+        REQUIRE(ConfigService::validate(nlohmann::json::parse(
+            R"({"io_pressure": {"sources": "/proc/pressure/io"}})")).find("io_pressure") == 0);
+    }
+
+    SECTION("28.3 Throttle Paces Admission And Copies") {
+        PressureThrottle throttle;
+        throttle.setLimits(std::chrono::milliseconds(100), 64);
+        REQUIRE(throttle.bandwidthKb(0) == 0);
+        REQUIRE(throttle.pace(CancellationToken::none()));
+
+        throttle.setLevel(PressureLevel::Slowed);
+        REQUIRE(throttle.bandwidthKb(0) == 64);
+        REQUIRE(throttle.bandwidthKb(32) == 32);
+        auto started = std::chrono::steady_clock::now();
+        REQUIRE(throttle.pace(CancellationToken::none()));
+        REQUIRE(std::chrono::steady_clock::now() - started >= std::chrono::milliseconds(90));
+
+        // Paused holds the coordinator until pressure clears
+        throttle.setLevel(PressureLevel::Paused);
+        std::thread relief([&throttle] {
+            std::this_thread::sleep_for(std::chrono::milliseconds(150));
+            throttle.setLevel(PressureLevel::Clear);
+        });
+        started = std::chrono::steady_clock::now();
+        REQUIRE(throttle.pace(CancellationToken::none()));
+        REQUIRE(std::chrono::steady_clock::now() - started >= std::chrono::milliseconds(140));
+        relief.join();
+
+        // ...or until its run is cancelled
+        throttle.setLevel(PressureLevel::Paused);
+        CancellationToken token;
+        std::thread canceller([token]() mutable {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            token.cancel("shutdown");
+        });
+        REQUIRE_FALSE(throttle.pace(token));
+        canceller.join();
+
+        // Unlimited copies drop to the slow bandwidth: 16 KB at 64 KB/s takes ~250 ms
+        const std::string source = "test_pressure_source.bin";
+        const std::string destination = "test_pressure_destination.bin";
+        {
+            std::ofstream file(source, std::ios::binary);
+            file << std::string(16 * 1024, 'x');
+        }
+        throttle.setLevel(PressureLevel::Slowed);
+        started = std::chrono::steady_clock::now();
+        CopyResult copy = copyFileChunked(source, destination, 0, CancellationToken::none(), 4096, &throttle);
+        REQUIRE(copy.status == CopyStatus::Copied);
+        REQUIRE(std::chrono::steady_clock::now() - started >= std::chrono::milliseconds(200));
+        std::filesystem::remove(source);
+        std::filesystem::remove(destination);
+    }
+}
@@ -0,0 +1,80 @@
+// efms-logdump: renders a binary event log written by BinaryEventLog as JSON
+// lines, one event per line.
+//
+//   efms-logdump <events.bin> [--event <name>]
+
+#include "binarylog.hpp"
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <nlohmann/json.hpp>
+
+namespace {
+    std::string formatTimestamp(std::uint64_t timestampUs) {
+        std::time_t seconds = static_cast<std::time_t>(timestampUs / 1000000);
+        std::tm local{};
+        localtime_r(&seconds, &local);
+        char rendered[32];
+        std::strftime(rendered, sizeof(rendered), "%Y-%m-%d %H:%M:%S", &local);
+
+        char withMicros[48];
+        std::snprintf(withMicros, sizeof(withMicros), "%s.%06u", rendered,
+                      static_cast<unsigned>(timestampUs % 1000000));
+        return withMicros;
+    }
+
+    nlohmann::json toJson(const DecodedEvent& event) {
+        nlohmann::json line;
+        const EventSchema* schema = findEventSchema(event.event);
+        if (schema) {
+            line["event"] = schema->name;
+        } else {
+            line["event"] = "unknown";
+            line["event_id"] = event.event;
+        }
+        line["timestamp"] = formatTimestamp(event.timestampUs);
+        line["path"] = event.path;
+
+        for (std::size_t i = 0; i < event.fields.size(); ++i) {
+            if (schema && i < schema->fields.size()) {
+                line[schema->fields[i]] = event.fields[i];
+            } else {
+                line["field_" + std::to_string(i)] = event.fields[i];
+            }
+        }
+        return line;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc != 2 && !(argc == 4 && std::strcmp(argv[2], "--event") == 0)) {
+        std::cerr << "Usage: " << argv[0] << " <events.bin> [--event <name>]" << std::endl;
+        return 2;
+    }
+
+    std::ifstream input(argv[1], std::ios::binary);
+    if (!input.is_open()) {
+        std::cerr << "Cannot open " << argv[1] << std::endl;
+        return 1;
+    }
+    const char* eventFilter = argc == 4 ? argv[3] : nullptr;
+
+    BinaryEventReader reader(input);
+    DecodedEvent event;
+    while (reader.next(event)) {
+        if (eventFilter) {
+            const EventSchema* schema = findEventSchema(event.event);
+            if (!schema || std::strcmp(schema->name, eventFilter) != 0) continue;
+        }
+        std::cout << toJson(event).dump() << '\n';
+    }
+
+    if (reader.isCorrupt()) {
+        std::cerr << "Skipped truncated or unrecognised records" << std::endl;
+        return 1;
+    }
+    return 0;
+}